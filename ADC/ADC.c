@@ -6,84 +6,122 @@
  * Uso:
  *  - Configura el pin ANx como analógico en main (ejemplo en main.c).
  *  - Llama a ADC_Init() y luego ADC_ReadSingleBlocking(channel) o la API no bloqueante.
+ *  - Para adquisición continua usa ADC_StreamStart() (máxima tasa) o
+ *    ADC_StartTimed() (tasa fija por Timer3) y define _ADC1Interrupt
+ *    llamando a ADC_ISR_Handler() (ver ADCmain.c).
+ *  - ADC_StartOversampled() acumula 4^n conversiones por resultado (bits
+ *    extra) y ADC_SetStreamFormat(ADC_FORMAT_FRACTIONAL) entrega Q15.
+ *  - Para varias fases a la vez usa ADC_ScanStart() (CH0..CH3 simultáneos);
+ *    con ADC_TRIGGER_PWM + ADC_SetPwmTrigger() el frame se sincroniza con el
+ *    PWM de motor y el callback de frame ejecuta el lazo de control.
  */
 
 #include "adc.h"
+#include "config.h" /* FCY para el cálculo del periodo de Timer3 */
 #include <xc.h>    /* registros específicos del dispositivo (XC16) */
 
 /* Ajustes por defecto: puedes cambiarlos según necesidades */
 #define ADC_SAMPLE_TIME    4   /* SAMC (Tad cycles) */
 #define ADC_ADCS           4   /* ADCS => Tad = (ADCS+1) * Tcy */
+#define ADC_IRQ_PRIORITY   5   /* prioridad de _ADC1Interrupt en modo streaming */
+#ifndef ADC_CONTROL_IRQ_PRIORITY
+#define ADC_CONTROL_IRQ_PRIORITY 6  /* con disparo PWM la ISR es el lazo de control */
+#endif
 
 /* Internals */
 static volatile uint16_t adc_last_result = 0;
 
+/* Estado del modo streaming: dos bloques ping-pong en RAM */
+static uint16_t adc_stream_buf[2][ADC_STREAM_BLOCK_LENGTH];
+static volatile uint8_t adc_stream_fill = 0;      /* bloque que está llenando la ISR */
+static volatile uint16_t adc_stream_pos = 0;      /* siguiente posición dentro del bloque */
+static volatile uint8_t adc_stream_ready_idx = 0; /* último bloque completo */
+static volatile bool adc_stream_ready = false;
+static volatile uint16_t adc_stream_overruns = 0;
+static volatile uint32_t adc_stream_blocks = 0;    /* bloques publicados */
+static ADC_BlockCallback_t adc_stream_callback = 0;
+static ADC_Format_t adc_stream_format = ADC_FORMAT_INTEGER;
+
+/* Timer3 lo arrancó el ADC (ADC_StartTimed/Oversampled/ScanStart): sólo
+   entonces lo para ADC_StreamStop, como dac_owns_timer en dac.c */
+static bool adc_owns_timer = false;
+/* Timer3 ya corría con la misma tasa (DAC): el ADC sólo usa su evento */
+static bool adc_timer_shared = false;
+
+/* Sobremuestreo: 0 = desactivado; si no, 4^adc_os_log4 conversiones por
+   resultado */
+static uint8_t adc_os_log4 = 0;
+static int32_t adc_os_acc = 0;
+static uint16_t adc_os_count = 0;
+
+/* Estado del modo multicanal: doble buffer de frames */
+static ADC_Frame_t adc_frames[2];
+static volatile uint8_t adc_frame_idx = 0;       /* último frame publicado */
+static volatile bool adc_frame_ready = false;
+static volatile uint16_t adc_frame_seq = 0;
+static volatile uint8_t adc_scan_input = 0;      /* ANx que convierte CH0 en el próximo frame */
+static uint16_t adc_scan_mask = 0;
+static uint8_t adc_scan_channels = 1;
+static ADC_FrameCallback_t adc_scan_callback = 0;
+
+/* Modo activo: decide qué hace la ISR */
+typedef enum {
+    ADC_MODE_SINGLE = 0,
+    ADC_MODE_STREAM,
+    ADC_MODE_SCAN
+} adc_mode_t;
+static volatile adc_mode_t adc_mode = ADC_MODE_SINGLE;
+
 /* Inicializa ADC (modo manual: SAMP controla muestreo, luego SAMP=0 lanza conversión) */
 void ADC_Init(void)
 {
+    /* Activar el módulo (PMD) antes de escribir sus registros */
+    PMD1bits.AD1MD = 0;
+
     /* Apagar ADC mientras configuramos */
-    #ifdef AD1CON1
     AD1CON1bits.ADON = 0;
-    #endif
 
     /* AD1CON1: FORM=00 Integer, SSRC=000 manual, ASAM=0 */
-    #ifdef AD1CON1
     AD1CON1 = 0;
     AD1CON1bits.FORM = 0;   /* Integer */
+    AD1CON1bits.AD12B = 1;  /* 12 bits (ADC_RESOLUTION_BITS) */
     AD1CON1bits.SSRC = 0;   /* Conversion triggered by SAMP->0 */
     AD1CON1bits.ASAM = 0;   /* Auto sampling disabled */
-    #endif
 
     /* AD1CON2: SMPI = 0 -> interrupt at every sample (no scanning) */
-    #ifdef AD1CON2
     AD1CON2 = 0;
     AD1CON2bits.SMPI = 0;
-    #endif
 
     /* AD1CON3: SAMC, ADCS */
-    #ifdef AD1CON3
     AD1CON3 = 0;
     AD1CON3bits.SAMC = ADC_SAMPLE_TIME; /* tiempo de sample en Tad */
     AD1CON3bits.ADCS = ADC_ADCS;        /* Tad = (ADCS+1)*Tcy */
-    #endif
 
-    /* AD1CHS0: seleccionar canal por defecto AN0 (si existe) */
-    #ifdef AD1CHS0
+    /* AD1CHS0: seleccionar canal por defecto AN0 */
     AD1CHS0 = 0;
-    #endif
 
-    /* Vaciar buffer si existe */
-    #ifdef ADC1BUF0
+    /* Vaciar buffer */
     volatile uint16_t tmp = ADC1BUF0;
     (void)tmp;
-    #endif
 
     /* Encender ADC */
-    #ifdef AD1CON1
     AD1CON1bits.ADON = 1;
-    #endif
 }
 
 /* Inicia muestreo y conversión en el canal 'channel' (ANx). No bloqueante. */
 void ADC_StartSingle(uint8_t channel)
 {
-    /* Selecciona canal positivo (CH0SA) si existe */
-    #ifdef AD1CHS0
+    /* Selecciona canal positivo (CH0SA) */
     AD1CHS0bits.CH0SA = channel; /* asigna AN channel al MUX + */
-    #endif
 
     /* Empezar muestreo */
-    #ifdef AD1CON1
     AD1CON1bits.SAMP = 1;
-    #endif
 
     /* pequeña espera para adquisición */
     for (volatile int i = 0; i < 60; ++i) { __builtin_nop(); }
 
     /* Parar muestreo -> comienza conversión */
-    #ifdef AD1CON1
     AD1CON1bits.SAMP = 0;
-    #endif
 }
 
 /* Espera a que la conversión termine y devuelve el resultado (bloqueante) */
@@ -92,15 +130,10 @@ uint16_t ADC_ReadSingleBlocking(uint8_t channel)
     ADC_StartSingle(channel);
 
     /* Esperar DONE */
-    #ifdef AD1CON1
     while (!AD1CON1bits.DONE) { /* espera activa */ }
-    #endif
 
     /* Leer buffer */
-    uint16_t r = 0;
-    #ifdef ADC1BUF0
-    r = ADC1BUF0;
-    #endif
+    uint16_t r = ADC1BUF0;
 
     adc_last_result = r & ADC_MAX_VALUE;
     return adc_last_result;
@@ -109,20 +142,515 @@ uint16_t ADC_ReadSingleBlocking(uint8_t channel)
 /* Indica si la conversión actual terminó */
 bool ADC_IsConversionDone(void)
 {
-    #ifdef AD1CON1
     return (bool)AD1CON1bits.DONE;
-    #else
-    return true;
-    #endif
 }
 
 /* Devuelve el resultado del último muestreo (raw value) */
 uint16_t ADC_GetResult(void)
 {
-    uint16_t r = 0;
-    #ifdef ADC1BUF0
-    r = ADC1BUF0;
-    #endif
+    uint16_t r = ADC1BUF0;
     adc_last_result = r & ADC_MAX_VALUE;
     return adc_last_result;
-}
\ No newline at end of file
+}
+
+/* Media de 4^n lecturas conservando n bits de más: la suma de 4^n valores
+   de 12 bits cabe en 12 + 2n bits y se desplaza n */
+uint16_t ADC_ReadAveragedBlocking(uint8_t channel, uint8_t log4_ratio)
+{
+    uint32_t sum = 0;
+    uint16_t count;
+    uint16_t i;
+
+    if (log4_ratio > ADC_OVERSAMPLE_MAX_LOG4) {
+        log4_ratio = ADC_OVERSAMPLE_MAX_LOG4;
+    }
+    count = 1u << (2u * log4_ratio);
+
+    for (i = 0; i < count; i++) {
+        sum += ADC_ReadSingleBlocking(channel);
+    }
+    return (uint16_t)(sum >> log4_ratio);
+}
+
+/* --------------------------------------------------------------------------
+ * Modo streaming
+ * ------------------------------------------------------------------------ */
+
+/* Programa Timer3 para desbordar a 'rate_hz' (sin arrancarlo). El periodo se
+   calcula con FCY de config.h. Devuelve la tasa real o 0 si no es alcanzable.
+   Si Timer3 ya corre por cuenta de otro módulo (DAC_StreamStart) no se
+   reprograma: se comparte si su base de tiempos es la misma que saldría
+   para 'rate_hz' y si no se devuelve 0. adc_timer3_run() lo arranca sólo
+   cuando es del ADC. */
+static uint32_t adc_timer3_setup(uint32_t rate_hz)
+{
+    static const uint16_t prescalers[4] = { 1u, 8u, 64u, 256u }; /* TCKPS 00..11 */
+    uint32_t ticks = 0;
+    uint8_t tckps;
+
+    if (rate_hz == 0 || rate_hz > ADC_TIMED_MAX_RATE_HZ) {
+        return 0;
+    }
+
+    /* Menor prescaler que deja el periodo dentro de 16 bits (mejor resolución) */
+    for (tckps = 0; tckps < 4; tckps++) {
+        uint32_t div = (uint32_t)prescalers[tckps] * rate_hz;
+        ticks = ((uint32_t)FCY + div / 2u) / div;   /* redondeo al más cercano */
+        if (ticks >= 2u && ticks <= 65536UL) {
+            break;
+        }
+    }
+    if (tckps == 4) {
+        return 0;
+    }
+
+    if (T3CONbits.TON && !adc_owns_timer) {
+        if (T3CONbits.TCKPS != tckps || PR3 != (uint16_t)(ticks - 1u)) {
+            return 0;        /* no se cambia la tasa del otro módulo */
+        }
+        adc_timer_shared = true;
+        return (uint32_t)FCY / ((uint32_t)prescalers[tckps] * ticks);
+    }
+
+    adc_timer_shared = false;
+    PMD1bits.T3MD = 0;       /* activar Timer3 si CONFIG_PMD_AUTO lo apagó */
+    T3CONbits.TON = 0;
+    T3CONbits.TCS = 0;       /* Reloj interno Tcy */
+    T3CONbits.TGATE = 0;
+    T3CONbits.TCKPS = tckps;
+    TMR3 = 0;
+    PR3 = (uint16_t)(ticks - 1u);
+    /* El ADC usa el evento de periodo, no la interrupción: T3IE/T3IF no se
+       tocan, son del DAC si está sacando muestras con Timer3 */
+
+    return (uint32_t)FCY / ((uint32_t)prescalers[tckps] * ticks);
+}
+
+/* Arranca Timer3 tras adc_timer3_setup() salvo si es compartido */
+static void adc_timer3_run(void)
+{
+    if (!adc_timer_shared) {
+        adc_timer3_run();
+    }
+}
+
+/* Parte común de los modos automáticos: disparo, muestreo automático
+   (ASAM = 1), reloj del ADC e interrupción. No enciende el módulo. */
+static void adc_auto_configure(ADC_Trigger_t trigger, ADC_Format_t format)
+{
+    AD1CON1bits.FORM = (uint8_t)format;
+    AD1CON1bits.SSRC = (uint8_t)trigger;
+    AD1CON1bits.ASAM = 1;    /* Nuevo muestreo justo al acabar cada conversión */
+
+    AD1CON3bits.ADRC = 0;    /* Reloj derivado de Tcy */
+    AD1CON3bits.SAMC = ADC_SAMPLE_TIME;
+    AD1CON3bits.ADCS = ADC_ADCS;
+
+    IFS0bits.AD1IF = 0;
+    IPC3bits.AD1IP = (trigger == ADC_TRIGGER_PWM) ? ADC_CONTROL_IRQ_PRIORITY : ADC_IRQ_PRIORITY;
+    IEC0bits.AD1IE = 1;
+}
+
+/* Configuración del modo streaming (un canal, bloques ping-pong) */
+static void adc_stream_configure(uint8_t channel, ADC_Trigger_t trigger,
+                                 ADC_BlockCallback_t callback, uint8_t log4_ratio)
+{
+    AD1CON1bits.ADON = 0;
+    IEC0bits.AD1IE = 0;
+
+    adc_stream_callback = callback;
+    adc_stream_fill = 0;
+    adc_stream_pos = 0;
+    adc_stream_ready_idx = 0;
+    adc_stream_ready = false;
+    adc_stream_overruns = 0;
+    adc_stream_blocks = 0;
+    adc_os_log4 = log4_ratio;
+    adc_os_acc = 0;
+    adc_os_count = 0;
+
+    AD1CHS0bits.CH0SA = channel;
+    AD1CON1bits.SIMSAM = 0;
+    AD1CON1bits.AD12B = 1;   /* un solo canal S&H: admite 12 bits */
+    AD1CON2 = 0;             /* CHPS = 00 (solo CH0), sin escaneo */
+    AD1CON2bits.BUFM = 1;    /* Buffer 2 x 8 palabras (ping-pong hardware) */
+    AD1CON2bits.SMPI = ADC_STREAM_HALF_LENGTH - 1u;
+
+    adc_mode = ADC_MODE_STREAM;
+    adc_auto_configure(trigger, adc_stream_format);
+}
+
+/* Arranca la adquisición continua en 'channel'. El ADC muestrea y convierte
+   solo (SSRC = 111: el contador SAMC termina el muestreo) a la máxima tasa. */
+void ADC_StreamStart(uint8_t channel, ADC_BlockCallback_t callback)
+{
+    adc_stream_configure(channel, ADC_TRIGGER_AUTO, callback, 0);
+    AD1CON1bits.ADON = 1;
+}
+
+/* Arranca la adquisición a tasa fija: Timer3 marca el fin de cada muestreo
+   (SSRC = 010), así el periodo no depende de lo que haga el bucle principal.
+   Devuelve la tasa real obtenida (Hz) o 0 si 'sample_rate_hz' no es alcanzable. */
+uint32_t ADC_StartTimed(uint8_t channel, uint32_t sample_rate_hz, ADC_BlockCallback_t callback)
+{
+    uint32_t real_rate = adc_timer3_setup(sample_rate_hz);
+
+    if (real_rate == 0) {
+        return 0;
+    }
+
+    adc_stream_configure(channel, ADC_TRIGGER_TIMER3, callback, 0);
+    AD1CON1bits.ADON = 1;
+    adc_timer3_run();
+
+    return real_rate;
+}
+
+/* Igual que ADC_StartTimed pero con Timer3 a 4^n veces la tasa de salida; la
+   ISR acumula en lugar de copiar */
+uint32_t ADC_StartOversampled(uint8_t channel, uint32_t output_rate_hz,
+                              uint8_t log4_ratio, ADC_BlockCallback_t callback)
+{
+    uint32_t ratio;
+    uint32_t real_rate;
+
+    if (log4_ratio == 0 || log4_ratio > ADC_OVERSAMPLE_MAX_LOG4 || output_rate_hz == 0) {
+        return 0;
+    }
+    ratio = 1UL << (2u * log4_ratio);
+    if (output_rate_hz > ADC_TIMED_MAX_RATE_HZ / ratio) {
+        return 0;
+    }
+
+    real_rate = adc_timer3_setup(output_rate_hz * ratio);
+    if (real_rate == 0) {
+        return 0;
+    }
+
+    adc_stream_configure(channel, ADC_TRIGGER_TIMER3, callback, log4_ratio);
+    AD1CON1bits.ADON = 1;
+    adc_timer3_run();
+
+    return real_rate / ratio;
+}
+
+void ADC_SetStreamFormat(ADC_Format_t format)
+{
+    adc_stream_format = format;
+}
+
+ADC_Format_t ADC_GetStreamFormat(void)
+{
+    return adc_stream_format;
+}
+
+uint8_t ADC_StreamGetResolutionBits(void)
+{
+    if (adc_stream_format == ADC_FORMAT_FRACTIONAL) {
+        return 16u;
+    }
+    return (uint8_t)(ADC_RESOLUTION_BITS + adc_os_log4);
+}
+
+/* Detiene el modo automático en curso (streaming o scan) y deja el ADC otra
+   vez en modo manual */
+void ADC_StreamStop(void)
+{
+    IEC0bits.AD1IE = 0;
+    AD1CON1bits.ADON = 0;
+    IFS0bits.AD1IF = 0;
+    if (adc_owns_timer) {    /* venía de un modo con Timer3 */
+        T3CONbits.TON = 0;
+        adc_owns_timer = false;
+    }
+
+    adc_mode = ADC_MODE_SINGLE;
+    adc_os_log4 = 0;
+    adc_stream_ready = false;
+    adc_frame_ready = false;
+
+    ADC_Init();
+}
+
+bool ADC_StreamIsRunning(void)
+{
+    return adc_mode == ADC_MODE_STREAM;
+}
+
+bool ADC_StreamBlockReady(void)
+{
+    return adc_stream_ready;
+}
+
+/* Devuelve el último bloque completo (o 0 si no hay). El bloque es válido hasta
+   que la ISR complete el siguiente: hay que procesarlo en menos de un periodo
+   de bloque (ADC_STREAM_BLOCK_LENGTH muestras). */
+const uint16_t *ADC_StreamGetBlock(void)
+{
+    if (!adc_stream_ready) {
+        return 0;
+    }
+    adc_stream_ready = false;
+    return adc_stream_buf[adc_stream_ready_idx];
+}
+
+uint16_t ADC_StreamGetOverruns(void)
+{
+    return adc_stream_overruns;
+}
+
+uint32_t ADC_StreamGetBlockCount(void)
+{
+    uint32_t n;
+    bool ie = IEC0bits.AD1IE;
+
+    /* 32 bits: dos accesos, la ISR no debe caer en medio */
+    IEC0bits.AD1IE = 0;
+    n = adc_stream_blocks;
+    IEC0bits.AD1IE = ie;
+    return n;
+}
+
+/* --------------------------------------------------------------------------
+ * Modo multicanal simultáneo (CH0..CH3) con escaneo opcional de CH0
+ * ------------------------------------------------------------------------ */
+
+/* Siguiente entrada de 'mask' por encima de 'current' (con la vuelta), en el
+   mismo orden en que CSCNA recorre AD1CSSL */
+static uint8_t adc_scan_next_input(uint16_t mask, uint8_t current)
+{
+    uint8_t i;
+
+    for (i = 1; i <= 16; i++) {
+        uint8_t an = (uint8_t)((current + i) & 0x0Fu);
+        if (mask & (1u << an)) {
+            return an;
+        }
+    }
+    return current;
+}
+
+/* Arranca el modo multicanal. Cada disparo muestrea a la vez CH0..CH(n-1)
+   (SIMSAM = 1) y la ISR publica un ADC_Frame_t. Trabaja en 10 bits
+   (AD12B = 0, obligatorio con varios S&H) y formato entero. Devuelve la tasa de frames real
+   (Hz) con disparo por Timer3, 0 si la configuración no es válida, o 1 con
+   disparo automático o por PWM (la tasa la marca el propio SAMC o PTPER). */
+uint32_t ADC_ScanStart(const ADC_ScanConfig_t *config, ADC_FrameCallback_t callback)
+{
+    uint32_t real_rate = 1;
+
+    if (config == 0) {
+        return 0;
+    }
+    if (config->num_channels != 1 && config->num_channels != 2 &&
+        config->num_channels != ADC_MAX_SIMUL_CHANNELS) {
+        return 0;
+    }
+
+    AD1CON1bits.ADON = 0;
+    IEC0bits.AD1IE = 0;
+
+    if (config->trigger == ADC_TRIGGER_TIMER3) {
+        real_rate = adc_timer3_setup(config->rate_hz);
+        if (real_rate == 0) {
+            return 0;
+        }
+    }
+
+    adc_scan_callback = callback;
+    adc_scan_mask = config->ch0_scan_mask;
+    adc_scan_channels = config->num_channels;
+    adc_frame_idx = 0;
+    adc_frame_seq = 0;
+    adc_frame_ready = false;
+
+    /* CH0: entrada fija o escaneo de AD1CSSL (empieza por la más baja) */
+    AD1CHS0 = 0;
+    AD1CSSL = config->ch0_scan_mask;
+    if (config->ch0_scan_mask != 0) {
+        adc_scan_input = adc_scan_next_input(config->ch0_scan_mask, 15);
+    } else {
+        adc_scan_input = config->ch0_input;
+        AD1CHS0bits.CH0SA = config->ch0_input;
+    }
+
+    /* CH1..CH3: AN0..AN2 o AN3..AN5, referencia negativa Vref- */
+    AD1CHS123 = 0;
+    AD1CHS123bits.CH123SA = config->ch123_upper ? 1 : 0;
+
+    AD1CON2 = 0;
+    AD1CON2bits.CSCNA = (config->ch0_scan_mask != 0) ? 1 : 0;
+    AD1CON2bits.CHPS = (config->num_channels == 1) ? 0 :
+                       (config->num_channels == 2) ? 1 : 2;
+    AD1CON2bits.BUFM = 0;
+    AD1CON2bits.SMPI = 0;    /* Una interrupción por secuencia (= frame) */
+    AD1CON1bits.SIMSAM = 1;  /* Muestreo simultáneo: sin desfase entre fases */
+    AD1CON1bits.AD12B = 0;
+
+    adc_mode = ADC_MODE_SCAN;
+    adc_auto_configure(config->trigger, ADC_FORMAT_INTEGER);
+    AD1CON1bits.ADON = 1;
+
+    if (config->trigger == ADC_TRIGGER_TIMER3) {
+        adc_timer3_run();
+    }
+
+    return real_rate;
+}
+
+bool ADC_FrameReady(void)
+{
+    return adc_frame_ready;
+}
+
+/* Copia el último frame en 'frame'. Devuelve false si no hay frame nuevo desde
+   la última llamada. La copia se hace con la interrupción del ADC bloqueada,
+   así que el frame devuelto siempre es coherente. */
+bool ADC_GetFrame(ADC_Frame_t *frame)
+{
+    bool ready;
+
+    if (frame == 0) {
+        return false;
+    }
+
+    IEC0bits.AD1IE = 0;
+    ready = adc_frame_ready;
+    *frame = adc_frames[adc_frame_idx];
+    adc_frame_ready = false;
+    IEC0bits.AD1IE = (adc_mode != ADC_MODE_SINGLE) ? 1 : 0;
+
+    return ready;
+}
+
+/* Fija el punto del periodo PWM en que se dispara la conversión. Puede
+   llamarse con el ADC en marcha para mover el instante de muestreo. */
+void ADC_SetPwmTrigger(const ADC_PwmTrigger_t *trigger)
+{
+    if (trigger == 0) {
+        return;
+    }
+
+    SEVTCMPbits.SEVTCMP = trigger->sevtcmp & 0x7FFFu;
+    SEVTCMPbits.SEVTDIR = trigger->count_down ? 1 : 0;
+    PWMCON2bits.SEVOPS = trigger->postscale & 0x0Fu;
+}
+
+/* --------------------------------------------------------------------------
+ * Interrupción
+ * ------------------------------------------------------------------------ */
+
+/* Frame completo: CH0..CH3 quedan en ADC1BUF0..3 en ese orden */
+static void adc_scan_isr(void)
+{
+    volatile uint16_t *src = (volatile uint16_t *)&ADC1BUF0;
+    uint8_t next = adc_frame_idx ^ 1u;
+    ADC_Frame_t *f = &adc_frames[next];
+    uint8_t i;
+
+    for (i = 0; i < ADC_MAX_SIMUL_CHANNELS; i++) {
+        f->ch[i] = (i < adc_scan_channels) ? src[i] : 0;
+    }
+    f->ch0_input = adc_scan_input;
+    f->sequence = ++adc_frame_seq;
+
+    adc_frame_idx = next;
+    adc_frame_ready = true;
+
+    /* Paso de control lo antes posible: el retardo disparo -> actuación queda
+       fijo (conversión + copia del frame) */
+    if (adc_scan_callback) {
+        adc_scan_callback(f);
+    }
+
+    if (adc_scan_mask != 0) {
+        adc_scan_input = adc_scan_next_input(adc_scan_mask, adc_scan_input);
+    }
+}
+
+/* Bloque completo: publicarlo y pasar al otro */
+static void adc_stream_publish(void)
+{
+    if (adc_stream_ready) {
+        adc_stream_overruns++;  /* el anterior no se consumió a tiempo */
+    }
+    adc_stream_blocks++;
+    adc_stream_ready_idx = adc_stream_fill;
+    adc_stream_ready = true;
+    adc_stream_fill ^= 1u;
+    adc_stream_pos = 0;
+
+    if (adc_stream_callback) {
+        adc_stream_callback(adc_stream_buf[adc_stream_ready_idx], ADC_STREAM_BLOCK_LENGTH);
+    }
+}
+
+/* Sobremuestreo: acumular la mitad lista y emitir un resultado cada 4^n
+   conversiones. En fraccional las muestras llevan signo. */
+static void adc_oversample_isr(volatile uint16_t *src)
+{
+    uint16_t ratio = 1u << (2u * adc_os_log4);
+    bool frac = (adc_stream_format == ADC_FORMAT_FRACTIONAL);
+    int32_t acc = adc_os_acc;
+    uint16_t count = adc_os_count;
+    uint16_t i;
+
+    for (i = 0; i < ADC_STREAM_HALF_LENGTH; i++) {
+        acc += frac ? (int32_t)(int16_t)src[i] : (int32_t)src[i];
+        if (++count < ratio) {
+            continue;
+        }
+
+        adc_stream_buf[adc_stream_fill][adc_stream_pos] =
+            (uint16_t)(acc >> (frac ? 2u * adc_os_log4 : adc_os_log4));
+        acc = 0;
+        count = 0;
+
+        if (++adc_stream_pos >= ADC_STREAM_BLOCK_LENGTH) {
+            adc_stream_publish();
+        }
+    }
+
+    adc_os_acc = acc;
+    adc_os_count = count;
+}
+
+/* Media mitad del buffer lista en modo streaming */
+static void adc_stream_isr(void)
+{
+    volatile uint16_t *src;
+    uint16_t *dst;
+    uint16_t i;
+
+    /* BUFS = 1: el ADC está llenando ADC1BUF8..F, la mitad baja está lista */
+    src = AD1CON2bits.BUFS ? (volatile uint16_t *)&ADC1BUF0 : (volatile uint16_t *)&ADC1BUF8;
+
+    if (adc_os_log4 != 0) {
+        adc_oversample_isr(src);
+        return;
+    }
+
+    dst = &adc_stream_buf[adc_stream_fill][adc_stream_pos];
+
+    for (i = 0; i < ADC_STREAM_HALF_LENGTH; i++) {
+        dst[i] = src[i];
+    }
+
+    adc_stream_pos += ADC_STREAM_HALF_LENGTH;
+    if (adc_stream_pos >= ADC_STREAM_BLOCK_LENGTH) {
+        adc_stream_publish();
+    }
+}
+
+/* ISR del ADC: streaming (cada ADC_STREAM_HALF_LENGTH conversiones) o
+   multicanal (cada frame) */
+void ADC_ISR_Handler(void)
+{
+    IFS0bits.AD1IF = 0;
+
+    if (adc_mode == ADC_MODE_SCAN) {
+        adc_scan_isr();
+    } else if (adc_mode == ADC_MODE_STREAM) {
+        adc_stream_isr();
+    }
+}
@@ -9,10 +9,37 @@
  *   void ADC_StartSingle(uint8_t channel);           // inicia conversión (no bloqueante)
  *   bool ADC_IsConversionDone(void);                 // comprueba si terminó
  *   uint16_t ADC_GetResult(void);                    // devuelve resultado del último muestreo
+ *   uint16_t ADC_ReadAveragedBlocking(uint8_t channel, uint8_t log4_ratio); // 12 + n bits
+ *
+ *   void ADC_StreamStart(uint8_t channel, ADC_BlockCallback_t cb); // adquisición continua
+ *   uint32_t ADC_StartTimed(uint8_t channel, uint32_t rate_hz,
+ *                           ADC_BlockCallback_t cb);  // tasa fija (Timer3), devuelve tasa real
+ *   uint32_t ADC_StartOversampled(uint8_t channel, uint32_t output_rate_hz,
+ *                                 uint8_t log4_ratio, ADC_BlockCallback_t cb);
+ *   void ADC_SetStreamFormat(ADC_Format_t format);   // entero o Q15 (FORM = 11)
+ *   uint8_t ADC_StreamGetResolutionBits(void);       // bits útiles de cada resultado
+ *   void ADC_StreamStop(void);                       // vuelve al modo manual
+ *   bool ADC_StreamBlockReady(void);                 // true si hay un bloque completo
+ *   const uint16_t *ADC_StreamGetBlock(void);        // bloque listo (ping-pong)
+ *   uint32_t ADC_ScanStart(const ADC_ScanConfig_t *cfg,
+ *                          ADC_FrameCallback_t cb);     // CH0..CH3 simultáneos
+ *   bool ADC_GetFrame(ADC_Frame_t *frame);           // último frame multicanal
+ *   void ADC_ISR_Handler(void);                      // llamar desde _ADC1Interrupt
  *
  * Nota:
  * - Configura los pines como analógicos (ANx) en tu main antes de usar el ADC.
  * - Ajusta AD1CON3.ADCS y AD1CON3.SAMC en adc.c para tiempos de adquisición/Tad
+ * - El dsPIC33FJ32MC204 no tiene controlador DMA: el modo streaming usa el
+ *   buffer interno ADC1BUF0..F partido en dos mitades (BUFM = 1) como
+ *   ping-pong hardware, y la ISR vuelca cada mitad (8 muestras) a dos
+ *   bloques en RAM. La CPU sólo interviene una vez cada 8 conversiones.
+ * - Manual y streaming trabajan en 12 bits (AD12B = 1); el multicanal
+ *   simultáneo en 10 bits, que es lo que admite el hardware con SIMSAM.
+ * - Sobremuestreo: en la misma interrupción de cada mitad se acumulan 4^n
+ *   conversiones por resultado en lugar de copiarlas, así que el coste por
+ *   conversión es el mismo que en streaming normal y la ISR sigue saltando
+ *   cada 8. Cada 4x de muestras da 1 bit efectivo más (con ruido de al
+ *   menos 1 LSB a la entrada, que hace de dither).
  */
 
 #ifndef ADC_H
@@ -35,10 +62,147 @@ void ADC_StartSingle(uint8_t channel); /* inicia muestreo/conversión en channel
 bool ADC_IsConversionDone(void);       /* true si DONE */
 uint16_t ADC_GetResult(void);          /* resultado del último muestreo (raw) */
 
-/* Resolución en bits (definir según AD1CON1.FORM y AD1CON3 configuración) */
+/* Resolución del convertidor en modo manual y streaming (AD12B = 1) */
 #define ADC_RESOLUTION_BITS 12u
 #define ADC_MAX_VALUE       ((1u << ADC_RESOLUTION_BITS) - 1u)
 
+/* Sobremuestreo: 4^n conversiones por resultado, n = 1..3 (4, 16 o 64) */
+#define ADC_OVERSAMPLE_MAX_LOG4 3u
+
+/* Lee 4^log4_ratio veces el canal y devuelve la suma >> log4_ratio:
+   resultado de ADC_RESOLUTION_BITS + log4_ratio bits (bloqueante) */
+uint16_t ADC_ReadAveragedBlocking(uint8_t channel, uint8_t log4_ratio);
+
+/* Formato de los bloques de streaming (valor de FORM) */
+typedef enum {
+    ADC_FORMAT_INTEGER    = 0,   /* entero sin signo, alineado a la derecha */
+    ADC_FORMAT_FRACTIONAL = 3    /* fraccional con signo: Q15 listo para FIR */
+} ADC_Format_t;
+
+/* Fuente de disparo de la conversión en los modos automáticos (valor de SSRC) */
+typedef enum {
+    ADC_TRIGGER_TIMER3 = 2,   /* Fin de periodo de Timer3: tasa fija */
+    ADC_TRIGGER_PWM    = 3,   /* Evento especial del PWM de motor (SEVTCMP) */
+    ADC_TRIGGER_AUTO   = 7    /* Contador SAMC: máxima tasa */
+} ADC_Trigger_t;
+
+/* --------------------------------------------------------------------------
+ * Modo streaming (conversión automática SSRC = 111, ASAM = 1)
+ * ------------------------------------------------------------------------ */
+
+/* Muestras por bloque ping-pong. Debe ser múltiplo de ADC_STREAM_HALF_LENGTH. */
+#ifndef ADC_STREAM_BLOCK_LENGTH
+#define ADC_STREAM_BLOCK_LENGTH 64u
+#endif
+
+/* Mitad del buffer hardware ADC1BUFx (SMPI = 7 -> interrupción cada 8 muestras) */
+#define ADC_STREAM_HALF_LENGTH  8u
+
+#if (ADC_STREAM_BLOCK_LENGTH % ADC_STREAM_HALF_LENGTH) != 0
+#error "ADC_STREAM_BLOCK_LENGTH debe ser múltiplo de 8"
+#endif
+
+/* Callback de bloque listo. Se ejecuta en contexto de interrupción: debe ser
+   corto (p. ej. marcar un flag o encolar el puntero). */
+typedef void (*ADC_BlockCallback_t)(const uint16_t *block, uint16_t length);
+
+void ADC_StreamStart(uint8_t channel, ADC_BlockCallback_t callback);
+
+/* Tasa fija: Timer3 dispara cada conversión (SSRC = 010). El periodo se calcula
+   con FCY de config.h; devuelve la tasa real en Hz (0 si no es alcanzable).
+   Timer3 queda reservado mientras dure el streaming. Si ya lo usa el DAC
+   (DAC_StreamStart con tasa propia) no se reprograma: se comparte cuando
+   la tasa pedida da su mismo periodo y si no se devuelve 0. Lo mismo vale
+   para ADC_StartOversampled y ADC_ScanStart con ADC_TRIGGER_TIMER3. */
+#ifndef ADC_TIMED_MAX_RATE_HZ
+#define ADC_TIMED_MAX_RATE_HZ 200000UL  /* margen sobre SAMC + 14 Tad de conversión */
+#endif
+uint32_t ADC_StartTimed(uint8_t channel, uint32_t sample_rate_hz, ADC_BlockCallback_t callback);
+
+/* Sobremuestreo a tasa fija: Timer3 convierte a output_rate_hz * 4^log4_ratio
+   y cada resultado del bloque es la acumulación de 4^log4_ratio muestras:
+     - ADC_FORMAT_INTEGER:    suma >> n, entero de 12 + n bits
+     - ADC_FORMAT_FRACTIONAL: suma >> 2n (media), Q15 con los bits extra en
+                              los LSB que el convertidor deja a cero
+   Devuelve la tasa real de resultados (Hz) o 0 si no es alcanzable. */
+uint32_t ADC_StartOversampled(uint8_t channel, uint32_t output_rate_hz,
+                              uint8_t log4_ratio, ADC_BlockCallback_t callback);
+
+/* Formato de los bloques en streaming y sobremuestreo (aplica al siguiente
+   arranque). Con ADC_FORMAT_FRACTIONAL cada bloque se puede leer como
+   fractional / int16_t sin conversión. El multicanal es siempre entero. */
+void ADC_SetStreamFormat(ADC_Format_t format);
+ADC_Format_t ADC_GetStreamFormat(void);
+
+/* Bits útiles de cada resultado del streaming en curso: 12 + n en entero,
+   16 (Q15) en fraccional */
+uint8_t ADC_StreamGetResolutionBits(void);
+
+/* Para Timer3 sólo si lo arrancó el ADC; la interrupción de Timer3 (DAC) no
+   se toca */
+void ADC_StreamStop(void);
+bool ADC_StreamIsRunning(void);
+bool ADC_StreamBlockReady(void);            /* true si hay un bloque sin consumir */
+const uint16_t *ADC_StreamGetBlock(void);   /* devuelve el bloque listo y limpia el flag */
+uint16_t ADC_StreamGetOverruns(void);       /* bloques sobrescritos sin ser consumidos */
+uint32_t ADC_StreamGetBlockCount(void);     /* bloques publicados desde el arranque del modo */
+
+/* --------------------------------------------------------------------------
+ * Modo multicanal simultáneo (CH0..CH3, SIMSAM = 1) con escaneo de CH0
+ * ------------------------------------------------------------------------ */
+
+#define ADC_MAX_SIMUL_CHANNELS 4u
+
+/* Resultado de un disparo: todas las fases muestreadas en el mismo instante */
+typedef struct {
+    uint16_t ch[ADC_MAX_SIMUL_CHANNELS]; /* CH0..CH3 (los no usados valen 0) */
+    uint8_t ch0_input;                   /* ANx convertido por CH0 en este frame */
+    uint16_t sequence;                   /* contador de frames (detecta pérdidas) */
+} ADC_Frame_t;
+
+typedef struct {
+    uint8_t num_channels;    /* 1, 2 o 4 canales S&H (CHPS) */
+    uint8_t ch0_input;       /* ANx de CH0 si no hay escaneo */
+    uint16_t ch0_scan_mask;  /* AD1CSSL: != 0 -> CH0 recorre estas entradas (CSCNA) */
+    bool ch123_upper;        /* false: CH1..3 = AN0..AN2, true: AN3..AN5 */
+    ADC_Trigger_t trigger;   /* disparo de cada frame */
+    uint32_t rate_hz;        /* tasa de frames si trigger == ADC_TRIGGER_TIMER3 */
+} ADC_ScanConfig_t;
+
+/* Callback de frame: contexto de interrupción */
+typedef void (*ADC_FrameCallback_t)(const ADC_Frame_t *frame);
+
+uint32_t ADC_ScanStart(const ADC_ScanConfig_t *config, ADC_FrameCallback_t callback);
+bool ADC_FrameReady(void);
+bool ADC_GetFrame(ADC_Frame_t *frame);      /* copia coherente del último frame */
+
+/* ADC_StreamStop() detiene también el modo multicanal */
+
+/* --------------------------------------------------------------------------
+ * Disparo sincronizado con el PWM de control de motor (SSRC = 011)
+ *
+ * Con trigger = ADC_TRIGGER_PWM en ADC_ScanStart() cada frame se convierte en
+ * el instante en que PTMR alcanza SEVTCMP, y el callback de frame es el paso
+ * del lazo de control: se ejecuta una vez por periodo PWM (o cada
+ * postscale + 1) con retardo fijo respecto al disparo. El PWM lo configura
+ * la aplicación (PTPER, PTMOD, duty); aquí sólo se fija el punto de disparo.
+ *
+ * En modo centrado (PTMOD = 10 u 11) con sevtcmp = 0 y count_down = false el
+ * disparo cae en el centro del pulso activo; con sevtcmp = PTPER, en el centro
+ * del tiempo en bajo (shunts en la rama inferior).
+ * ------------------------------------------------------------------------ */
+
+typedef struct {
+    uint16_t sevtcmp;        /* posición del disparo en cuentas de PTMR (15 bits) */
+    bool count_down;         /* SEVTDIR: disparo en la rampa descendente */
+    uint8_t postscale;       /* SEVOPS: 0 -> cada periodo, n -> cada n + 1 periodos */
+} ADC_PwmTrigger_t;
+
+void ADC_SetPwmTrigger(const ADC_PwmTrigger_t *trigger);
+
+/* Handler de la interrupción del ADC (llamar desde _ADC1Interrupt) */
+void ADC_ISR_Handler(void);
+
 #ifdef __cplusplus
 }
 #endif
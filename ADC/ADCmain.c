@@ -10,22 +10,28 @@
  *    8 bits más significativos del resultado ADC (12-bit -> usamos bits [11:4]).
  *
  * Requisitos:
- *  - Asegúrate de haber añadido config.h, config.c, adc.h y adc.c al proyecto.
+ *  - Asegúrate de haber añadido config.h, config.c, clock.c, sched.c, adc.h y
+ *    adc.c al proyecto.
  *  - Ajusta los mapeos de pines si tu encapsulado no dispone de RB0..RB7.
  *
  * Nota:
- *  - config.h define FCY y la macro DELAY_MS(ms) usando libpic30.
+ *  - config.h define FCY, que el driver ADC usa para calcular el periodo de
+ *    Timer3 (muestreo a tasa fija, sin DELAY_MS en el bucle).
+ *  - El bucle principal es el planificador de sched.h: una tarea recoge los
+ *    bloques del ADC y otra refresca los LEDs.
  *  - Este main intenta ser robusto frente a distintas definiciones de registros
  *    (AD1PCFGL / AD1PCFG, ANSELAbits, etc.) usando #ifdef.
  */
 
 #include "config.h"
 #include "adc.h"
+#include "sched.h"
 #include <xc.h>
 #include <stdint.h>
 
-/* Tiempo entre lecturas (ms) */
-#define SAMPLE_PERIOD_MS 50u
+/* Tasa de muestreo fija (Timer3). El promedio cambia una vez por bloque:
+   SAMPLE_RATE_HZ / ADC_STREAM_BLOCK_LENGTH veces por segundo. */
+#define SAMPLE_RATE_HZ 1000u
 
 static void board_pins_init(void)
 {
@@ -69,13 +75,45 @@ static void board_pins_init(void)
     #endif
 }
 
+/* Último promedio de bloque (12 bits), lo escribe tarea_adc */
+static uint16_t adc_value = 0;
+
+/* Tarea 1 ms: recoge el bloque completo de AN0, si lo hay, y lo promedia */
+static void tarea_adc(void)
+{
+    const uint16_t *block;
+    uint32_t suma = 0;
+    uint16_t i;
+
+    block = ADC_StreamGetBlock();
+    if (block == 0) {
+        return;     /* el periodo de muestreo lo marca Timer3 */
+    }
+
+    for (i = 0; i < ADC_STREAM_BLOCK_LENGTH; i++) {
+        suma += block[i];
+    }
+    adc_value = (uint16_t)(suma / ADC_STREAM_BLOCK_LENGTH);
+}
+
+/* Tarea 20 ms: 8 MSB del promedio en RB0..RB7 */
+static void tarea_leds(void)
+{
+    /* Tomamos bits [11:4] de la lectura 12-bit para obtener 8 niveles */
+    uint8_t leds = (uint8_t)((adc_value >> 4) & 0xFFu);
+
+    /* Escribir en LATB (preservar bits altos si existen) */
+    #ifdef LATB
+        LATB = (LATB & 0xFF00) | leds;
+    #elif defined(PORTB)
+        PORTB = (PORTB & 0xFF00) | leds;
+    #endif
+}
+
 /* Función principal */
 int main(void)
 {
-    uint16_t adc_value;
-    uint8_t leds;
-
-    /* Inicialización del sistema (puertos, gestión básica) */
+    /* Inicialización del sistema (puertos, gestión básica, tick de 1 ms) */
     SYSTEM_Initialize();
 
     /* Inicialización de pines específica para esta aplicación */
@@ -84,29 +122,30 @@ int main(void)
     /* Imprimir configuración (si stdout está redirigido a UART) */
     SYSTEM_PrintConfiguration();
 
-    /* Inicializar ADC */
+    /* Inicializar ADC y arrancar el muestreo periódico de AN0 (canal = 0) */
     ADC_Init();
+    ADC_StartTimed(0, SAMPLE_RATE_HZ, 0);
 
-    /* Bucle principal: leer AN0 y mostrar 8 MSB en RB0..RB7 */
-    while (1)
-    {
-        /* Lectura bloqueante en canal AN0 (canal = 0) */
-        adc_value = ADC_ReadSingleBlocking(0);
-
-        /* Tomamos bits [11:4] de la lectura 12-bit para obtener 8 niveles */
-        leds = (uint8_t)((adc_value >> 4) & 0xFFu);
+    /* Tareas periódicas: la lectura del ADC y el refresco de los LEDs no
+       comparten milisegundo (fase 5 ms) */
+    SCHED_Init();
+    SCHED_AddTask("adc", tarea_adc, 1, 0);
+    SCHED_AddTask("leds", tarea_leds, 20, 5);
 
-        /* Escribir en LATB (preservar bits altos si existen) */
-        #ifdef LATB
-            LATB = (LATB & 0xFF00) | leds;
-        #elif defined(PORTB)
-            PORTB = (PORTB & 0xFF00) | leds;
-        #endif
-
-        /* Esperar antes de la siguiente lectura para que los LEDs sean visibles */
-        DELAY_MS(SAMPLE_PERIOD_MS);
-    }
+    /* Entre tareas la CPU queda en Idle: Timer3 y el ADC siguen muestreando
+       y el tick o el fin de bloque la despiertan */
+    SYSTEM_SetWakeSources(SYSTEM_WAKE_TICK | SYSTEM_WAKE_ADC);
+    SCHED_SetIdleHook(SYSTEM_EnterIdle);
+    SCHED_Run();
 
     /* no debería llegar aquí */
     return 0;
+}
+
+/* Interrupción del ADC: con ADC_StartTimed llena los bloques ping-pong a la
+   tasa de Timer3; tarea_adc los recoge desde el planificador y el fin de
+   bloque despierta a la CPU del Idle (SYSTEM_WAKE_ADC) */
+void __attribute__((interrupt, no_auto_psv)) _ADC1Interrupt(void)
+{
+    ADC_ISR_Handler();
 }
\ No newline at end of file
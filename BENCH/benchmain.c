@@ -0,0 +1,513 @@
+/*
+ * benchmain.c - Benchmark de las rutas críticas para dsPIC33FJ32MC204
+ *
+ * Autor: Carlos Olivera Ylla
+ *
+ * Descripción:
+ *  Mide en ciclos de instrucción (Tcy), con el par Timer2/3 en 32 bits:
+ *    - FIR(BLOCK_LENGTH, ...) con el pasabajo de 75 taps de lowpassexample.s
+ *    - FIR(1, ...) con el mismo filtro (modo muestra de firpipe.h)
+ *    - Banco multitasa (filterbank.h): decimación x4, biquad y
+ *      interpolación x4 sobre el mismo bloque
+ *    - ADC_ReadSingleBlocking(0)
+ *    - I2C_WriteData() de BENCH_I2C_BYTES bytes a la EEPROM (0x50)
+ *  y guarda min/avg/max por llamada y por muestra en BenchResults[] (RAM,
+ *  visible desde el depurador o MPLAB SIM) y por printf si stdout está
+ *  redirigido a la UART.
+ *
+ *  Regresiones antes de grabar:
+ *    - Numéricas: FIR() (bloque y muestra a muestra) y los núcleos de
+ *      q15vec.s se comparan muestra a muestra con el modelo en C de
+ *      q15ref.h sobre _square1k y los taps de lowpassexample.s. Cualquier
+ *      diferencia cuenta: los resultados deben ser idénticos bit a bit.
+ *      El modelo se comprueba antes en el PC contra la salida guardada
+ *      (FILTROFIR/test_q15ref.c, 'make test' en FILTROFIR/).
+ *    - Filtro del pool (filterpool.h): creado en tiempo de ejecución y con
+ *      cambio de coeficientes a mitad de bloque; la salida debe seguir al
+ *      modelo sin transitorio (línea de retardo conservada).
+ *    - De ciclos: la media por muestra de cada medida se compara con
+ *      BenchBudget[] (0 = sin límite). Fijar los límites con una ejecución
+ *      buena y dejarlos un poco por encima.
+ *  El resumen queda en BenchChecks[] y BenchFailures (0 = todo bien).
+ *
+ * Configuración "bench" (MPLAB X):
+ *  - Archivos: benchmain.c, config.c, perf.c, adc.c, i2c.c, filterbank.c,
+ *    filterpool.c, q15vec.s, q15ref.c, lowpassexample.s, multirate.s,
+ *    inputsignal_square1khz.s y libdsp.
+ *  - Macros del proyecto: CONFIG_PERF_TIMER32 (Timer2/3 como contador).
+ *    El pool va con su tamaño por defecto (FPOOL_MAX_TAPS = 32, 128 + 64
+ *    bytes) y la prueba usa los FPOOL_MAX_TAPS taps centrales del pasabajo.
+ *  - En MPLAB SIM (sin ADC ni EEPROM reales) definir BENCH_WITH_HW=0: se
+ *    omiten las medidas de ADC e I2C y el resto da los mismos ciclos que
+ *    en la placa.
+ *  - Compara los resultados antes y después de cada cambio en estas rutas
+ *    con el mismo nivel de optimización.
+ *
+ */
+
+#include "config.h"
+#include "perf.h"
+#include "adc.h"
+#include "i2c.h"
+#include "filterbank.h"
+#include "filterpool.h"
+#include "q15vec.h"
+#include "q15ref.h"
+#include <xc.h>
+#include <stdio.h>
+#include "dsp.h"
+
+#ifndef CONFIG_PERF_TIMER32
+#error "benchmain.c necesita CONFIG_PERF_TIMER32 (contador de 32 bits)"
+#endif
+
+/* Parámetros del benchmark */
+#define BENCH_ITERATIONS   32u
+#define BLOCK_LENGTH       256u      /* muestras de _square1k */
+#define BENCH_I2C_ADDRESS  0x50      /* EEPROM 24LC256 */
+#define BENCH_I2C_BYTES    4u
+
+#ifndef BENCH_WITH_HW
+#define BENCH_WITH_HW      1         /* 0 en MPLAB SIM: sin ADC ni I2C */
+#endif
+
+extern fractional square1k[BLOCK_LENGTH];       /* _square1k en inputsignal_square1khz.s */
+extern FIRStruct lowpassexampleFilter;          /* _lowpassexampleFilter en lowpassexample.s */
+
+#define DECIM_LENGTH       (BLOCK_LENGTH / FBANK_DECIMATION)
+
+static fractional FilterOut[BLOCK_LENGTH];
+static fractional DecimOut[DECIM_LENGTH];
+
+/* Log en RAM de resultados */
+typedef enum {
+    BENCH_FIR = 0,
+    BENCH_FIR_SAMPLE,
+    BENCH_FIR_DECIMATE,
+    BENCH_BIQUAD,
+    BENCH_FIR_INTERPOLATE,
+    BENCH_ADC_SINGLE,
+    BENCH_I2C_WRITE,
+    BENCH_COUNT
+} Bench_Id_t;
+
+PERF_Stat_t BenchResults[BENCH_COUNT];
+
+/* Límite de ciclos por muestra (media), 0 = sin límite. FIR() de libdsp
+   cuesta unos 4 + N ciclos por muestra en bloque y 53 + 4 + N por llamada
+   con una sola muestra (N = 75 taps). */
+static const uint32_t BenchBudget[BENCH_COUNT] = {
+    [BENCH_FIR]             = 85,
+    [BENCH_FIR_SAMPLE]      = 140,
+    [BENCH_FIR_DECIMATE]    = 0,
+    [BENCH_BIQUAD]          = 0,
+    [BENCH_FIR_INTERPOLATE] = 0,
+    [BENCH_ADC_SINGLE]      = 0,
+    [BENCH_I2C_WRITE]       = 0,
+};
+
+/* Comparación con el modelo de referencia */
+typedef enum {
+    CHECK_FIR = 0,
+    CHECK_FIR_SAMPLE,
+    CHECK_ABS,
+    CHECK_SHIFT,
+    CHECK_SCALE,
+    CHECK_ADD,
+    CHECK_DOT,
+    CHECK_SUMSQ,
+    CHECK_FROM_ADC,
+    CHECK_MAX_PEAK,
+    CHECK_FPOOL_SWAP,
+    CHECK_COUNT
+} Bench_CheckId_t;
+
+typedef struct {
+    const char *name;
+    uint16_t checked;        /* muestras comparadas */
+    uint16_t mismatches;
+    uint16_t first_index;    /* primera diferencia (si mismatches != 0) */
+    int16_t max_error;       /* en LSB Q15 */
+} Bench_Check_t;
+
+Bench_Check_t BenchChecks[CHECK_COUNT];
+volatile uint16_t BenchFailures;
+
+static int16_t RefDelay[75];     /* línea de retardo del modelo (lowpassexample) */
+
+/* Filtro del pool: como mucho los 75 taps de lowpassexample */
+#define BENCH_FPOOL_TAPS   ((FPOOL_MAX_TAPS < 75) ? FPOOL_MAX_TAPS : 75)
+
+static FPOOL_Filter_t PoolFilter;
+
+static void bench_fir(PERF_Stat_t *stat)
+{
+    PERF_Cycles_t t0;
+    uint16_t i;
+
+    PERF_StatReset(stat, "FIR 75 taps", BLOCK_LENGTH);
+    FIRDelayInit(&lowpassexampleFilter);
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = PERF_Now();
+        FIR(BLOCK_LENGTH, &FilterOut[0], &square1k[0], &lowpassexampleFilter);
+        PERF_StatAdd(stat, PERF_Elapsed(t0) - PERF_GetOverhead());
+    }
+}
+
+/* Modo muestra de firpipe: FIR() con N = 1. min y max deben coincidir */
+static void bench_fir_sample(PERF_Stat_t *stat)
+{
+    PERF_Cycles_t t0;
+    uint16_t i;
+
+    PERF_StatReset(stat, "FIR 1 muestra", 1);
+    FIRDelayInit(&lowpassexampleFilter);
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = PERF_Now();
+        FIR(1, &FilterOut[i], &square1k[i], &lowpassexampleFilter);
+        PERF_StatAdd(stat, PERF_Elapsed(t0) - PERF_GetOverhead());
+    }
+}
+
+/* Por muestra de entrada (BLOCK_LENGTH a fs): comparable con bench_fir */
+static void bench_fir_decimate(PERF_Stat_t *stat)
+{
+    PERF_Cycles_t t0;
+    uint16_t i;
+
+    PERF_StatReset(stat, "FIRDecimate x4", BLOCK_LENGTH);
+    FBANK_Init();
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = PERF_Now();
+        FBANK_Decimate(DECIM_LENGTH, &DecimOut[0], &square1k[0]);
+        PERF_StatAdd(stat, PERF_Elapsed(t0) - PERF_GetOverhead());
+    }
+}
+
+static void bench_biquad(PERF_Stat_t *stat)
+{
+    PERF_Cycles_t t0;
+    uint16_t i;
+
+    PERF_StatReset(stat, "IIR biquad x2", DECIM_LENGTH);
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = PERF_Now();
+        FBANK_Biquad(DECIM_LENGTH, &FilterOut[0], &DecimOut[0]);
+        PERF_StatAdd(stat, PERF_Elapsed(t0) - PERF_GetOverhead());
+    }
+}
+
+/* Por muestra de salida (BLOCK_LENGTH a fs) */
+static void bench_fir_interpolate(PERF_Stat_t *stat)
+{
+    PERF_Cycles_t t0;
+    uint16_t i;
+
+    PERF_StatReset(stat, "FIRInterpolate x4", BLOCK_LENGTH);
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = PERF_Now();
+        FBANK_Interpolate(DECIM_LENGTH, &FilterOut[0], &DecimOut[0]);
+        PERF_StatAdd(stat, PERF_Elapsed(t0) - PERF_GetOverhead());
+    }
+}
+
+static void bench_adc_single(PERF_Stat_t *stat)
+{
+    PERF_Cycles_t t0;
+    volatile uint16_t r;
+    uint16_t i;
+
+    PERF_StatReset(stat, "ADC single", 1);
+    ADC_Init();
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = PERF_Now();
+        r = ADC_ReadSingleBlocking(0);
+        PERF_StatAdd(stat, PERF_Elapsed(t0) - PERF_GetOverhead());
+    }
+    (void)r;
+}
+
+static void bench_i2c_write(PERF_Stat_t *stat)
+{
+    I2C_Config_t config = I2C_CONFIG_DEFAULT_MASTER;
+    uint8_t data[BENCH_I2C_BYTES] = { 0x00, 0x00, 0xA5, 0x5A };
+    PERF_Cycles_t t0;
+    uint16_t i;
+
+    PERF_StatReset(stat, "I2C_WriteData", BENCH_I2C_BYTES);
+    I2C_Init(&config);
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        t0 = PERF_Now();
+        I2C_WriteData(I2C_MODULE_1, BENCH_I2C_ADDRESS, data, BENCH_I2C_BYTES);
+        PERF_StatAdd(stat, PERF_Elapsed(t0) - PERF_GetOverhead());
+        /* Sin esperar el ciclo de escritura de la EEPROM: las siguientes
+           transferencias miden el camino de NACK, que también es una ruta
+           real del driver */
+    }
+}
+
+static void check_reset(Bench_Check_t *c, const char *name)
+{
+    c->name = name;
+    c->checked = 0;
+    c->mismatches = 0;
+    c->first_index = 0;
+    c->max_error = 0;
+}
+
+static void check_sample(Bench_Check_t *c, int16_t got, int16_t expected)
+{
+    int32_t err = (int32_t)got - expected;
+
+    if (err < 0) err = -err;
+    if (err != 0) {
+        if (c->mismatches == 0) {
+            c->first_index = c->checked;
+        }
+        c->mismatches++;
+        if (err > c->max_error) {
+            c->max_error = (err > 32767) ? 32767 : (int16_t)err;
+        }
+    }
+    c->checked++;
+}
+
+/* FIR() en bloque sobre _square1k frente a Q15REF_FirSample */
+static void check_fir(Bench_Check_t *c)
+{
+    Q15REF_Fir_t ref;
+    uint16_t i;
+
+    check_reset(c, "FIR bloque");
+    FIRDelayInit(&lowpassexampleFilter);
+    FIR(BLOCK_LENGTH, &FilterOut[0], &square1k[0], &lowpassexampleFilter);
+
+    Q15REF_FirInit(&ref, lowpassexampleFilter.coeffsBase, RefDelay,
+                   (uint16_t)lowpassexampleFilter.numCoeffs);
+    for (i = 0; i < BLOCK_LENGTH; i++) {
+        check_sample(c, FilterOut[i], Q15REF_FirSample(&ref, square1k[i]));
+    }
+}
+
+/* Modo muestra de firpipe: FIR(1, ...) debe dar lo mismo que en bloque */
+static void check_fir_sample(Bench_Check_t *c)
+{
+    Q15REF_Fir_t ref;
+    uint16_t i;
+
+    check_reset(c, "FIR muestra");
+    FIRDelayInit(&lowpassexampleFilter);
+    Q15REF_FirInit(&ref, lowpassexampleFilter.coeffsBase, RefDelay,
+                   (uint16_t)lowpassexampleFilter.numCoeffs);
+
+    for (i = 0; i < BLOCK_LENGTH; i++) {
+        fractional y;
+        FIR(1, &y, &square1k[i], &lowpassexampleFilter);
+        check_sample(c, y, Q15REF_FirSample(&ref, square1k[i]));
+    }
+}
+
+/* Núcleos de q15vec.s: salida en FilterOut, referencia elemento a elemento */
+static void check_q15vec(void)
+{
+    uint16_t i;
+    int16_t expected;
+
+    /* Los taps del pasabajo tienen signo y amplitud variados */
+    check_reset(&BenchChecks[CHECK_ABS], "Q15_VectorAbs");
+    Q15_VectorAbs((uint16_t)lowpassexampleFilter.numCoeffs, FilterOut, lowpassexampleFilter.coeffsBase);
+    for (i = 0; i < lowpassexampleFilter.numCoeffs; i++) {
+        Q15REF_VectorAbs(1, &expected, &lowpassexampleFilter.coeffsBase[i]);
+        check_sample(&BenchChecks[CHECK_ABS], FilterOut[i], expected);
+    }
+
+    /* x2 satura en los flancos de _square1k, /8 trunca */
+    check_reset(&BenchChecks[CHECK_SHIFT], "Q15_VectorShift");
+    Q15_VectorShift(BLOCK_LENGTH / 2, FilterOut, square1k, 1);
+    Q15_VectorShift(BLOCK_LENGTH / 2, &FilterOut[BLOCK_LENGTH / 2], square1k, -3);
+    for (i = 0; i < BLOCK_LENGTH / 2; i++) {
+        Q15REF_VectorShift(1, &expected, &square1k[i], 1);
+        check_sample(&BenchChecks[CHECK_SHIFT], FilterOut[i], expected);
+        Q15REF_VectorShift(1, &expected, &square1k[i], -3);
+        check_sample(&BenchChecks[CHECK_SHIFT], FilterOut[BLOCK_LENGTH / 2 + i], expected);
+    }
+
+    /* 0.75 con shift 1 = ganancia 1.5: satura en los flancos */
+    check_reset(&BenchChecks[CHECK_SCALE], "Q15_VectorScale");
+    Q15_VectorScale(BLOCK_LENGTH, FilterOut, square1k, 0x6000, 1);
+    for (i = 0; i < BLOCK_LENGTH; i++) {
+        Q15REF_VectorScale(1, &expected, &square1k[i], 0x6000, 1);
+        check_sample(&BenchChecks[CHECK_SCALE], FilterOut[i], expected);
+    }
+
+    /* x + x desplazada media vuelta del bloque */
+    check_reset(&BenchChecks[CHECK_ADD], "Q15_VectorAdd");
+    Q15_VectorAdd(BLOCK_LENGTH / 2, FilterOut, &square1k[0], &square1k[BLOCK_LENGTH / 2]);
+    for (i = 0; i < BLOCK_LENGTH / 2; i++) {
+        Q15REF_VectorAdd(1, &expected, &square1k[i], &square1k[BLOCK_LENGTH / 2 + i]);
+        check_sample(&BenchChecks[CHECK_ADD], FilterOut[i], expected);
+    }
+
+    check_reset(&BenchChecks[CHECK_DOT], "Q15_DotProduct");
+    check_sample(&BenchChecks[CHECK_DOT],
+                 Q15_DotProduct((uint16_t)lowpassexampleFilter.numCoeffs,
+                                square1k, lowpassexampleFilter.coeffsBase),
+                 Q15REF_DotProduct((uint16_t)lowpassexampleFilter.numCoeffs,
+                                   square1k, lowpassexampleFilter.coeffsBase));
+
+    /* Suma de cuadrados del bloque entero (2^8 = 256 muestras): se comparan
+       las dos mitades de 16 bits */
+    check_reset(&BenchChecks[CHECK_SUMSQ], "Q15_SumSquares");
+    {
+        uint32_t got = Q15_SumSquares(BLOCK_LENGTH, square1k, 8);
+        uint32_t ref = Q15REF_SumSquares(BLOCK_LENGTH, square1k, 8);
+        check_sample(&BenchChecks[CHECK_SUMSQ], (int16_t)(got >> 16), (int16_t)(ref >> 16));
+        check_sample(&BenchChecks[CHECK_SUMSQ], (int16_t)got, (int16_t)ref);
+    }
+
+    /* Entrada de la cadena ADC -> FIR: _square1k como si fuera un ADC de
+       12 bits (mitad superior, sin signo) */
+    check_reset(&BenchChecks[CHECK_FROM_ADC], "Q15_FromADC");
+    for (i = 0; i < BLOCK_LENGTH; i++) {
+        FilterOut[i] = (fractional)(((uint16_t)square1k[i] ^ 0x8000u) >> 4);
+    }
+    Q15_FromADC(BLOCK_LENGTH, FilterOut, (const uint16_t *)FilterOut, 12);
+    for (i = 0; i < BLOCK_LENGTH; i++) {
+        uint16_t raw = ((uint16_t)square1k[i] ^ 0x8000u) >> 4;
+        Q15REF_FromADC(1, &expected, &raw, 12);
+        check_sample(&BenchChecks[CHECK_FROM_ADC], FilterOut[i], expected);
+    }
+
+    /* Valor y posición de Max/Min/Peak sobre los taps (máximo repetido por
+       la simetría: debe salir la primera posición) */
+    check_reset(&BenchChecks[CHECK_MAX_PEAK], "Q15_VectorMax/Min/Peak");
+    {
+        uint16_t n = (uint16_t)lowpassexampleFilter.numCoeffs;
+        const fractional *taps = lowpassexampleFilter.coeffsBase;
+        uint16_t got_i, ref_i;
+
+        check_sample(&BenchChecks[CHECK_MAX_PEAK], Q15_VectorMax(n, taps, &got_i),
+                     Q15REF_VectorMax(n, taps, &ref_i));
+        check_sample(&BenchChecks[CHECK_MAX_PEAK], (int16_t)got_i, (int16_t)ref_i);
+        check_sample(&BenchChecks[CHECK_MAX_PEAK], Q15_VectorMin(n, taps, &got_i),
+                     Q15REF_VectorMin(n, taps, &ref_i));
+        check_sample(&BenchChecks[CHECK_MAX_PEAK], (int16_t)got_i, (int16_t)ref_i);
+        check_sample(&BenchChecks[CHECK_MAX_PEAK], Q15_VectorPeak(n, taps, &got_i),
+                     Q15REF_VectorPeak(n, taps, &ref_i));
+        check_sample(&BenchChecks[CHECK_MAX_PEAK], (int16_t)got_i, (int16_t)ref_i);
+    }
+}
+
+/* Filtro creado en el pool con los taps centrales del pasabajo; a mitad de
+   _square1k se cargan los mismos taps a media ganancia. El modelo cambia de
+   taps en la misma muestra y conserva su línea de retardo: si
+   FPOOL_FilterLoad la tocara, o dejara un puntero del banco viejo, la
+   segunda mitad no coincidiría. */
+static void check_fpool_swap(Bench_Check_t *c)
+{
+    const fractional *taps = lowpassexampleFilter.coeffsBase + (75 - BENCH_FPOOL_TAPS) / 2;
+    fractional *taps2 = &FilterOut[BLOCK_LENGTH / 2];   /* fuera de la salida */
+    Q15REF_Fir_t ref;
+    uint16_t i;
+
+    check_reset(c, "FPOOL cambio taps");
+    FPOOL_Reset();
+    if (!FPOOL_FilterCreate(&PoolFilter, BENCH_FPOOL_TAPS, taps, true)) {
+        c->mismatches = 1;   /* el pool no tiene sitio: FPOOL_MAX_TAPS */
+        return;
+    }
+    Q15REF_FirInit(&ref, taps, RefDelay, BENCH_FPOOL_TAPS);
+
+    FIR(BLOCK_LENGTH / 2, &FilterOut[0], &square1k[0], &PoolFilter.fir);
+    for (i = 0; i < BLOCK_LENGTH / 2; i++) {
+        check_sample(c, FilterOut[i], Q15REF_FirSample(&ref, square1k[i]));
+    }
+
+    Q15_VectorScale(BENCH_FPOOL_TAPS, taps2, taps, 0x4000, 0);
+    if (!FPOOL_FilterLoad(&PoolFilter, taps2) || PoolFilter.active != 1u) {
+        c->mismatches++;
+    }
+    ref.taps = taps2;
+
+    FIR(BLOCK_LENGTH / 2, &FilterOut[0], &square1k[BLOCK_LENGTH / 2], &PoolFilter.fir);
+    for (i = 0; i < BLOCK_LENGTH / 2; i++) {
+        check_sample(c, FilterOut[i], Q15REF_FirSample(&ref, square1k[BLOCK_LENGTH / 2 + i]));
+    }
+}
+
+/* Cuenta y muestra diferencias numéricas y medidas por encima del límite */
+static uint16_t bench_report(void)
+{
+    uint16_t failures = 0;
+    uint8_t i;
+
+    printf("\r\n=== Referencia (q15ref) ===\r\n");
+    for (i = 0; i < CHECK_COUNT; i++) {
+        const Bench_Check_t *c = &BenchChecks[i];
+        if (c->mismatches != 0) {
+            failures++;
+            printf("%-18s FALLO %u/%u (primera %u, error max %d)\r\n",
+                   c->name, c->mismatches, c->checked, c->first_index, c->max_error);
+        } else {
+            printf("%-18s OK (%u)\r\n", c->name, c->checked);
+        }
+    }
+
+    for (i = 0; i < BENCH_COUNT; i++) {
+        uint32_t avg = PERF_StatAvgPerSample(&BenchResults[i]);
+        if (BenchBudget[i] != 0 && BenchResults[i].calls != 0 && avg > BenchBudget[i]) {
+            failures++;
+            printf("%-18s ciclos/muestra %lu > %lu\r\n", BenchResults[i].name,
+                   (unsigned long)avg, (unsigned long)BenchBudget[i]);
+        }
+    }
+
+    printf("Fallos: %u\r\n", failures);
+    return failures;
+}
+
+int main(void)
+{
+    uint8_t i;
+
+    SYSTEM_Initialize();
+    PERF_Init();
+
+    bench_fir(&BenchResults[BENCH_FIR]);
+    bench_fir_sample(&BenchResults[BENCH_FIR_SAMPLE]);
+    bench_fir_decimate(&BenchResults[BENCH_FIR_DECIMATE]);
+    bench_biquad(&BenchResults[BENCH_BIQUAD]);
+    bench_fir_interpolate(&BenchResults[BENCH_FIR_INTERPOLATE]);
+#if BENCH_WITH_HW
+    bench_adc_single(&BenchResults[BENCH_ADC_SINGLE]);
+    bench_i2c_write(&BenchResults[BENCH_I2C_WRITE]);
+#endif
+
+    check_fir(&BenchChecks[CHECK_FIR]);
+    check_fir_sample(&BenchChecks[CHECK_FIR_SAMPLE]);
+    check_q15vec();
+    check_fpool_swap(&BenchChecks[CHECK_FPOOL_SWAP]);
+
+    printf("\r\n=== Benchmark (ciclos Tcy, overhead %lu descontado) ===\r\n",
+           (unsigned long)PERF_GetOverhead());
+    for (i = 0; i < BENCH_COUNT; i++) {
+        if (BenchResults[i].calls != 0) {
+            PERF_StatPrint(&BenchResults[i]);
+        }
+    }
+    BenchFailures = bench_report();
+
+    while (1) {
+        /* Poner aquí un breakpoint y leer BenchResults[], BenchChecks[] y
+           BenchFailures */
+    }
+
+    return 0;
+}
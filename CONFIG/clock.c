@@ -0,0 +1,181 @@
+/*
+ * clock.c - Oscilador y PLL para dsPIC33FJ32MC204 (ver clock.h)
+ *
+ * Secuencia de cambio (datasheet, sección de oscilador):
+ *  1. Si el reloj actual sale del PLL, pasar antes a FRC: no se puede
+ *     reprogramar el PLL mientras da el reloj.
+ *  2. Escribir PLLPRE, PLLFBD y PLLPOST.
+ *  3. NOSC = nueva fuente (__builtin_write_OSCCONH) y OSWEN = 1
+ *     (__builtin_write_OSCCONL); esperar COSC == NOSC.
+ *  4. Con PLL, esperar LOCK.
+ */
+
+#include "clock.h"
+#include <xc.h>
+
+#define CLOCK_COSC_LPRC      5u
+#define CLOCK_COSC_FRCDIV16  6u
+#define CLOCK_COSC_FRCDIVN   7u
+#define CLOCK_LPRC_HZ        32768UL
+
+bool CLOCK_ComputePll(uint32_t fin_hz, uint32_t fcy_max_hz, CLOCK_Pll_t *pll)
+{
+    static const uint8_t post[3] = { 2u, 4u, 8u };
+    uint32_t best_err = 0xFFFFFFFFUL;
+    bool found = false;
+    uint8_t n1;
+    uint8_t i;
+
+    if (pll == 0 || fin_hz == 0) {
+        return false;
+    }
+    if (fcy_max_hz > CLOCK_FCY_MAX_HZ) {
+        fcy_max_hz = CLOCK_FCY_MAX_HZ;
+    }
+
+    for (n1 = 2; n1 <= 33; n1++) {
+        uint32_t fref = fin_hz / n1;
+        uint32_t m_lo, m_hi;
+
+        if (fref < CLOCK_PLLIN_MIN_HZ || fref > CLOCK_PLLIN_MAX_HZ) {
+            continue;
+        }
+
+        /* M que deja el VCO dentro de rango */
+        m_lo = (uint32_t)(((uint64_t)CLOCK_VCO_MIN_HZ * n1 + fin_hz - 1u) / fin_hz);
+        m_hi = (uint32_t)(((uint64_t)CLOCK_VCO_MAX_HZ * n1) / fin_hz);
+        if (m_lo < 2u) {
+            m_lo = 2u;
+        }
+        if (m_hi > 513u) {
+            m_hi = 513u;
+        }
+
+        for (i = 0; i < 3u; i++) {
+            uint32_t div = 2UL * n1 * post[i];
+            /* Mayor M que no pasa de fcy_max_hz: FCY = fin * M / (2 N1 N2) */
+            uint32_t m = (uint32_t)(((uint64_t)fcy_max_hz * div) / fin_hz);
+            uint32_t fcy;
+
+            if (m > m_hi) {
+                m = m_hi;
+            }
+            if (m < m_lo) {
+                continue;
+            }
+
+            fcy = (uint32_t)(((uint64_t)fin_hz * m) / div);
+            if (fcy_max_hz - fcy < best_err) {
+                best_err = fcy_max_hz - fcy;
+                pll->n1 = n1;
+                pll->m = (uint16_t)m;
+                pll->n2 = post[i];
+                pll->fcy_hz = fcy;
+                found = true;
+            }
+        }
+    }
+
+    return found;
+}
+
+/* NOSC = source y espera a que COSC lo confirme */
+static bool clock_switch(uint8_t source)
+{
+    uint16_t n;
+
+    __builtin_write_OSCCONH(source);
+    __builtin_write_OSCCONL(OSCCON | 0x01);
+
+    for (n = 0; n < CLOCK_SWITCH_TIMEOUT; n++) {
+        if (OSCCONbits.OSWEN == 0 && OSCCONbits.COSC == source) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool clock_uses_pll(uint8_t cosc)
+{
+    return cosc == CLOCK_SOURCE_FRC_PLL || cosc == CLOCK_SOURCE_PRIMARY_PLL;
+}
+
+uint32_t CLOCK_Configure(CLOCK_Source_t source, uint32_t fin_hz, uint32_t fcy_hz)
+{
+    CLOCK_Pll_t pll;
+    uint16_t n;
+
+    if (source == CLOCK_SOURCE_FRC || source == CLOCK_SOURCE_FRC_PLL) {
+        fin_hz = CLOCK_FRC_HZ;
+    }
+
+    if (clock_uses_pll((uint8_t)source)) {
+        if (!CLOCK_ComputePll(fin_hz, fcy_hz, &pll)) {
+            return 0;
+        }
+
+        if (clock_uses_pll(OSCCONbits.COSC) && !clock_switch(CLOCK_SOURCE_FRC)) {
+            return 0;
+        }
+
+        CLKDIVbits.DOZEN = 0;
+        CLKDIVbits.FRCDIV = 0;
+        CLKDIVbits.PLLPRE = pll.n1 - 2u;
+        CLKDIVbits.PLLPOST = (pll.n2 == 2u) ? 0u : (pll.n2 == 4u) ? 1u : 3u;
+        PLLFBD = pll.m - 2u;
+    }
+
+    if (OSCCONbits.COSC != (uint8_t)source && !clock_switch((uint8_t)source)) {
+        return 0;
+    }
+
+    if (clock_uses_pll((uint8_t)source)) {
+        for (n = 0; n < CLOCK_SWITCH_TIMEOUT && OSCCONbits.LOCK == 0; n++) {
+        }
+        if (OSCCONbits.LOCK == 0) {
+            return 0;
+        }
+    }
+
+    return CLOCK_GetFcy(fin_hz);
+}
+
+uint32_t CLOCK_GetFcy(uint32_t fin_hz)
+{
+    uint8_t cosc = OSCCONbits.COSC;
+    uint32_t fosc;
+
+    switch (cosc) {
+    case CLOCK_SOURCE_FRC:
+        fosc = CLOCK_FRC_HZ;
+        break;
+    case CLOCK_SOURCE_PRIMARY:
+        fosc = fin_hz;
+        break;
+    case CLOCK_SOURCE_FRC_PLL:
+    case CLOCK_SOURCE_PRIMARY_PLL:
+    {
+        uint32_t fin = (cosc == CLOCK_SOURCE_FRC_PLL) ? CLOCK_FRC_HZ : fin_hz;
+        uint32_t n1 = CLKDIVbits.PLLPRE + 2u;
+        uint32_t n2 = (CLKDIVbits.PLLPOST == 0u) ? 2u : (CLKDIVbits.PLLPOST == 1u) ? 4u : 8u;
+        uint32_t m = (uint32_t)PLLFBD + 2u;
+
+        fosc = (uint32_t)(((uint64_t)fin * m) / (n1 * n2));
+        break;
+    }
+    case CLOCK_COSC_LPRC:
+        fosc = CLOCK_LPRC_HZ;
+        break;
+    case CLOCK_COSC_FRCDIV16:
+        fosc = CLOCK_FRC_HZ / 16u;
+        break;
+    case CLOCK_COSC_FRCDIVN:
+    default:
+        fosc = CLOCK_FRC_HZ >> CLKDIVbits.FRCDIV;
+        break;
+    }
+
+    /* Con DOZE el reloj de CPU se divide, pero los periféricos siguen con
+       FOSC / 2: se devuelve la FCY de periféricos (timers, BRG, ADC) */
+    return fosc / 2u;
+}
@@ -0,0 +1,76 @@
+/*
+ * clock.h - Configuración del oscilador y del PLL para dsPIC33FJ32MC204
+ *
+ * Descripción:
+ *  Calcula PLLPRE (N1), PLLFBD (M) y PLLPOST (N2) para una FCY pedida,
+ *  respetando los límites del PLL del datasheet, hace la secuencia de cambio
+ *  de oscilador y permite leer la FCY real a partir de los registros.
+ *
+ *      FOSC = Fin * M / (N1 * N2),  FCY = FOSC / 2
+ *
+ *  Límites: Fin / N1 en 0.8 .. 8 MHz, Fin * M / N1 (VCO) en 100 .. 200 MHz,
+ *  FCY <= 40 MIPS.
+ *
+ * USO:
+ *      SYSTEM_Initialize() llama a CLOCK_Configure() con la opción de
+ *      config.h; no hace falta programar PLLFBD a mano en cada main.
+ *
+ *      CLOCK_Pll_t pll;
+ *      if (CLOCK_ComputePll(7370000UL, 40000000UL, &pll)) { ... pll.fcy_hz ... }
+ *
+ * Nota:
+ *  - El cambio de oscilador requiere FCKSM = CSECMD o CSECME en los bits de
+ *    configuración (así vienen en los main del proyecto).
+ *  - La FCY calculada para el FRC supone OSCTUN = 0 (7.37 MHz nominal).
+ *
+ ******************************************************************************/
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CLOCK_FRC_HZ         7370000UL
+
+/* Límites del PLL (datasheet, características de oscilador) */
+#define CLOCK_PLLIN_MIN_HZ   800000UL
+#define CLOCK_PLLIN_MAX_HZ   8000000UL
+#define CLOCK_VCO_MIN_HZ     100000000UL
+#define CLOCK_VCO_MAX_HZ     200000000UL
+#define CLOCK_FCY_MAX_HZ     40000000UL
+
+/* Vueltas de espera al cambio de oscilador y al enganche del PLL */
+#ifndef CLOCK_SWITCH_TIMEOUT
+#define CLOCK_SWITCH_TIMEOUT 60000u
+#endif
+
+/* Fuente (mismo valor que NOSC/COSC) */
+typedef enum {
+    CLOCK_SOURCE_FRC         = 0,   /* FRC 7.37 MHz */
+    CLOCK_SOURCE_FRC_PLL     = 1,   /* FRC + PLL */
+    CLOCK_SOURCE_PRIMARY     = 2,   /* XT/HS/EC */
+    CLOCK_SOURCE_PRIMARY_PLL = 3    /* XT/HS/EC + PLL */
+} CLOCK_Source_t;
+
+typedef struct {
+    uint8_t n1;              /* PLLPRE + 2 (2..33) */
+    uint16_t m;              /* PLLFBD + 2 (2..513) */
+    uint8_t n2;              /* 2, 4 u 8 */
+    uint32_t fcy_hz;         /* FCY resultante */
+} CLOCK_Pll_t;
+
+/* Mayor FCY <= fcy_max_hz alcanzable desde fin_hz. false si ninguna
+   combinación cumple los límites. */
+bool CLOCK_ComputePll(uint32_t fin_hz, uint32_t fcy_max_hz, CLOCK_Pll_t *pll);
+
+/* Programa el PLL (si la fuente lo usa) y cambia a 'source'. fin_hz es la
+   frecuencia de la fuente (CLOCK_FRC_HZ o la del cristal). Devuelve la FCY
+   real, o 0 si el cambio o el enganche fallan (se queda en el reloj que
+   hubiera). */
+uint32_t CLOCK_Configure(CLOCK_Source_t source, uint32_t fin_hz, uint32_t fcy_hz);
+
+/* FCY calculada a partir de COSC, CLKDIV y PLLFBD (primario: fin_hz) */
+uint32_t CLOCK_GetFcy(uint32_t fin_hz);
+
+#endif /* CLOCK_H */
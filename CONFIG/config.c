@@ -6,26 +6,27 @@
  *
  * Descripción:
  *  Implementa las funciones declaradas en config.h:
- *    SYSTEM_Initialize, SYSTEM_Deinitialize, SYSTEM_EnterSleep,
- *    SYSTEM_Wakeup, SYSTEM_Reset, SYSTEM_EnableInterrupts,
+ *    SYSTEM_Initialize, SYSTEM_Deinitialize, SYSTEM_EnterIdle,
+ *    SYSTEM_EnterSleep, SYSTEM_Wakeup, SYSTEM_SetWakeSources,
+ *    SYSTEM_SetWakePins, SYSTEM_Reset, SYSTEM_GetResetCause,
+ *    SYSTEM_GetResetFlags, SYSTEM_IsWarmBoot, SYSTEM_GetFaultRecord,
+ *    SYSTEM_ClearFaultRecord, SYSTEM_GetPersistentData,
+ *    SYSTEM_ClearWatchdog, SYSTEM_EnableInterrupts,
  *    SYSTEM_DisableInterrupts, SYSTEM_GetClockFrequency,
- *    SYSTEM_GetState, SYSTEM_PrintConfiguration
+ *    SYSTEM_GetTickMs, SYSTEM_GetState, SYSTEM_PrintConfiguration
  *
  * Nota importante:
- *  - Este archivo proporciona implementaciones seguras y portables (stubs)
- *    y acciones de inicialización de puertos básicas. En las funciones
- *    SYSTEM_EnterSleep() y SYSTEM_Reset() se muestran las opciones para
- *    ejecutar la instrucción de bajo consumo / reset real del dispositivo,
- *    pero están comentadas para evitar comportamientos imprevisibles si el
- *    proyecto no espera un reset o sleep inmediato.
+ *  - SYSTEM_Reset() ejecuta la instrucción RESET (reset por software, SWR).
+ *    Las trampas (traps.s) acaban en system_trap(), que registra el fallo
+ *    en RAM persistente y hace lo mismo.
  *
- *  - Ajusta/activar las líneas comentadas si conoces bien tu configuración
- *    de hardware y quieres que estas funciones hagan la operación hardware
- *    real (por ejemplo usar __builtin_write_OSCCONL para reset).
+ *  - SYSTEM_EnterIdle() / SYSTEM_EnterSleep() sí ejecutan PWRSAV #1 / #0,
+ *    con las fuentes de despertar de SYSTEM_SetWakeSources().
  *
  */
 
 #include "config.h"
+#include "clock.h"
 #include <xc.h>
 #include <stdint.h>
 #include <stdio.h>  /* usado opcionalmente por SYSTEM_PrintConfiguration */
@@ -33,6 +34,52 @@
 /* Estado interno del sistema */
 static volatile System_State_t system_state = SYS_STATE_INIT;
 
+/* FCY programada por SYSTEM_Initialize (0 hasta entonces) */
+static uint32_t system_fcy = 0;
+
+/* Milisegundos desde SYSTEM_Initialize (lo incrementa _T1Interrupt) */
+static volatile uint32_t system_tick_ms = 0;
+
+/* Fuentes que pueden despertar de Idle/Sleep (SYSTEM_WAKE_*) */
+static uint16_t system_wake_sources = SYSTEM_WAKE_ANY;
+
+/* Peor latencia del tick en ciclos (SYSTEM_GetTickLatencyMax) */
+static volatile uint16_t system_tick_latency_max = 0;
+
+/* Informe adicional de SYSTEM_PrintConfiguration (p. ej. METRICS_Print) */
+static void (*system_print_hook)(void) = 0;
+
+/* Banderas de causa de reset en RCON */
+#define SYSTEM_RCON_TRAPR   0x8000u
+#define SYSTEM_RCON_IOPUWR  0x4000u
+#define SYSTEM_RCON_CM      0x0200u
+#define SYSTEM_RCON_EXTR    0x0080u
+#define SYSTEM_RCON_SWR     0x0040u
+#define SYSTEM_RCON_WDTO    0x0010u
+#define SYSTEM_RCON_SLEEP   0x0008u
+#define SYSTEM_RCON_IDLE    0x0004u
+#define SYSTEM_RCON_BOR     0x0002u
+#define SYSTEM_RCON_POR     0x0001u
+#define SYSTEM_RCON_FLAGS   0xC2DFu     /* todas las anteriores */
+
+/* RAM persistente: el arranque de XC16 no la pone a cero, así que
+   sobrevive a los resets que no cortan la alimentación */
+#define SYSTEM_PERSIST_MAGIC  0xB007u
+
+typedef struct {
+    uint16_t magic;
+    uint16_t magic_n;          /* ~magic */
+    uint16_t fault_pending;    /* el último SWR lo pidió system_trap() */
+    SYSTEM_FaultRecord_t fault;
+    uint8_t user[SYSTEM_PERSIST_USER_BYTES];
+} system_persist_t;
+
+static system_persist_t system_persist __attribute__((persistent));
+
+/* RCON y causa del último reset (los fija boot_init) */
+static uint16_t system_rcon = 0;
+static SYSTEM_ResetCause_t system_reset_cause = SYSTEM_RESET_UNKNOWN;
+
 /* ------------------------------------------------------------------------- */
 /* Helper: inicializa puertos según macros de config.h                         */
 /* ------------------------------------------------------------------------- */
@@ -69,6 +116,202 @@ static void ports_init(void)
     #endif
 }
 
+/* ------------------------------------------------------------------------- */
+/* Helper: causa del reset (RCON) y validez de la RAM persistente              */
+/* ------------------------------------------------------------------------- */
+static bool persist_valid(void)
+{
+    return system_persist.magic == SYSTEM_PERSIST_MAGIC &&
+           system_persist.magic_n == (uint16_t)~SYSTEM_PERSIST_MAGIC;
+}
+
+static void persist_init(void)
+{
+    uint8_t *p = (uint8_t *)&system_persist;
+    uint16_t i;
+
+    for (i = 0; i < sizeof(system_persist); i++) {
+        p[i] = 0;
+    }
+    system_persist.magic = SYSTEM_PERSIST_MAGIC;
+    system_persist.magic_n = (uint16_t)~SYSTEM_PERSIST_MAGIC;
+}
+
+static void boot_init(void)
+{
+    uint16_t rcon = RCON;
+    SYSTEM_ResetCause_t cause;
+
+    /* Borrar las banderas: el siguiente arranque ve sólo su propia causa */
+    RCON = rcon & (uint16_t)~SYSTEM_RCON_FLAGS;
+    system_rcon = rcon;
+
+    if (rcon & SYSTEM_RCON_POR) {
+        cause = SYSTEM_RESET_POWER_ON;
+    } else if (rcon & SYSTEM_RCON_BOR) {
+        cause = SYSTEM_RESET_BROWN_OUT;
+    } else if (rcon & SYSTEM_RCON_TRAPR) {
+        cause = SYSTEM_RESET_TRAP_CONFLICT;
+    } else if (rcon & SYSTEM_RCON_IOPUWR) {
+        cause = SYSTEM_RESET_ILLEGAL_OPCODE;
+    } else if (rcon & SYSTEM_RCON_CM) {
+        cause = SYSTEM_RESET_CONFIG_MISMATCH;
+    } else if (rcon & SYSTEM_RCON_WDTO) {
+        cause = SYSTEM_RESET_WATCHDOG;
+    } else if (rcon & SYSTEM_RCON_SWR) {
+        cause = (persist_valid() && system_persist.fault_pending)
+              ? SYSTEM_RESET_FAULT : SYSTEM_RESET_SOFTWARE;
+    } else if (rcon & SYSTEM_RCON_EXTR) {
+        cause = SYSTEM_RESET_MCLR;
+    } else {
+        cause = SYSTEM_RESET_UNKNOWN;
+    }
+
+    /* En frío (o con la RAM persistente corrupta) se empieza de cero */
+    if (cause == SYSTEM_RESET_POWER_ON || cause == SYSTEM_RESET_BROWN_OUT ||
+        !persist_valid()) {
+        persist_init();
+    }
+    system_persist.fault_pending = 0;
+    system_reset_cause = cause;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Manejador común de trampas (lo llama traps.s con la pila ya rehecha)        */
+/* ------------------------------------------------------------------------- */
+void __attribute__((noreturn)) system_trap(uint32_t pc, uint16_t trap);
+
+void __attribute__((noreturn)) system_trap(uint32_t pc, uint16_t trap)
+{
+    SYSTEM_FaultRecord_t *f = &system_persist.fault;
+
+    if (!persist_valid()) {
+        persist_init();
+    }
+
+    /* A IPL de trampa (8..15) la ISR del tick no puede cambiar el contador */
+    f->pc = pc;
+    f->uptime_ms = system_tick_ms;
+    f->trap = trap;
+    f->intcon1 = INTCON1;
+    f->rcon = system_rcon;
+    f->count++;
+
+    /* Borrar las banderas de trampa (NSTDIS se conserva) */
+    INTCON1 &= 0x8000u;
+
+    #if SYSTEM_FAULT_RESET
+    system_persist.fault_pending = 1;
+    __asm__ volatile ("reset");
+    #endif
+
+    while (1) { __builtin_nop(); }   /* breakpoint: leer system_persist */
+}
+
+/* ------------------------------------------------------------------------- */
+/* Helper: oscilador según la opción CONFIG_OSC_* de config.h                  */
+/* ------------------------------------------------------------------------- */
+static uint32_t clock_init(void)
+{
+    #if defined(CONFIG_OSC_INTERNO_PLL)
+    return CLOCK_Configure(CLOCK_SOURCE_FRC_PLL, FOSC_PRIM, CONFIG_FCY_TARGET);
+    #elif defined(CONFIG_OSC_EXTERNO_PLL)
+    return CLOCK_Configure(CLOCK_SOURCE_PRIMARY_PLL, FOSC_PRIM, CONFIG_FCY_TARGET);
+    #elif defined(CONFIG_OSC_EXTERNO_SIMPLE)
+    return CLOCK_Configure(CLOCK_SOURCE_PRIMARY, FOSC_PRIM, 0);
+    #else
+    return CLOCK_Configure(CLOCK_SOURCE_FRC, FOSC_PRIM, 0);
+    #endif
+}
+
+/* ------------------------------------------------------------------------- */
+/* Helper: apaga (PMD) todos los módulos salvo Timer1; cada driver activa el   */
+/* suyo en su Init                                                            */
+/* ------------------------------------------------------------------------- */
+static void pmd_init(void)
+{
+    #ifdef CONFIG_PMD_AUTO
+    PMD1 = 0xFFFF;
+    PMD1bits.T1MD = 0;              /* tick del sistema */
+    PMD2 = 0xFFFF;
+    PMD3 = 0xFFFF;
+    #endif
+}
+
+/* ------------------------------------------------------------------------- */
+/* Helper: PWRSAV con sólo las fuentes elegidas habilitadas                    */
+/* ------------------------------------------------------------------------- */
+static void power_save(bool deep)
+{
+    uint16_t iec0, iec1, iec2, iec3, iec4;
+    uint16_t ipl = SRbits.IPL;
+    bool t1ie, t3ie, adie, si2c1ie, cnie;
+#ifdef CONFIG_I2C2_ENABLED
+    bool si2c2ie;
+#endif
+
+    /* A IPL 7 la interrupción que despierta no se atiende hasta restaurar
+       las máscaras: no se pierde ni se ejecuta con las de otras fuentes
+       desactivadas */
+    SRbits.IPL = 7;
+
+    if (system_wake_sources != SYSTEM_WAKE_ANY) {
+        iec0 = IEC0; iec1 = IEC1; iec2 = IEC2; iec3 = IEC3; iec4 = IEC4;
+        t1ie = IEC0bits.T1IE;
+        t3ie = IEC0bits.T3IE;
+        adie = IEC0bits.AD1IE;
+        si2c1ie = IEC1bits.SI2C1IE;
+#ifdef CONFIG_I2C2_ENABLED
+        si2c2ie = IEC3bits.SI2C2IE;
+#endif
+        cnie = IEC1bits.CNIE;
+
+        IEC0 = 0; IEC1 = 0; IEC2 = 0; IEC3 = 0; IEC4 = 0;
+        if (system_wake_sources & SYSTEM_WAKE_TICK)      IEC0bits.T1IE = t1ie;
+        if (system_wake_sources & SYSTEM_WAKE_TIMER3)    IEC0bits.T3IE = t3ie;
+        if (system_wake_sources & SYSTEM_WAKE_ADC)       IEC0bits.AD1IE = adie;
+        if (system_wake_sources & SYSTEM_WAKE_I2C_SLAVE) {
+            IEC1bits.SI2C1IE = si2c1ie;
+#ifdef CONFIG_I2C2_ENABLED
+            IEC3bits.SI2C2IE = si2c2ie;
+#endif
+        }
+        if (system_wake_sources & SYSTEM_WAKE_CN)        IEC1bits.CNIE = cnie;
+
+        if (deep) {
+            __asm__ volatile ("pwrsav #0");
+        } else {
+            __asm__ volatile ("pwrsav #1");
+        }
+
+        IEC0 = iec0; IEC1 = iec1; IEC2 = iec2; IEC3 = iec3; IEC4 = iec4;
+    } else if (deep) {
+        __asm__ volatile ("pwrsav #0");
+    } else {
+        __asm__ volatile ("pwrsav #1");
+    }
+
+    SRbits.IPL = ipl;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Helper: Timer1 como tick de 1 ms (Tcy, sin prescaler)                       */
+/* ------------------------------------------------------------------------- */
+static void tick_init(void)
+{
+    T1CON = 0x0000;                 /* parado, reloj interno Tcy, 1:1 */
+    TMR1 = 0;
+    /* Con la FCY real: el tick sigue siendo de 1 ms aunque el cambio de
+       oscilador haya fallado */
+    PR1 = (uint16_t)((SYSTEM_GetClockFrequency() / SYSTEM_TICK_HZ) - 1UL);
+    system_tick_ms = 0;
+
+    IPC0bits.T1IP = SYSTEM_TICK_IRQ_PRIORITY;
+    IFS0bits.T1IF = 0;
+    IEC0bits.T1IE = 1;
+    T1CONbits.TON = 1;
+}
+
 /* ------------------------------------------------------------------------- */
 /* Implementaciones públicas                                                  */
 /* ------------------------------------------------------------------------- */
@@ -78,14 +321,34 @@ void SYSTEM_Initialize(void)
     /* Bloquear interrupciones mientras configuramos */
     SYSTEM_DisableInterrupts();
 
+    /* Causa del reset antes de tocar nada (RCON se borra aquí) */
+    boot_init();
+
+    /* Watchdog por software (FWDTEN = OFF en los pragmas). Tras un reset por
+       WDT sigue encendido solo: SWDTEN no se borra. */
+    #if defined(CONFIG_WDT_ON_NORMAL) || defined(CONFIG_WDT_ON_LONG)
+    SYSTEM_ClearWatchdog();
+    RCONbits.SWDTEN = 1;
+    #endif
+
+    /* Oscilador y PLL: a partir de aquí el reloj es el de config.h */
+    system_fcy = clock_init();
+
+    /* Módulos apagados hasta que su driver los inicialice */
+    pmd_init();
+
     /* Inicializaciones de puertos y periféricos dependientes de config.h */
     ports_init();
 
+    /* Base de tiempos (timeouts I2C, etc.) */
+    tick_init();
+
     /* Inicialización adicional (timers, ADC, UART...) puede hacerse desde
        otros módulos que llamen a sus init específicos. */
 
-    /* Estado listo */
-    system_state = SYS_STATE_READY;
+    /* Estado listo (o error si el oscilador no es el esperado: __delay_ms y
+       los periodos calculados con FCY ya no serían exactos) */
+    system_state = (system_fcy == (uint32_t)FCY) ? SYS_STATE_READY : SYS_STATE_ERROR;
 
     /* Restaurar interrupciones si las teníamos activas */
     SYSTEM_EnableInterrupts();
@@ -99,74 +362,144 @@ void SYSTEM_Deinitialize(void)
     TRISB |= 0x00FF;
     #endif
 
-    /* Opcional: apagar módulos (ADC, PWM, Timers) según sea necesario aquí. */
+    /* Parar el tick del sistema */
+    IEC0bits.T1IE = 0;
+    T1CONbits.TON = 0;
+
+    /* Apagar los módulos (PMD): quedan en su estado de reset */
+    #ifdef CONFIG_PMD_AUTO
+    PMD1 = 0xFFFF;
+    PMD2 = 0xFFFF;
+    PMD3 = 0xFFFF;
+    #endif
     system_state = SYS_STATE_INIT;
 }
 
-void SYSTEM_EnterSleep(void)
+void SYSTEM_EnterIdle(void)
 {
-    /* Marcar estado */
-    system_state = SYS_STATE_SLEEP;
-
-    /* Antes de entrar a sleep normalmente se limpian banderas y se configuran
-       wake-up sources (INT, CN, TMR, etc.). Eso debe realizarse por el
-       llamador si hace falta. */
+    System_State_t prev = system_state;
 
-    /* Para ejecutar la instrucción SLEEP en XC16 se puede usar:
-         Sleep();    // si está disponible en tu versión de xc.h
-       o usar una built-in asm. Aquí dejamos la instrucción comentada para que
-       la actives voluntariamente cuando estés seguro.
-    */
+    /* CPU parada, periféricos en marcha: vuelve tras la primera interrupción
+       de una fuente de despertar (con el tick, como mucho 1 ms) */
+    system_state = SYS_STATE_SLEEP;
+    power_save(false);
+    system_state = prev;
+}
 
-    /* Ejemplo (descomentar para usar el SLEEP hardware):
-    #ifdef __XC16__
-        Sleep();
-    #else
-        __asm__ volatile ("pwrsav #0");
-    #endif
-    */
+void SYSTEM_EnterSleep(void)
+{
+    System_State_t prev = system_state;
 
-    /* Como alternativa segura para pruebas: esperar a una interrupción (no real sleep) */
-    while (system_state == SYS_STATE_SLEEP)
-    {
-        /* WFI-like behavior simulated */
-        __builtin_nop();
-        /* Romperemos este bucle con SYSTEM_Wakeup() que cambia system_state */
-    }
+    /* Oscilador parado: sólo despiertan CN y la dirección de esclavo I2C.
+       Al volver, el oscilador (y el PLL) arrancan de nuevo solos. Con el WDT
+       activo, su desbordamiento también despierta. */
+    system_state = SYS_STATE_SLEEP;
+    power_save(true);
+    system_state = prev;
 }
 
 void SYSTEM_Wakeup(void)
 {
-    /* Cambia estado a READY si antes estaba en SLEEP */
+    /* La salida de Idle/Sleep la hace la propia interrupción; esto sólo
+       corrige el estado si se llama desde una ISR durante el reposo */
     if (system_state == SYS_STATE_SLEEP) {
         system_state = SYS_STATE_READY;
     }
-    /* Si hubiese que reconfigurar clocks o periféricos tras wakeup, hacerlo aquí */
+}
+
+void SYSTEM_SetWakeSources(uint16_t sources)
+{
+    system_wake_sources = sources;
+}
+
+void SYSTEM_SetWakePins(uint32_t cn_mask)
+{
+    IEC1bits.CNIE = 0;
+    CNEN1 = (uint16_t)cn_mask;
+    CNEN2 = (uint16_t)(cn_mask >> 16);
+
+    if (cn_mask != 0) {
+        /* Leer los puertos fija el nivel de referencia del cambio */
+        (void)PORTA;
+        (void)PORTB;
+        (void)PORTC;
+        IPC4bits.CNIP = SYSTEM_CN_IRQ_PRIORITY;
+        IFS1bits.CNIF = 0;
+        IEC1bits.CNIE = 1;
+    }
 }
 
 void SYSTEM_Reset(void)
 {
-    /* Marca estado */
     system_state = SYS_STATE_INIT;
+    SYSTEM_DisableInterrupts();
+
+    /* Reset por software: RCON.SWR = 1 y arranque desde el vector de reset,
+       con la RAM persistente intacta */
+    __asm__ volatile ("reset");
+
+    while (1) { __builtin_nop(); }   /* no se llega */
+}
+
+SYSTEM_ResetCause_t SYSTEM_GetResetCause(void)
+{
+    return system_reset_cause;
+}
+
+uint16_t SYSTEM_GetResetFlags(void)
+{
+    return system_rcon;
+}
+
+bool SYSTEM_IsWarmBoot(void)
+{
+    return system_reset_cause == SYSTEM_RESET_WATCHDOG;
+}
+
+bool SYSTEM_GetFaultRecord(SYSTEM_FaultRecord_t *record)
+{
+    if (record == NULL || !persist_valid() || system_persist.fault.count == 0) {
+        return false;
+    }
+    *record = system_persist.fault;
+    return true;
+}
 
-    /* ADVERTENCIA:
-       Para realizar un reset por software en PIC24/dsPIC hay mecanismos que
-       requieren instrucciones especiales y desbloqueos (es dependiente del
-       compilador y del dispositivo). A continuación se da un ejemplo
-       comentado para XC16; úsalo solo si sabes lo que haces.
-    */
+void SYSTEM_ClearFaultRecord(void)
+{
+    SYSTEM_FaultRecord_t *f = &system_persist.fault;
+
+    f->pc = 0;
+    f->uptime_ms = 0;
+    f->trap = SYSTEM_TRAP_NONE;
+    f->intcon1 = 0;
+    f->rcon = 0;
+    f->count = 0;
+}
+
+uint8_t *SYSTEM_GetPersistentData(void)
+{
+    return system_persist.user;
+}
 
-    /* Ejemplo de reset por software (comentado):
-    // #include <libpic30.h>
-    // __builtin_write_OSCCONL(OSCCON | 0x01); // set SWRST (si aplica)
-    // for(;;); // esperar reset
-    */
+void SYSTEM_ClearWatchdog(void)
+{
+    __asm__ volatile ("clrwdt");
+}
 
-    /* Implementación segura por defecto: entrar en bucle infinito para que el
-       programador/depurador pueda detectar el "reset" software en ejecución.
-       Si deseas forzar un reset real, sustituye por la secuencia adecuada.
-    */
-    while (1) { __builtin_nop(); }
+uint16_t SYSTEM_GetTickLatencyMax(void)
+{
+    return system_tick_latency_max;
+}
+
+void SYSTEM_ResetTickLatency(void)
+{
+    system_tick_latency_max = 0;
+}
+
+void SYSTEM_SetPrintHook(void (*hook)(void))
+{
+    system_print_hook = hook;
 }
 
 void SYSTEM_EnableInterrupts(void)
@@ -193,8 +526,24 @@ void SYSTEM_DisableInterrupts(void)
 
 uint32_t SYSTEM_GetClockFrequency(void)
 {
-    /* Devuelve FCY definido en config.h (frecuencia de instrucción) */
-    return (uint32_t)FCY;
+    /* FCY real, leída de los registros de oscilador al inicializar */
+    if (system_fcy == 0) {
+        system_fcy = CLOCK_GetFcy(FOSC_PRIM);
+    }
+    return system_fcy;
+}
+
+uint32_t SYSTEM_GetTickMs(void)
+{
+    uint32_t a, b;
+
+    /* La lectura de 32 bits son dos accesos: repetir si la ISR cayó en medio */
+    do {
+        a = system_tick_ms;
+        b = system_tick_ms;
+    } while (a != b);
+
+    return a;
 }
 
 System_State_t SYSTEM_GetState(void)
@@ -246,10 +595,58 @@ void SYSTEM_PrintConfiguration(void)
     printf("  Code Protect: ON\r\n");
     #endif
 
-    printf("  FCY: %lu Hz\r\n", (unsigned long)SYSTEM_GetClockFrequency());
+    printf("  FCY: %lu Hz (config.h: %lu Hz)\r\n",
+           (unsigned long)SYSTEM_GetClockFrequency(), (unsigned long)FCY);
+
+    {
+        static const char *const causas[] = {
+            "POR", "BOR", "MCLR", "SOFTWARE", "WDT (warm)", "FAULT",
+            "TRAP CONFLICT", "ILLEGAL OPCODE", "CONFIG MISMATCH", "UNKNOWN"
+        };
+        SYSTEM_FaultRecord_t f;
+
+        printf("  Reset: %s (RCON 0x%04X)\r\n", causas[system_reset_cause], system_rcon);
+        if (SYSTEM_GetFaultRecord(&f)) {
+            printf("  Last fault: trap %u at PC 0x%06lX, INTCON1 0x%04X, %lu ms, count %u\r\n",
+                   f.trap, (unsigned long)f.pc, f.intcon1,
+                   (unsigned long)f.uptime_ms, f.count);
+        }
+    }
+
+    if (system_print_hook != 0) {
+        system_print_hook();
+    }
     #else
     /* Si no hay soporte printf, una alternativa es parpadear LEDs o cambiar
        un puerto para indicar estado; aquí no hacemos nada por defecto. */
     (void)SYSTEM_GetClockFrequency;
     #endif
 }
+
+/* ------------------------------------------------------------------------- */
+/* ISR del tick del sistema                                                   */
+/* ------------------------------------------------------------------------- */
+void __attribute__((interrupt, no_auto_psv)) _T1Interrupt(void)
+{
+    /* TMR1 volvió a 0 al coincidir con PR1: su valor ahora son los ciclos
+       desde la petición de interrupción hasta aquí */
+    uint16_t latency = TMR1;
+
+    IFS0bits.T1IF = 0;
+    system_tick_ms++;
+    if (latency > system_tick_latency_max) {
+        system_tick_latency_max = latency;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* ISR de cambio en pines (despertar por CN, SYSTEM_SetWakePins)              */
+/* ------------------------------------------------------------------------- */
+void __attribute__((interrupt, no_auto_psv)) _CNInterrupt(void)
+{
+    /* Leer los puertos anula la diferencia antes de borrar la bandera */
+    (void)PORTA;
+    (void)PORTB;
+    (void)PORTC;
+    IFS1bits.CNIF = 0;
+}
@@ -80,24 +80,62 @@
  // #define CONFIG_PORT_F_ENABLED
  // #define CONFIG_PORT_G_ENABLED
 
+/* 9. CONTADOR DE CICLOS (perf.h)
+ *  - Por defecto Timer2 en 16 bits con su interrupción contando desbordes:
+ *    contador de 32 bits compatible con ADC_StartTimed y el DAC (Timer3).
+ *  - CONFIG_PERF_TIMER32 usa el par Timer2/3 en 32 bits: sin interrupción,
+ *    pero Timer3 deja de estar disponible (configuración "bench").
+ */
+// #define CONFIG_PERF_TIMER32
+
+/* 10. APAGADO DE PERIFÉRICOS (PMD)
+ *  - CONFIG_PMD_AUTO: SYSTEM_Initialize desactiva con PMD1..PMD3 todos los
+ *    módulos salvo Timer1 (tick); cada driver (ADC_Init, I2C_Init, DAC_Init,
+ *    PERF_Init...) vuelve a activar el suyo antes de tocar sus registros.
+ *    Los módulos que nadie inicializa no consumen reloj.
+ */
+#define CONFIG_PMD_AUTO
+
+/* 11. MÓDULOS I2C (i2c.h)
+ *  - El dsPIC33FJ32MC204 sólo tiene I2C1. Con un único módulo habilitado la
+ *    librería resuelve el módulo al compilar: cada acceso queda en un acceso
+ *    directo al SFR, sin switch ni puntero a registros.
+ *  - CONFIG_I2C2_ENABLED sólo en dsPIC33F con I2C2 (vuelve el despacho en
+ *    tiempo de ejecución entre los dos módulos).
+ */
+#define CONFIG_I2C1_ENABLED
+// #define CONFIG_I2C2_ENABLED
+
 /* --------------------------------------------------------------------------
  * CONSTANTES DEL SISTEMA (valores coherentes y calculados)
  * ------------------------------------------------------------------------ */
 
-/* Frecuencias por configuración (ajusta los valores primarios según tu hardware) */
+/* Frecuencias por configuración (ajusta los valores primarios según tu hardware)
+ *
+ * SYSTEM_Initialize() programa el PLL en tiempo de ejecución con clock.c:
+ * busca PLLPRE (N1), PLLFBD (M) y PLLPOST (N2) para la mayor FCY que no
+ * supere CONFIG_FCY_TARGET y hace el cambio de oscilador. FCY es la
+ * frecuencia que resulta de esa búsqueda (la usan __delay_ms y los cálculos
+ * de periodos en tiempo de compilación); SYSTEM_GetClockFrequency() la
+ * devuelve leída de los registros.
+ */
+#ifndef CONFIG_FCY_TARGET
+#define CONFIG_FCY_TARGET   40000000UL  /* 40 MIPS: máximo del dsPIC33FJ32MC204 */
+#endif
+
 #if defined(CONFIG_OSC_INTERNO_PLL)
 
-    /* Ejemplo: oscilador interno 8 MHz -> PLL -> FOSC = 80 MHz -> FCY = 40 MHz */
+    /* FRC 7.37 MHz / 3 * 65 / 2 -> FOSC = 79.84 MHz -> FCY = 39.92 MIPS */
     #ifndef FOSC_PRIM
-    #define FOSC_PRIM   8000000UL   /* frecuencia de la fuente interna (antes del PLL) */
+    #define FOSC_PRIM   7370000UL   /* FRC nominal (OSCTUN = 0) */
     #endif
 
     #ifndef FOSC
-    #define FOSC        80000000UL  /* frecuencia del sistema después del PLL */
+    #define FOSC        79841666UL  /* frecuencia del sistema después del PLL */
     #endif
 
     #ifndef FCY
-    #define FCY         (FOSC / 2UL) /* instrucción por ciclo: FOSC/2 */
+    #define FCY         39920833UL  /* FOSC / 2 (sin redondear FOSC) */
     #endif
 
 #elif defined(CONFIG_OSC_INTERNO_SIMPLE)
@@ -117,7 +155,7 @@
 
 #elif defined(CONFIG_OSC_EXTERNO_PLL)
 
-    /* Ajusta según tu cristal/external oscillator */
+    /* Cristal XT 8 MHz / 2 * 40 / 2 -> FOSC = 80 MHz -> FCY = 40 MIPS */
     #ifndef FOSC_PRIM
     #define FOSC_PRIM   8000000UL
     #endif
@@ -160,6 +198,10 @@
 
 #endif /* CONFIG_OSC_* */
 
+#if FCY > 40000000UL
+#error "FCY por encima de 40 MIPS: fuera de especificación"
+#endif
+
 /* Asegurarse de que FCY esté definido como entero literal para libpic30 */
 #ifndef FCY
 #error "FCY no definido. Revisa la sección de configuración de oscilador en config.h"
@@ -174,6 +216,123 @@
 #define DELAY_MS(ms)    __delay_ms(ms)
 #define DELAY_US(us)    __delay_us(us)
 
+/* --------------------------------------------------------------------------
+ * TICK DEL SISTEMA (Timer1)
+ *
+ * SYSTEM_Initialize arranca Timer1 a 1 kHz; SYSTEM_GetTickMs devuelve los
+ * milisegundos transcurridos (desborda a los ~49 días: comparar siempre
+ * con resta, (ahora - inicio) > espera). La ISR _T1Interrupt está en
+ * config.c, así que Timer1 queda reservado para el sistema.
+ *
+ * Prioridad máxima por defecto para que los timeouts sigan avanzando aunque
+ * se espere desde otra ISR; la ISR solo incrementa un contador.
+ * ------------------------------------------------------------------------ */
+#define SYSTEM_TICK_HZ  1000UL
+
+#ifndef SYSTEM_TICK_IRQ_PRIORITY
+#define SYSTEM_TICK_IRQ_PRIORITY  7
+#endif
+
+/* La ISR guarda el peor valor de TMR1 al entrar (SYSTEM_GetTickLatencyMax):
+ * ciclos desde la petición hasta la primera instrucción útil. Incluye la
+ * entrada fija (~5 Tcy + prólogo) y, sobre todo, el tiempo con IPL 7 o DISI
+ * en otras partes del programa. */
+
+#if ((FCY / SYSTEM_TICK_HZ) - 1UL) > 0xFFFFUL
+#error "FCY demasiado alto para el tick de 1 ms con Timer1 sin prescaler"
+#endif
+
+/* --------------------------------------------------------------------------
+ * BAJO CONSUMO (Idle / Sleep)
+ *
+ * SYSTEM_EnterIdle ejecuta PWRSAV #1: la CPU se para y los periféricos
+ * siguen (Timer1, Timer3, ADC, I2C...). SYSTEM_EnterSleep ejecuta PWRSAV #0:
+ * se para también el oscilador, así que el tick no avanza y sólo despiertan
+ * las fuentes asíncronas (CN, dirección de esclavo I2C).
+ *
+ * Mientras se duerme sólo quedan habilitadas las interrupciones de las
+ * fuentes elegidas con SYSTEM_SetWakeSources (las demás se enmascaran y se
+ * restauran al despertar; sus banderas pendientes se atienden después). La
+ * entrada es a IPL 7: si una fuente ya tiene su bandera activa no se duerme,
+ * y la ISR de la fuente que despierta se ejecuta al salir, no durante.
+ *
+ * En Idle vale cualquier fuente; en Sleep, SYSTEM_WAKE_TICK, _TIMER3 y _ADC
+ * no despiertan (sus relojes salen de FCY).
+ * ------------------------------------------------------------------------ */
+#define SYSTEM_WAKE_TICK       0x0001u  /* Timer1, 1 ms */
+#define SYSTEM_WAKE_TIMER3     0x0002u  /* ritmo del DAC / disparo del ADC */
+#define SYSTEM_WAKE_ADC        0x0004u  /* bloque del ADC (SMPI) */
+#define SYSTEM_WAKE_I2C_SLAVE  0x0008u  /* SI2C1 / SI2C2 (coincidencia de dirección) */
+#define SYSTEM_WAKE_CN         0x0010u  /* cambio en pines CN (SYSTEM_SetWakePins) */
+#define SYSTEM_WAKE_ANY        0xFFFFu  /* sin enmascarar: cualquier interrupción */
+
+#ifndef SYSTEM_CN_IRQ_PRIORITY
+#define SYSTEM_CN_IRQ_PRIORITY  2
+#endif
+
+/* --------------------------------------------------------------------------
+ * ARRANQUE, WATCHDOG Y FALLOS
+ *
+ * SYSTEM_Initialize lee RCON una vez (SYSTEM_GetResetCause) y lo borra.
+ * Tras un reset por watchdog el arranque es "en caliente"
+ * (SYSTEM_IsWarmBoot): el bloque persistente de RAM sigue válido y la
+ * aplicación puede saltarse lo que ya hizo en frío (escaneo del bus,
+ * mensajes de la demo...) guardando lo necesario en
+ * SYSTEM_GetPersistentData(). El reloj, los puertos y el tick se
+ * configuran igual: sus registros vuelven al valor de reset.
+ *
+ * Las trampas de dirección, pila, matemática y oscilador (traps.s) guardan
+ * en la misma RAM persistente un registro de fallo (PC apilado, INTCON1,
+ * RCON, milisegundos desde el arranque) y hacen un reset por software
+ * (SYSTEM_FAULT_RESET = 1) o se quedan en bucle para el depurador (0).
+ *
+ * CONFIG_WDT_ON_NORMAL / _LONG encienden el watchdog por software
+ * (RCONbits.SWDTEN, requiere FWDTEN = OFF en los pragmas). El periodo lo
+ * fijan los bits de configuración, p. ej. con LPRC de 32 kHz:
+ *   NORMAL: WDTPRE = PR32,  WDTPOST = PS128   -> ~128 ms
+ *   LONG:   WDTPRE = PR128, WDTPOST = PS32768 -> ~131 s
+ * SCHED_Run borra el watchdog en cada pasada: una tarea colgada lo hace
+ * saltar.
+ * ------------------------------------------------------------------------ */
+typedef enum {
+    SYSTEM_RESET_POWER_ON = 0,   /* POR: RAM persistente inicializada */
+    SYSTEM_RESET_BROWN_OUT,
+    SYSTEM_RESET_MCLR,
+    SYSTEM_RESET_SOFTWARE,       /* SYSTEM_Reset() */
+    SYSTEM_RESET_WATCHDOG,       /* arranque en caliente */
+    SYSTEM_RESET_FAULT,          /* trampa registrada y SYSTEM_Reset() */
+    SYSTEM_RESET_TRAP_CONFLICT,  /* TRAPR: trampa dentro de trampa */
+    SYSTEM_RESET_ILLEGAL_OPCODE, /* IOPUWR: opcode ilegal o W no inicializado */
+    SYSTEM_RESET_CONFIG_MISMATCH,
+    SYSTEM_RESET_UNKNOWN
+} SYSTEM_ResetCause_t;
+
+typedef enum {
+    SYSTEM_TRAP_NONE = 0,
+    SYSTEM_TRAP_OSCILLATOR,
+    SYSTEM_TRAP_ADDRESS,
+    SYSTEM_TRAP_STACK,
+    SYSTEM_TRAP_MATH
+} SYSTEM_Trap_t;
+
+typedef struct {
+    uint32_t pc;             /* dirección apilada (la siguiente a la que falló) */
+    uint32_t uptime_ms;      /* SYSTEM_GetTickMs() al fallar */
+    uint16_t trap;           /* SYSTEM_Trap_t */
+    uint16_t intcon1;        /* banderas de trampa (OSCFAIL, ADDRERR, MATHERR...) */
+    uint16_t rcon;           /* RCON del arranque en el que falló */
+    uint16_t count;          /* fallos desde el último arranque en frío */
+} SYSTEM_FaultRecord_t;
+
+#ifndef SYSTEM_FAULT_RESET
+#define SYSTEM_FAULT_RESET  1       /* 0: bucle infinito tras registrar */
+#endif
+
+/* Bytes de RAM persistente para la aplicación (valen tras WDT/SW reset) */
+#ifndef SYSTEM_PERSIST_USER_BYTES
+#define SYSTEM_PERSIST_USER_BYTES  16u
+#endif
+
 /* --------------------------------------------------------------------------
  * TIP: Directivas de configuración (pragma config)
  *
@@ -205,17 +364,31 @@ typedef enum {
  * ------------------------------------------------------------------------ */
 void SYSTEM_Initialize(void);
 void SYSTEM_Deinitialize(void);
+void SYSTEM_EnterIdle(void);
 void SYSTEM_EnterSleep(void);
 void SYSTEM_Wakeup(void);
-void SYSTEM_Reset(void);
+void SYSTEM_SetWakeSources(uint16_t sources);  /* SYSTEM_WAKE_* (defecto _ANY) */
+void SYSTEM_SetWakePins(uint32_t cn_mask);     /* bit n = CNn; 0 desactiva */
+void SYSTEM_Reset(void);                       /* instrucción RESET, no vuelve */
+SYSTEM_ResetCause_t SYSTEM_GetResetCause(void);
+uint16_t SYSTEM_GetResetFlags(void);           /* RCON leído al arrancar */
+bool SYSTEM_IsWarmBoot(void);
+bool SYSTEM_GetFaultRecord(SYSTEM_FaultRecord_t *record);  /* false si no hay */
+void SYSTEM_ClearFaultRecord(void);
+uint8_t *SYSTEM_GetPersistentData(void);       /* SYSTEM_PERSIST_USER_BYTES */
+void SYSTEM_ClearWatchdog(void);
+uint16_t SYSTEM_GetTickLatencyMax(void);       /* ciclos, peor caso */
+void SYSTEM_ResetTickLatency(void);
+void SYSTEM_SetPrintHook(void (*hook)(void));  /* al final de SYSTEM_PrintConfiguration */
 void SYSTEM_EnableInterrupts(void);
 void SYSTEM_DisableInterrupts(void);
 uint32_t SYSTEM_GetClockFrequency(void);
+uint32_t SYSTEM_GetTickMs(void);
 System_State_t SYSTEM_GetState(void);
 void SYSTEM_PrintConfiguration(void);
 
-/* Implementación inline útil para obtener FCY sin llamar a función separada.
- * Si prefieres, implementa SYSTEM_GetClockFrequency en system.c consultando registros.
+/* FCY de compilación, sin llamar a función. SYSTEM_GetClockFrequency()
+ * devuelve la frecuencia programada de verdad (registros de oscilador).
  */
 static inline uint32_t SYSTEM_GetClockFrequency_inline(void)
 {
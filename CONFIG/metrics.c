@@ -0,0 +1,206 @@
+/*
+ * metrics.c - Bloque central de métricas (ver metrics.h)
+ *
+ * Sólo lee los contadores de cada módulo con su función *_Get*: las
+ * copias de 32 bits protegidas frente a las ISR las hacen ellos.
+ */
+
+#include "metrics.h"
+#include "config.h"
+#include <stdio.h>
+
+#if METRICS_WITH_ADC
+#include "adc.h"
+#endif
+#if METRICS_WITH_FIRPIPE
+#include "firpipe.h"
+#endif
+#if METRICS_WITH_I2C
+#include "i2c.h"
+#endif
+#if METRICS_WITH_UART
+#include "uart.h"
+#endif
+#if METRICS_WITH_SCHED
+#include "sched.h"
+#endif
+
+static METRICS_Block_t metrics;
+
+void METRICS_Init(void)
+{
+    uint8_t *p = (uint8_t *)&metrics;
+    uint16_t i;
+
+    for (i = 0; i < sizeof(metrics); i++) {
+        p[i] = 0;
+    }
+    METRICS_Reset();
+    SYSTEM_SetPrintHook(METRICS_Print);
+}
+
+void METRICS_Reset(void)
+{
+    metrics.idle_percent_min = 100;
+    metrics.fir_max_cycles = 0;
+    metrics.t1_latency_max = 0;
+    SYSTEM_ResetTickLatency();
+#if METRICS_WITH_FIRPIPE
+    FIRPIPE_ResetMaxCycles();    /* si no, METRICS_Update recupera el viejo */
+#endif
+}
+
+void METRICS_Update(void)
+{
+    metrics.uptime_ms = SYSTEM_GetTickMs();
+    metrics.t1_latency_max = SYSTEM_GetTickLatencyMax();
+
+#if METRICS_WITH_ADC
+    metrics.adc_samples = ADC_StreamGetBlockCount() * ADC_STREAM_BLOCK_LENGTH;
+    metrics.adc_overruns = ADC_StreamGetOverruns();
+#endif
+
+#if METRICS_WITH_FIRPIPE
+    {
+        FIRPIPE_Stats_t f;
+        FIRPIPE_GetStats(&f);
+        metrics.fir_blocks = f.blocks;
+        metrics.fir_last_cycles = f.last_cycles;
+        metrics.fir_budget_cycles = f.budget_cycles;
+        metrics.fir_overruns = f.overruns;
+        metrics.fir_max_cycles = f.max_cycles;
+    }
+#endif
+
+#if METRICS_WITH_I2C
+    {
+        I2C_Stats_t s;
+        I2C_GetStats(I2C_MODULE_1, &s);
+        metrics.i2c_transactions = s.transactions;
+        metrics.i2c_nacks = s.nacks;
+        metrics.i2c_timeouts = s.timeouts;
+        metrics.i2c_errors = s.errors;
+        metrics.i2c_recoveries = s.recoveries;
+    }
+#endif
+
+#if METRICS_WITH_UART
+    {
+        UART_Stats_t u;
+        UART_GetStats(&u);
+        metrics.uart_tx_dropped = u.tx_dropped;
+        metrics.uart_frames_dropped = u.frames_dropped;
+    }
+#endif
+
+#if METRICS_WITH_SCHED
+    {
+        SCHED_TaskStats_t t;
+        uint16_t overruns = 0, skipped = 0;
+        int8_t id;
+
+        for (id = 0; SCHED_GetStats(id, &t); id++) {
+            overruns += t.overruns;
+            skipped += t.skipped;
+        }
+        metrics.sched_overruns = overruns;
+        metrics.sched_skipped = skipped;
+
+        metrics.idle_percent = SCHED_GetIdlePercent();
+        if (metrics.idle_percent < metrics.idle_percent_min) {
+            metrics.idle_percent_min = metrics.idle_percent;
+        }
+    }
+#endif
+}
+
+const METRICS_Block_t *METRICS_Get(void)
+{
+    return &metrics;
+}
+
+void METRICS_Print(void)
+{
+    /* Igual que SCHED_PrintStats: sin printf retargeteado no se ve nada */
+    printf("Metrics (%lu ms):\r\n", (unsigned long)metrics.uptime_ms);
+    printf("  idle %u%% (min %u%%), T1 ISR entry latency max %u cyc\r\n",
+           metrics.idle_percent, metrics.idle_percent_min, metrics.t1_latency_max);
+    printf("  sched overruns %u, skipped %u\r\n",
+           metrics.sched_overruns, metrics.sched_skipped);
+    printf("  adc samples %lu, overruns %u\r\n",
+           (unsigned long)metrics.adc_samples, metrics.adc_overruns);
+    printf("  fir blocks %lu, last %lu / max %lu of %lu cyc, overruns %u\r\n",
+           (unsigned long)metrics.fir_blocks, (unsigned long)metrics.fir_last_cycles,
+           (unsigned long)metrics.fir_max_cycles, (unsigned long)metrics.fir_budget_cycles,
+           metrics.fir_overruns);
+    printf("  i2c txn %lu, nack %u, timeout %u, error %u, recover %u\r\n",
+           (unsigned long)metrics.i2c_transactions, metrics.i2c_nacks,
+           metrics.i2c_timeouts, metrics.i2c_errors, metrics.i2c_recoveries);
+    printf("  uart dropped %u bytes, %u frames\r\n",
+           metrics.uart_tx_dropped, metrics.uart_frames_dropped);
+}
+
+static void metrics_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void metrics_put32(uint8_t *p, uint32_t v)
+{
+    metrics_put16(p, (uint16_t)(v >> 16));
+    metrics_put16(p + 2, (uint16_t)v);
+}
+
+/* Imagen completa en el orden de METRICS_REG_* */
+static void metrics_image(uint8_t *img)
+{
+    uint32_t dropped = (uint32_t)metrics.uart_tx_dropped + metrics.uart_frames_dropped;
+
+    img[METRICS_REG_IDLE] = metrics.idle_percent;
+    img[METRICS_REG_IDLE_MIN] = metrics.idle_percent_min;
+    metrics_put16(&img[METRICS_REG_T1_LATENCY], metrics.t1_latency_max);
+    metrics_put32(&img[METRICS_REG_ADC_SAMPLES], metrics.adc_samples);
+    metrics_put16(&img[METRICS_REG_ADC_OVERRUNS], metrics.adc_overruns);
+    metrics_put32(&img[METRICS_REG_FIR_MAX_CYCLES], metrics.fir_max_cycles);
+    metrics_put16(&img[METRICS_REG_FIR_OVERRUNS], metrics.fir_overruns);
+    metrics_put32(&img[METRICS_REG_I2C_TRANSACTIONS], metrics.i2c_transactions);
+    metrics_put16(&img[METRICS_REG_I2C_NACKS], metrics.i2c_nacks);
+    metrics_put16(&img[METRICS_REG_I2C_TIMEOUTS], metrics.i2c_timeouts);
+    metrics_put16(&img[METRICS_REG_I2C_ERRORS], metrics.i2c_errors);
+    metrics_put16(&img[METRICS_REG_I2C_RECOVERIES], metrics.i2c_recoveries);
+    metrics_put16(&img[METRICS_REG_SCHED_OVERRUNS], metrics.sched_overruns);
+    metrics_put16(&img[METRICS_REG_UART_DROPPED],
+                  (dropped > 0xFFFFu) ? 0xFFFFu : (uint16_t)dropped);
+}
+
+uint8_t METRICS_Export(uint8_t *regs, uint8_t length)
+{
+    uint8_t img[METRICS_REG_COUNT];
+    uint8_t i;
+
+    if (regs == 0) {
+        return 0;
+    }
+    if (length > METRICS_REG_COUNT) {
+        length = METRICS_REG_COUNT;
+    }
+
+    metrics_image(img);
+    for (i = 0; i < length; i++) {
+        regs[i] = img[i];
+    }
+    return length;
+}
+
+bool METRICS_SendFrame(void)
+{
+#if METRICS_WITH_UART
+    uint8_t img[METRICS_REG_COUNT];
+
+    metrics_image(img);
+    return UART_SendFrame(UART_FRAME_STATS, img, sizeof(img));
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,153 @@
+/*
+ * metrics.h - Bloque central de contadores y máximos de funcionamiento
+ *
+ * Descripción:
+ *  Reúne en una sola estructura lo que cada módulo ya mide por su cuenta
+ *  (ADC_StreamGetOverruns, FIRPIPE_GetStats, I2C_GetStats, UART_GetStats,
+ *  SCHED_GetStats / SCHED_GetIdlePercent, SYSTEM_GetTickLatencyMax) para
+ *  ver el rendimiento y la saturación en campo sin depurador. Los módulos
+ *  no dependen de este: METRICS_Update() les pregunta a ellos.
+ *
+ *  Tres salidas con el mismo contenido:
+ *    - METRICS_Print(): texto por printf; METRICS_Init() lo engancha al
+ *      final de SYSTEM_PrintConfiguration().
+ *    - METRICS_Export(): imagen de METRICS_REG_COUNT bytes (big endian,
+ *      mapa METRICS_REG_*) para el banco de registros del esclavo I2C.
+ *    - METRICS_SendFrame(): la misma imagen como trama UART_FRAME_STATS.
+ *
+ *  Qué módulos se consultan lo deciden macros del proyecto (por defecto 0,
+ *  para no obligar a enlazar drivers que no se usan):
+ *    METRICS_WITH_ADC, METRICS_WITH_FIRPIPE, METRICS_WITH_I2C,
+ *    METRICS_WITH_UART, METRICS_WITH_SCHED.
+ *
+ * USO:
+ *      METRICS_Init();
+ *      SCHED_AddTask("metricas", tarea_metricas, 1000, 0);
+ *
+ *      void tarea_metricas(void) {
+ *          METRICS_Update();        // ventana de idle = periodo de la tarea
+ *          METRICS_SendFrame();
+ *      }
+ *
+ * Nota:
+ *  - El dsPIC33FJ32MC204 no tiene DMA: los "bloques fuera de plazo" son los
+ *    bloques ping-pong del ADC sobrescritos antes de consumirse
+ *    (adc_overruns) y los de FIRPIPE (fir_overruns).
+ *  - Llamar a METRICS_Update() a ritmo fijo (p. ej. 1 s): idle_percent es
+ *    la media entre dos llamadas.
+ *  - t1_latency_max es sólo la latencia de entrada de la ISR del tick (TMR1
+ *    al entrar en _T1Interrupt). Con el tick a prioridad 7 recoge el tiempo
+ *    con IPL 7; las ISR del ADC y de la UART, de menos prioridad, esperan
+ *    al menos eso, pero su latencia no se mide (no tienen una referencia
+ *    de tiempo como TMR1).
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef METRICS_WITH_ADC
+#define METRICS_WITH_ADC      0
+#endif
+#ifndef METRICS_WITH_FIRPIPE
+#define METRICS_WITH_FIRPIPE  0
+#endif
+#ifndef METRICS_WITH_I2C
+#define METRICS_WITH_I2C      0
+#endif
+#ifndef METRICS_WITH_UART
+#define METRICS_WITH_UART     0
+#endif
+#ifndef METRICS_WITH_SCHED
+#define METRICS_WITH_SCHED    0
+#endif
+
+typedef struct {
+    uint32_t uptime_ms;
+
+    /* ADC (streaming) */
+    uint32_t adc_samples;        /* resultados entregados en bloques */
+    uint16_t adc_overruns;       /* bloques sobrescritos sin consumir */
+
+    /* Pipeline FIR */
+    uint32_t fir_blocks;
+    uint32_t fir_last_cycles;    /* por bloque (o muestra) */
+    uint32_t fir_max_cycles;     /* máximo desde FIRPIPE_Start o METRICS_Reset */
+    uint32_t fir_budget_cycles;  /* disponibles a la tasa actual */
+    uint16_t fir_overruns;
+
+    /* I2C1 */
+    uint32_t i2c_transactions;
+    uint16_t i2c_nacks;
+    uint16_t i2c_timeouts;
+    uint16_t i2c_errors;
+    uint16_t i2c_recoveries;     /* reintentos del bus (I2C_RecoverBus) */
+
+    /* UART */
+    uint16_t uart_tx_dropped;    /* bytes de texto */
+    uint16_t uart_frames_dropped;
+
+    /* Sistema */
+    uint16_t t1_latency_max;     /* ciclos hasta entrar en _T1Interrupt, peor caso */
+    uint16_t sched_overruns;     /* suma de todas las tareas */
+    uint16_t sched_skipped;
+    uint8_t idle_percent;        /* última ventana */
+    uint8_t idle_percent_min;    /* peor ventana desde METRICS_Reset */
+} METRICS_Block_t;
+
+/* Mapa de METRICS_Export (desplazamiento en bytes, big endian) */
+#define METRICS_REG_IDLE            0x00u   /* 1 byte, % */
+#define METRICS_REG_IDLE_MIN        0x01u   /* 1 byte, % */
+#define METRICS_REG_T1_LATENCY      0x02u   /* 2 bytes, ciclos */
+#define METRICS_REG_ADC_SAMPLES     0x04u   /* 4 bytes */
+#define METRICS_REG_ADC_OVERRUNS    0x08u   /* 2 bytes */
+#define METRICS_REG_FIR_MAX_CYCLES  0x0Au   /* 4 bytes */
+#define METRICS_REG_FIR_OVERRUNS    0x0Eu   /* 2 bytes */
+#define METRICS_REG_I2C_TRANSACTIONS 0x10u  /* 4 bytes */
+#define METRICS_REG_I2C_NACKS       0x14u   /* 2 bytes */
+#define METRICS_REG_I2C_TIMEOUTS    0x16u   /* 2 bytes */
+#define METRICS_REG_I2C_ERRORS      0x18u   /* 2 bytes */
+#define METRICS_REG_I2C_RECOVERIES  0x1Au   /* 2 bytes */
+#define METRICS_REG_SCHED_OVERRUNS  0x1Cu   /* 2 bytes */
+#define METRICS_REG_UART_DROPPED    0x1Eu   /* 2 bytes, texto + tramas */
+#define METRICS_REG_COUNT           0x20u
+
+/* --------------------------------------------------------------------------
+ * PROTOTIPOS DE FUNCIONES
+ * ------------------------------------------------------------------------ */
+
+/* Pone a cero el bloque y engancha METRICS_Print a SYSTEM_PrintConfiguration */
+void METRICS_Init(void);
+
+/* Máximos y mínimos del bloque a su valor inicial: también los de cada
+   módulo (latencia del tick, FIRPIPE_ResetMaxCycles), para que el siguiente
+   METRICS_Update no los recupere. Los contadores no se tocan. */
+void METRICS_Reset(void);
+
+/* Lee los módulos habilitados y actualiza el bloque. Desde el bucle
+   principal o una tarea, no desde una ISR. */
+void METRICS_Update(void);
+
+const METRICS_Block_t *METRICS_Get(void);
+
+void METRICS_Print(void);
+
+/* Copia hasta 'length' bytes de la imagen (desde el registro 0). Devuelve
+   los bytes escritos. */
+uint8_t METRICS_Export(uint8_t *regs, uint8_t length);
+
+/* Trama UART_FRAME_STATS con la imagen completa; false si no cabe (o sin
+   METRICS_WITH_UART) */
+bool METRICS_SendFrame(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* METRICS_H */
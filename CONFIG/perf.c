@@ -0,0 +1,115 @@
+/*
+ * perf.c - Implementación del contador de ciclos (ver perf.h)
+ *
+ * Descripción:
+ *  PERF_Init() deja el timer corriendo a Tcy con periodo máximo y mide una
+ *  vez el coste fijo de la propia medida para poder descontarlo. Con Timer2
+ *  solo, la interrupción de desborde extiende el contador a 32 bits.
+ *
+ */
+
+#include "perf.h"
+#include <xc.h>
+#include <stdio.h>
+
+static PERF_Cycles_t perf_overhead = 0;
+
+#ifndef CONFIG_PERF_TIMER32
+volatile uint16_t perf_t2_overflows = 0;
+#endif
+
+void PERF_Init(void)
+{
+    PERF_Cycles_t t0;
+
+    PMD1bits.T2MD = 0;       /* activar el timer si CONFIG_PMD_AUTO lo apagó */
+#ifdef CONFIG_PERF_TIMER32
+    PMD1bits.T3MD = 0;
+    T2CON = 0;
+    T3CON = 0;
+    T2CONbits.T32 = 1;       /* Timer2/3 como un timer de 32 bits, Tcy, 1:1 */
+    PR3 = 0xFFFF;
+    PR2 = 0xFFFF;
+    TMR3HLD = 0;
+    TMR2 = 0;
+    IEC0bits.T3IE = 0;       /* en 32 bits la interrupción es la de Timer3 */
+#else
+    T2CON = 0;               /* 16 bits, Tcy, prescaler 1:1 */
+    PR2 = 0xFFFF;
+    TMR2 = 0;
+    perf_t2_overflows = 0;
+    IFS0bits.T2IF = 0;
+    IPC1bits.T2IP = PERF_IRQ_PRIORITY;
+    IEC0bits.T2IE = 1;       /* desbordes: mitad alta del contador */
+#endif
+    T2CONbits.TON = 1;
+
+    t0 = PERF_Now();
+    perf_overhead = PERF_Elapsed(t0);
+}
+
+PERF_Cycles_t PERF_GetOverhead(void)
+{
+    return perf_overhead;
+}
+
+void PERF_StatReset(PERF_Stat_t *stat, const char *name, uint16_t samples)
+{
+    if (stat == NULL) return;
+
+    stat->name = name;
+    stat->samples = (samples == 0) ? 1 : samples;
+    stat->calls = 0;
+    stat->min = 0xFFFFFFFFUL;
+    stat->max = 0;
+    stat->total = 0;
+}
+
+void PERF_StatAdd(PERF_Stat_t *stat, uint32_t cycles)
+{
+    if (stat == NULL) return;
+
+    if (cycles < stat->min) stat->min = cycles;
+    if (cycles > stat->max) stat->max = cycles;
+    stat->total += cycles;
+    stat->calls++;
+}
+
+uint32_t PERF_StatAvg(const PERF_Stat_t *stat)
+{
+    if (stat == NULL || stat->calls == 0) return 0;
+    return stat->total / stat->calls;
+}
+
+uint32_t PERF_StatAvgPerSample(const PERF_Stat_t *stat)
+{
+    if (stat == NULL) return 0;
+    return PERF_StatAvg(stat) / stat->samples;
+}
+
+void PERF_StatPrint(const PERF_Stat_t *stat)
+{
+    if (stat == NULL || stat->calls == 0) return;
+
+    /* Si no has retargeteado printf a UART, esto no hace nada visible; los
+       valores siguen en RAM para leerlos con el depurador. */
+    printf("%-16s n=%u min=%lu avg=%lu max=%lu cyc/muestra=%lu\r\n",
+           stat->name ? stat->name : "?",
+           stat->calls,
+           (unsigned long)stat->min,
+           (unsigned long)PERF_StatAvg(stat),
+           (unsigned long)stat->max,
+           (unsigned long)PERF_StatAvgPerSample(stat));
+}
+
+#ifndef CONFIG_PERF_TIMER32
+/* Desborde de Timer2 (cada 65536 Tcy). Con DISI para que PERF_Now() no vea
+   el contador ya incrementado con T2IF aún a 1. */
+void __attribute__((interrupt, no_auto_psv)) _T2Interrupt(void)
+{
+    __builtin_disi(0x3FFF);
+    perf_t2_overflows++;
+    IFS0bits.T2IF = 0;
+    DISICNT = 0;
+}
+#endif
@@ -0,0 +1,99 @@
+/*
+ * perf.h - Medida de ciclos de instrucción para dsPIC33FJ32MC204
+ *
+ * Descripción:
+ *  Contador libre a Tcy de 32 bits y estadísticas min/avg/max por ruta
+ *  medida. Por defecto es Timer2 (16 bits) más un contador de desbordes que
+ *  lleva _T2Interrupt (perf.c), así Timer3 queda libre para el ADC y el
+ *  DAC; con CONFIG_PERF_TIMER32 (config.h) es el par Timer2/3.
+ *
+ * USO:
+ *      PERF_Init();
+ *      PERF_Cycles_t t0 = PERF_Now();
+ *      ... código a medir ...
+ *      PERF_StatAdd(&stat, PERF_Elapsed(t0) - PERF_GetOverhead());
+ *
+ * Nota:
+ *  - Las medidas y los presupuestos de firpipe/spectrum pasan de 65535
+ *    ciclos (un bloque de 64 muestras a 20 kHz son 128k Tcy a 40 MIPS, una
+ *    FFT de 256 puntos también): el contador no se da la vuelta hasta los
+ *    107 s.
+ *  - Con Timer2 solo, PERF_Now() lee con DISI y cuenta el desborde que aún
+ *    esté pendiente (T2IF), así que vale también dentro de una ISR de más
+ *    prioridad que PERF_IRQ_PRIORITY. Basta con que _T2Interrupt no quede
+ *    bloqueada más de medio periodo de Timer2 (32768 ciclos); durante un
+ *    Idle/Sleep sin SYSTEM_WAKE_ANY los desbordes no se cuentan.
+ *
+ ******************************************************************************/
+
+#ifndef PERF_H
+#define PERF_H
+
+#include "config.h"
+
+typedef uint32_t PERF_Cycles_t;
+
+#ifndef CONFIG_PERF_TIMER32
+/* Prioridad de _T2Interrupt (sólo cuenta desbordes: unos pocos ciclos) */
+#ifndef PERF_IRQ_PRIORITY
+#define PERF_IRQ_PRIORITY 6
+#endif
+
+/* Mitad alta del contador: desbordes de Timer2 (la incrementa perf.c) */
+extern volatile uint16_t perf_t2_overflows;
+#endif
+
+/* Estadísticas de una ruta medida */
+typedef struct {
+    const char *name;        /* nombre para el informe */
+    uint16_t samples;        /* muestras/bytes por llamada (para ciclos/muestra) */
+    uint16_t calls;          /* llamadas acumuladas */
+    uint32_t min;            /* ciclos por llamada */
+    uint32_t max;
+    uint32_t total;
+} PERF_Stat_t;
+
+/* --------------------------------------------------------------------------
+ * PROTOTIPOS DE FUNCIONES
+ * ------------------------------------------------------------------------ */
+void PERF_Init(void);
+PERF_Cycles_t PERF_GetOverhead(void);   /* coste de PERF_Now() + PERF_Elapsed() */
+
+void PERF_StatReset(PERF_Stat_t *stat, const char *name, uint16_t samples);
+void PERF_StatAdd(PERF_Stat_t *stat, uint32_t cycles);
+uint32_t PERF_StatAvg(const PERF_Stat_t *stat);
+uint32_t PERF_StatAvgPerSample(const PERF_Stat_t *stat);
+void PERF_StatPrint(const PERF_Stat_t *stat);
+
+/* Lectura del contador. En 32 bits, leer TMR2 copia TMR3 en TMR3HLD, así que
+   las dos mitades son del mismo instante. Con Timer2 solo, la mitad alta, el
+   TMR2 y T2IF se leen con DISI: si el desborde está pendiente y TMR2 ya ha
+   vuelto a empezar, se suma aquí. */
+static inline PERF_Cycles_t PERF_Now(void)
+{
+#ifdef CONFIG_PERF_TIMER32
+    uint16_t lsw = TMR2;
+    return ((uint32_t)TMR3HLD << 16) | lsw;
+#else
+    uint16_t msw, lsw;
+    bool pending;
+
+    __builtin_disi(0x3FFF);
+    msw = perf_t2_overflows;
+    lsw = TMR2;
+    pending = IFS0bits.T2IF;
+    DISICNT = 0;
+
+    if (pending && lsw < 0x8000u) {
+        msw++;
+    }
+    return ((uint32_t)msw << 16) | lsw;
+#endif
+}
+
+static inline PERF_Cycles_t PERF_Elapsed(PERF_Cycles_t start)
+{
+    return (PERF_Cycles_t)(PERF_Now() - start);
+}
+
+#endif /* PERF_H */
@@ -0,0 +1,150 @@
+/*
+ * ringbuf.c - Cola circular SPSC (ver ringbuf.h)
+ *
+ * Cada lado lee una sola vez el contador del otro (una instantánea de 16
+ * bits) y sólo publica el suyo al final, tras la barrera: el otro lado ve
+ * el elemento completo o no lo ve.
+ */
+
+#include "ringbuf.h"
+#include <string.h>
+
+bool RING_Init(RING_Buffer_t *r, void *storage, uint16_t elem_size, uint16_t capacity)
+{
+    if (r == 0 || storage == 0 || elem_size == 0 ||
+        capacity < 2u || capacity > 32768u || (capacity & (capacity - 1u)) != 0u) {
+        return false;
+    }
+
+    r->data = (uint8_t *)storage;
+    r->elem_size = elem_size;
+    r->mask = capacity - 1u;
+    r->head = 0;
+    r->tail = 0;
+    return true;
+}
+
+void RING_Reset(RING_Buffer_t *r)
+{
+    r->head = 0;
+    r->tail = 0;
+}
+
+/* Copia de un elemento: los tamaños habituales sin llamar a memcpy */
+static inline void ring_copy(void *dst, const void *src, uint16_t size)
+{
+    if (size == 2u) {
+        *(uint16_t *)dst = *(const uint16_t *)src;
+    } else if (size == 1u) {
+        *(uint8_t *)dst = *(const uint8_t *)src;
+    } else {
+        memcpy(dst, src, size);
+    }
+}
+
+bool RING_Push(RING_Buffer_t *r, const void *elem)
+{
+    uint16_t head = r->head;
+
+    if ((uint16_t)(head - r->tail) > r->mask) {
+        return false;       /* llena */
+    }
+
+    ring_copy(r->data + (head & r->mask) * r->elem_size, elem, r->elem_size);
+    RING_BARRIER();
+    r->head = head + 1u;
+    return true;
+}
+
+bool RING_Pop(RING_Buffer_t *r, void *elem)
+{
+    uint16_t tail = r->tail;
+
+    if (r->head == tail) {
+        return false;       /* vacía */
+    }
+
+    ring_copy(elem, r->data + (tail & r->mask) * r->elem_size, r->elem_size);
+    RING_BARRIER();
+    r->tail = tail + 1u;
+    return true;
+}
+
+void *RING_WriteSpan(RING_Buffer_t *r, uint16_t *n)
+{
+    uint16_t head = r->head;
+    uint16_t space = (uint16_t)(r->mask + 1u - (uint16_t)(head - r->tail));
+    uint16_t idx = head & r->mask;
+    uint16_t to_end = (uint16_t)(r->mask + 1u - idx);
+
+    *n = (space < to_end) ? space : to_end;
+    return r->data + idx * r->elem_size;
+}
+
+void RING_Commit(RING_Buffer_t *r, uint16_t n)
+{
+    RING_BARRIER();
+    r->head = r->head + n;
+}
+
+const void *RING_ReadSpan(RING_Buffer_t *r, uint16_t *n)
+{
+    uint16_t tail = r->tail;
+    uint16_t count = (uint16_t)(r->head - tail);
+    uint16_t idx = tail & r->mask;
+    uint16_t to_end = (uint16_t)(r->mask + 1u - idx);
+
+    *n = (count < to_end) ? count : to_end;
+    return r->data + idx * r->elem_size;
+}
+
+void RING_Release(RING_Buffer_t *r, uint16_t n)
+{
+    RING_BARRIER();
+    r->tail = r->tail + n;
+}
+
+uint16_t RING_PushBulk(RING_Buffer_t *r, const void *src, uint16_t n)
+{
+    const uint8_t *s = (const uint8_t *)src;
+    uint16_t done = 0;
+
+    /* Como mucho dos tramos: hasta el final del buffer y desde el principio */
+    while (done < n) {
+        uint16_t span;
+        void *dst = RING_WriteSpan(r, &span);
+
+        if (span == 0) {
+            break;
+        }
+        if (span > n - done) {
+            span = n - done;
+        }
+        memcpy(dst, s + done * r->elem_size, span * r->elem_size);
+        RING_Commit(r, span);
+        done += span;
+    }
+    return done;
+}
+
+uint16_t RING_PopBulk(RING_Buffer_t *r, void *dst, uint16_t n)
+{
+    uint8_t *d = (uint8_t *)dst;
+    uint16_t done = 0;
+
+    while (done < n) {
+        uint16_t span;
+        const void *src = RING_ReadSpan(r, &span);
+
+        if (span == 0) {
+            break;
+        }
+        if (span > n - done) {
+            span = n - done;
+        }
+        memcpy(d + done * r->elem_size, src, span * r->elem_size);
+        RING_Release(r, span);
+        done += span;
+    }
+    return done;
+}
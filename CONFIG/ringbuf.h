@@ -0,0 +1,108 @@
+/*
+ * ringbuf.h - Cola circular SPSC (un productor, un consumidor) sin bloqueo
+ *
+ * Descripción:
+ *  Paso de datos entre una ISR y el bucle principal (o al revés) sin
+ *  deshabilitar interrupciones. Sólo el productor escribe 'head' y sólo el
+ *  consumidor escribe 'tail'; los dos son contadores libres de 16 bits, que
+ *  en este núcleo se leen y escriben en un único acceso. La capacidad es
+ *  potencia de dos: el índice es contador & mask y la ocupación es
+ *  head - tail (correcta también al desbordar los contadores).
+ *
+ *  Además de Push/Pop elemento a elemento hay acceso por tramos contiguos:
+ *  el consumidor procesa los datos en el propio buffer (RING_ReadSpan +
+ *  RING_Release) y el productor escribe directamente en él (RING_WriteSpan
+ *  + RING_Commit), sin copias intermedias.
+ *
+ * USO (ISR productora, bucle consumidor):
+ *      RING_STORAGE(muestras_buf, uint16_t, 64);
+ *      static RING_Buffer_t muestras;
+ *
+ *      RING_Init(&muestras, muestras_buf, sizeof(uint16_t), 64);
+ *
+ *      // ISR
+ *      uint16_t v = ADC1BUF0;
+ *      RING_Push(&muestras, &v);
+ *
+ *      // bucle principal
+ *      uint16_t n;
+ *      const uint16_t *p = RING_ReadSpan(&muestras, &n);
+ *      ... procesar p[0..n-1] ...
+ *      RING_Release(&muestras, n);
+ *
+ * Nota:
+ *  - Un productor y un consumidor por cola. Si dos contextos empujan en la
+ *    misma cola (p. ej. bucle principal y una ISR) sí hay que protegerla.
+ *  - El tramo contiguo termina al final del almacenamiento: para todo lo
+ *    pendiente pueden hacer falta dos llamadas.
+ *
+ ******************************************************************************/
+
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Barrera de compilador: los datos del elemento quedan escritos (o leídos)
+   antes de publicar el nuevo head (o tail). En un solo núcleo basta. */
+#define RING_BARRIER()  __asm__ volatile ("" ::: "memory")
+
+/* Almacenamiento estático con comprobación de potencia de dos al compilar */
+#define RING_STORAGE(name, type, capacity)                                     \
+    typedef char name##_pow2_check[(((capacity) & ((capacity) - 1u)) == 0u     \
+                                    && (capacity) != 0u) ? 1 : -1];            \
+    static type name[(capacity)]
+
+typedef struct {
+    uint8_t *data;
+    uint16_t elem_size;      /* bytes por elemento */
+    uint16_t mask;           /* capacidad - 1 */
+    volatile uint16_t head;  /* lo avanza sólo el productor */
+    volatile uint16_t tail;  /* lo avanza sólo el consumidor */
+} RING_Buffer_t;
+
+/* --------------------------------------------------------------------------
+ * PROTOTIPOS DE FUNCIONES
+ * ------------------------------------------------------------------------ */
+
+/* capacity en elementos, potencia de dos (2..32768). false si no lo es. */
+bool RING_Init(RING_Buffer_t *r, void *storage, uint16_t elem_size, uint16_t capacity);
+
+/* Vacía la cola. Sólo con productor y consumidor parados. */
+void RING_Reset(RING_Buffer_t *r);
+
+/* Productor */
+bool RING_Push(RING_Buffer_t *r, const void *elem);
+uint16_t RING_PushBulk(RING_Buffer_t *r, const void *src, uint16_t n);
+void *RING_WriteSpan(RING_Buffer_t *r, uint16_t *n);    /* hueco contiguo */
+void RING_Commit(RING_Buffer_t *r, uint16_t n);
+
+/* Consumidor */
+bool RING_Pop(RING_Buffer_t *r, void *elem);
+uint16_t RING_PopBulk(RING_Buffer_t *r, void *dst, uint16_t n);
+const void *RING_ReadSpan(RING_Buffer_t *r, uint16_t *n); /* datos contiguos */
+void RING_Release(RING_Buffer_t *r, uint16_t n);
+
+/* Valores instantáneos (desde cualquiera de los dos lados) */
+static inline uint16_t RING_Count(const RING_Buffer_t *r)
+{
+    return (uint16_t)(r->head - r->tail);
+}
+
+static inline uint16_t RING_Free(const RING_Buffer_t *r)
+{
+    return (uint16_t)(r->mask + 1u - RING_Count(r));
+}
+
+static inline bool RING_IsEmpty(const RING_Buffer_t *r)
+{
+    return r->head == r->tail;
+}
+
+static inline bool RING_IsFull(const RING_Buffer_t *r)
+{
+    return RING_Count(r) > r->mask;
+}
+
+#endif /* RINGBUF_H */
@@ -0,0 +1,208 @@
+/*
+ * sched.c - Planificador cooperativo sobre el tick de 1 ms (ver sched.h)
+ *
+ * Los instantes de activación se guardan en milisegundos del tick y se
+ * comparan con resta en 32 bits, así que el desbordamiento del contador
+ * (~49 días) no afecta. La duración de cada tarea se mide en ciclos con
+ * Timer1: milisegundos * (PR1 + 1) + TMR1.
+ */
+
+#include "sched.h"
+#include "config.h"
+#include <xc.h>
+#include <stdio.h>
+#include <stddef.h>
+
+typedef struct {
+    SCHED_Task_t task;
+    uint32_t next_ms;        /* próxima activación (tick) */
+    bool enabled;
+    SCHED_TaskStats_t stats;
+} sched_entry_t;
+
+static sched_entry_t sched_tasks[SCHED_MAX_TASKS];
+static uint8_t sched_count = 0;
+static SCHED_Task_t sched_idle = 0;
+
+/* Ciclos dentro del gancho de reposo y comienzo de la ventana de medida
+   (SCHED_GetIdlePercent) */
+static uint32_t sched_idle_cycles = 0;
+static uint32_t sched_window_start = 0;
+
+/* Instante actual en ciclos de Tcy. Repetir si el tick cambió entre la
+   lectura de los milisegundos y la de TMR1. */
+static uint32_t sched_now_cycles(void)
+{
+    uint32_t ms;
+    uint16_t t;
+
+    do {
+        ms = SYSTEM_GetTickMs();
+        t = TMR1;
+    } while (ms != SYSTEM_GetTickMs());
+
+    return ms * ((uint32_t)PR1 + 1u) + t;
+}
+
+void SCHED_Init(void)
+{
+    sched_count = 0;
+    sched_idle = 0;
+    sched_idle_cycles = 0;
+    sched_window_start = sched_now_cycles();
+}
+
+int8_t SCHED_AddTask(const char *name, SCHED_Task_t task, uint16_t period_ms,
+                     uint16_t phase_ms)
+{
+    sched_entry_t *e;
+
+    if (task == 0 || period_ms == 0 || sched_count >= SCHED_MAX_TASKS) {
+        return -1;
+    }
+
+    e = &sched_tasks[sched_count];
+    e->task = task;
+    e->next_ms = SYSTEM_GetTickMs() + phase_ms;
+    e->enabled = true;
+    e->stats.name = name;
+    e->stats.period_ms = period_ms;
+    e->stats.runs = 0;
+    e->stats.last_cycles = 0;
+    e->stats.max_cycles = 0;
+    e->stats.overruns = 0;
+    e->stats.skipped = 0;
+
+    return (int8_t)sched_count++;
+}
+
+void SCHED_SetEnabled(int8_t id, bool enabled)
+{
+    if (id < 0 || (uint8_t)id >= sched_count) {
+        return;
+    }
+    if (enabled && !sched_tasks[id].enabled) {
+        sched_tasks[id].next_ms = SYSTEM_GetTickMs();
+    }
+    sched_tasks[id].enabled = enabled;
+}
+
+void SCHED_SetIdleHook(SCHED_Task_t hook)
+{
+    sched_idle = hook;
+}
+
+uint8_t SCHED_RunOnce(void)
+{
+    uint8_t ran = 0;
+    uint8_t i;
+
+    for (i = 0; i < sched_count; i++) {
+        sched_entry_t *e = &sched_tasks[i];
+        uint32_t t0, dt, now;
+
+        if (!e->enabled || (int32_t)(SYSTEM_GetTickMs() - e->next_ms) < 0) {
+            continue;
+        }
+
+        t0 = sched_now_cycles();
+        e->task();
+        dt = sched_now_cycles() - t0;
+
+        e->stats.runs++;
+        e->stats.last_cycles = dt;
+        if (dt > e->stats.max_cycles) {
+            e->stats.max_cycles = dt;
+        }
+        if (dt > (uint32_t)e->stats.period_ms * ((uint32_t)PR1 + 1u)) {
+            e->stats.overruns++;
+        }
+
+        /* Siguiente activación en la rejilla de la tarea. Si ya van
+           vencidas varias, se ejecuta una sola vez (con retraso) y el resto
+           se cuenta como perdidas. */
+        e->next_ms += e->stats.period_ms;
+        now = SYSTEM_GetTickMs();
+        if ((int32_t)(now - e->next_ms) > 0) {
+            uint32_t lost = (now - e->next_ms) / e->stats.period_ms;
+            e->stats.skipped += (uint16_t)lost;
+            e->next_ms += lost * e->stats.period_ms;
+        }
+
+        ran++;
+    }
+
+    if (ran == 0 && sched_idle != 0) {
+        uint32_t t0 = sched_now_cycles();
+        sched_idle();
+        sched_idle_cycles += sched_now_cycles() - t0;
+    }
+
+    return ran;
+}
+
+void SCHED_Run(void)
+{
+    while (1) {
+        /* Con el watchdog encendido, una tarea que no vuelve lo hace saltar */
+        SYSTEM_ClearWatchdog();
+        (void)SCHED_RunOnce();
+    }
+}
+
+bool SCHED_GetStats(int8_t id, SCHED_TaskStats_t *stats)
+{
+    if (stats == NULL || id < 0 || (uint8_t)id >= sched_count) {
+        return false;
+    }
+    *stats = sched_tasks[id].stats;
+    return true;
+}
+
+uint8_t SCHED_GetIdlePercent(void)
+{
+    uint32_t now = sched_now_cycles();
+    uint32_t total = now - sched_window_start;
+    uint32_t idle = sched_idle_cycles;
+
+    sched_window_start = now;
+    sched_idle_cycles = 0;
+
+    if (total < 100u) {
+        return 0;
+    }
+    idle /= total / 100u;
+    return (idle > 100u) ? 100u : (uint8_t)idle;
+}
+
+void SCHED_ResetStats(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < sched_count; i++) {
+        sched_tasks[i].stats.runs = 0;
+        sched_tasks[i].stats.last_cycles = 0;
+        sched_tasks[i].stats.max_cycles = 0;
+        sched_tasks[i].stats.overruns = 0;
+        sched_tasks[i].stats.skipped = 0;
+    }
+}
+
+void SCHED_PrintStats(void)
+{
+    uint8_t i;
+
+    /* Igual que PERF_StatPrint: sin printf retargeteado no se ve nada */
+    for (i = 0; i < sched_count; i++) {
+        const SCHED_TaskStats_t *s = &sched_tasks[i].stats;
+
+        printf("%-12s T=%ums n=%lu last=%lu max=%lu overrun=%u skip=%u\r\n",
+               s->name ? s->name : "?",
+               s->period_ms,
+               (unsigned long)s->runs,
+               (unsigned long)s->last_cycles,
+               (unsigned long)s->max_cycles,
+               s->overruns,
+               s->skipped);
+    }
+}
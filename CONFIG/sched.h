@@ -0,0 +1,91 @@
+/*
+ * sched.h - Planificador cooperativo de tareas periódicas sobre el tick
+ *
+ * Descripción:
+ *  Tabla fija de tareas con periodo y fase en milisegundos, despachadas desde
+ *  el bucle principal con el tick de 1 kHz de config.c (Timer1). Cada tarea
+ *  corre hasta terminar (no hay expropiación), así que no necesita pila
+ *  propia ni protección frente a las demás tareas; sólo frente a las ISR.
+ *  Cuando no hay ninguna tarea pendiente se llama al gancho de reposo (por
+ *  ejemplo SYSTEM_EnterIdle para parar la CPU hasta la siguiente interrupción).
+ *
+ *  Cada ejecución se mide en ciclos de instrucción con el propio Timer1
+ *  (tick * (PR1 + 1) + TMR1), sin ocupar otro timer: se guardan la última
+ *  y la máxima duración, las ejecuciones más largas que el periodo y las
+ *  activaciones perdidas por retraso.
+ *
+ * USO:
+ *      SYSTEM_Initialize();
+ *      SCHED_Init();
+ *      SCHED_AddTask("adc", tarea_adc, 1, 0);       // cada 1 ms
+ *      SCHED_AddTask("leds", tarea_leds, 20, 5);    // cada 20 ms, desfase 5 ms
+ *      SCHED_SetIdleHook(SYSTEM_EnterIdle);
+ *      SCHED_Run();                                  // no vuelve
+ *
+ * Nota:
+ *  - La fase reparte las tareas del mismo periodo en ticks distintos para
+ *    que no coincidan todas en el mismo milisegundo.
+ *  - Si una tarea llega tarde más de un periodo, las activaciones perdidas
+ *    no se recuperan en ráfaga: se cuentan en 'skipped' y la tarea vuelve a
+ *    su rejilla (múltiplos del periodo desde la fase).
+ *  - Las tareas no deben esperar con __delay_ms: bloquean a todas las demás.
+ *
+ ******************************************************************************/
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Tamaño de la tabla de tareas */
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS  8
+#endif
+
+typedef void (*SCHED_Task_t)(void);
+
+/* Medidas de una tarea (ciclos de instrucción, FCY) */
+typedef struct {
+    const char *name;
+    uint16_t period_ms;
+    uint32_t runs;           /* ejecuciones */
+    uint32_t last_cycles;    /* duración de la última */
+    uint32_t max_cycles;     /* peor caso */
+    uint16_t overruns;       /* ejecuciones más largas que el periodo */
+    uint16_t skipped;        /* activaciones perdidas por retraso */
+} SCHED_TaskStats_t;
+
+/* --------------------------------------------------------------------------
+ * PROTOTIPOS DE FUNCIONES
+ * ------------------------------------------------------------------------ */
+void SCHED_Init(void);
+
+/* Añade una tarea: primera ejecución en phase_ms desde ahora y después cada
+   period_ms (>= 1). Devuelve su índice, o -1 si la tabla está llena. */
+int8_t SCHED_AddTask(const char *name, SCHED_Task_t task, uint16_t period_ms,
+                     uint16_t phase_ms);
+
+/* Suspende/reanuda. Al reanudar la tarea se ejecuta en el siguiente tick. */
+void SCHED_SetEnabled(int8_t id, bool enabled);
+
+/* Función llamada cuando no hay tareas pendientes (0: espera activa) */
+void SCHED_SetIdleHook(SCHED_Task_t hook);
+
+/* Ejecuta las tareas vencidas (o el gancho de reposo si no hay ninguna).
+   Devuelve el número de tareas ejecutadas. */
+uint8_t SCHED_RunOnce(void);
+
+/* Bucle principal: SCHED_RunOnce() indefinidamente, borrando el watchdog
+   en cada pasada (SYSTEM_ClearWatchdog) */
+void SCHED_Run(void);
+
+bool SCHED_GetStats(int8_t id, SCHED_TaskStats_t *stats);
+
+/* Porcentaje del tiempo pasado en el gancho de reposo desde la llamada
+   anterior (ventana de como mucho ~100 s a 40 MIPS). Sin gancho, 0. */
+uint8_t SCHED_GetIdlePercent(void);
+void SCHED_ResetStats(void);
+void SCHED_PrintStats(void);
+
+#endif /* SCHED_H */
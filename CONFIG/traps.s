@@ -0,0 +1,53 @@
+; ..............................................................................
+;    File   traps.s
+;
+;    Vectores de trampa del dsPIC33FJ32MC204: fallo de oscilador, error de
+;    dirección, error de pila y error matemático. Cada uno pasa su código
+;    (SYSTEM_Trap_t de config.h) a system_trap() en config.c, que guarda el
+;    registro de fallo en RAM persistente y hace un reset por software.
+;
+;    Al entrar en la trampa la CPU apila PC<15:0> y después
+;    SRL | IPL3 | PC<22:16>: el PC está en [W15-4] y [W15-2]. Se lee antes
+;    de rehacer la pila (W15 y SPLIM a sus valores de arranque), así que
+;    también vale con la pila desbordada. No se vuelve a la instrucción que
+;    falló.
+;
+;    Llamada a C (XC16): pc de 32 bits en w1:w0, código en w2.
+; ..............................................................................
+
+                .include "xc.inc"
+
+                .text
+                .global __OscillatorFail
+                .global __AddressError
+                .global __StackError
+                .global __MathError
+
+__OscillatorFail:
+                mov     #1, w2              ; SYSTEM_TRAP_OSCILLATOR
+                bra     trap_common
+
+__AddressError:
+                mov     #2, w2              ; SYSTEM_TRAP_ADDRESS
+                bra     trap_common
+
+__StackError:
+                mov     #3, w2              ; SYSTEM_TRAP_STACK
+                bra     trap_common
+
+__MathError:
+                mov     #4, w2              ; SYSTEM_TRAP_MATH
+
+trap_common:
+                mov     [w15-4], w0         ; PC<15:0>
+                mov     [w15-2], w1
+                mov     #0x007F, w3
+                and     w1, w3, w1          ; PC<22:16>
+                mov     #__SP_init, w15     ; pila nueva
+                mov     #__SPLIM_init, w3
+                mov     w3, SPLIM
+                nop                         ; SPLIM no vale en la siguiente instrucción
+                call    _system_trap
+                reset                       ; system_trap no vuelve
+
+                .end
@@ -0,0 +1,241 @@
+/*
+ * dac.c
+ *
+ * Implementación de la salida continua por SPI1 a un DAC externo (ver dac.h).
+ *
+ * Uso:
+ *  - Llama a DAC_Init() una vez (configura SPI1, los pines PPS y CS).
+ *  - Arranca el ADC a tasa fija y después DAC_StreamStart(formato, 0), o
+ *    DAC_StreamStart(formato, tasa) si no hay ADC en marcha.
+ *  - Define _T3Interrupt llamando a DAC_ISR_Handler() (ver FILTROFIR4a.c).
+ */
+
+#include "dac.h"
+#include "config.h" /* FCY para el periodo de Timer3 */
+#include "q15vec.h"
+#include <xc.h>
+
+/* Códigos de función de salida PPS (RPnR) */
+#define DAC_RPOUT_SDO1  7u
+#define DAC_RPOUT_SCK1  8u
+
+/* Internals */
+static const fractional *volatile dac_cur = 0;   /* bloque que se está reproduciendo */
+static volatile uint16_t dac_cur_len = 0;
+static volatile uint16_t dac_pos = 0;
+static const fractional *volatile dac_next = 0;  /* bloque en cola (0 = hueco libre) */
+static volatile uint16_t dac_next_len = 0;
+static volatile uint16_t dac_underruns = 0;
+static DAC_Format_t dac_format = DAC_FORMAT_BIPOLAR;
+static bool dac_owns_timer = false;
+
+static const uint16_t dac_t3_prescalers[4] = { 1u, 8u, 64u, 256u };
+
+void DAC_Init(void)
+{
+    PMD1bits.SPI1MD = 0;     /* módulo activo (CONFIG_PMD_AUTO) */
+    SPI1STATbits.SPIEN = 0;
+
+    /* CS en reposo alto antes de dar la salida al pin */
+    DAC_CS_LAT = 1;
+    DAC_CS_TRIS = 0;
+    DAC_SCK_TRIS = 0;
+    DAC_SDO_TRIS = 0;
+
+    /* PPS: desbloquear, asignar SCK1/SDO1 y volver a bloquear. Con
+       IOL1WAY = ON sólo se admite una reconfiguración tras el reset. */
+    __builtin_write_OSCCONL(OSCCON & 0xBF);
+    DAC_SCK_RPOR = DAC_RPOUT_SCK1;
+    DAC_SDO_RPOR = DAC_RPOUT_SDO1;
+    __builtin_write_OSCCONL(OSCCON | 0x40);
+
+    /* Maestro, 16 bits, modo 0,0 (CKP = 0, CKE = 1), sin SDI */
+    SPI1CON1 = 0;
+    SPI1CON1bits.DISSDI = 1;
+    SPI1CON1bits.MODE16 = 1;
+    SPI1CON1bits.CKE = 1;
+    SPI1CON1bits.CKP = 0;
+    SPI1CON1bits.MSTEN = 1;
+    SPI1CON1bits.PPRE = DAC_SPI_PPRE;
+    SPI1CON1bits.SPRE = DAC_SPI_SPRE;
+    SPI1CON2 = 0;
+
+    SPI1STAT = 0;
+    IEC0bits.SPI1IE = 0;     /* la transferencia la marca Timer3, no el SPI */
+    SPI1STATbits.SPIEN = 1;
+}
+
+/* Configura Timer3 para 'rate_hz' (mismo criterio que el ADC: menor
+   prescaler que cabe en 16 bits). Devuelve la tasa real o 0; 'shared'
+   indica que Timer3 ya corría con ese periodo y no se ha tocado. */
+static uint32_t dac_timer3_setup(uint32_t rate_hz, bool *shared)
+{
+    uint32_t ticks = 0;
+    uint8_t tckps;
+
+    for (tckps = 0; tckps < 4; tckps++) {
+        uint32_t div = (uint32_t)dac_t3_prescalers[tckps] * rate_hz;
+        ticks = ((uint32_t)FCY + div / 2u) / div;
+        if (ticks >= 2u && ticks <= 65536UL) {
+            break;
+        }
+    }
+    if (tckps == 4) {
+        return 0;
+    }
+
+    /* Timer3 del ADC en marcha: no se reprograma (igual que
+       adc_timer3_setup con el del DAC). Con el mismo periodo se comparte */
+    *shared = (T3CONbits.TON && !dac_owns_timer);
+    if (*shared) {
+        if (T3CONbits.TCKPS != tckps || PR3 != (uint16_t)(ticks - 1u)) {
+            return 0;
+        }
+        return (uint32_t)FCY / ((uint32_t)dac_t3_prescalers[tckps] * ticks);
+    }
+
+    PMD1bits.T3MD = 0;
+    T3CONbits.TON = 0;
+    T3CONbits.TCS = 0;
+    T3CONbits.TGATE = 0;
+    T3CONbits.TCKPS = tckps;
+    TMR3 = 0;
+    PR3 = (uint16_t)(ticks - 1u);
+
+    return (uint32_t)FCY / ((uint32_t)dac_t3_prescalers[tckps] * ticks);
+}
+
+uint32_t DAC_StreamStart(DAC_Format_t format, uint32_t rate_hz)
+{
+    uint32_t real_rate;
+
+    IEC0bits.T3IE = 0;
+
+    if (rate_hz == 0) {
+        /* Seguir al ADC: misma base de tiempos que ya corre en Timer3 */
+        if (!T3CONbits.TON) {
+            return 0;
+        }
+        real_rate = (uint32_t)FCY /
+                    ((uint32_t)dac_t3_prescalers[T3CONbits.TCKPS] * ((uint32_t)PR3 + 1u));
+        dac_owns_timer = false;
+    } else {
+        bool shared;
+
+        real_rate = dac_timer3_setup(rate_hz, &shared);
+        if (real_rate == 0) {
+            return 0;
+        }
+        dac_owns_timer = !shared;
+    }
+
+    dac_format = format;
+    dac_pos = 0;
+    dac_underruns = 0;
+
+    IFS0bits.T3IF = 0;
+    IPC2bits.T3IP = DAC_IRQ_PRIORITY;
+    IEC0bits.T3IE = 1;
+
+    if (dac_owns_timer) {
+        T3CONbits.TON = 1;
+    }
+
+    return real_rate;
+}
+
+void DAC_StreamStop(void)
+{
+    IEC0bits.T3IE = 0;
+    IFS0bits.T3IF = 0;
+    if (dac_owns_timer) {
+        T3CONbits.TON = 0;
+        dac_owns_timer = false;
+    }
+
+    dac_cur = 0;
+    dac_next = 0;
+    dac_pos = 0;
+    DAC_CS_LAT = 1;
+}
+
+bool DAC_StreamCanWrite(void)
+{
+    return dac_next == 0;
+}
+
+/* Encola 'block' para después del que suena ahora (o lo reproduce ya si no
+   hay ninguno). Devuelve false si la cola está ocupada. */
+bool DAC_StreamWrite(const fractional *block, uint16_t length)
+{
+    bool irq;
+
+    if (block == 0 || length == 0 || dac_next != 0) {
+        return false;
+    }
+
+    irq = IEC0bits.T3IE;
+    IEC0bits.T3IE = 0;
+    if (dac_cur == 0) {
+        dac_cur_len = length;
+        dac_pos = 0;
+        dac_cur = block;
+    } else {
+        dac_next_len = length;
+        dac_next = block;
+    }
+    IEC0bits.T3IE = irq;
+
+    return true;
+}
+
+uint16_t DAC_StreamGetUnderruns(void)
+{
+    return dac_underruns;
+}
+
+void DAC_Q15AbsScale(fractional *dst, const fractional *src, uint16_t length, uint8_t shift)
+{
+    Q15_VectorAbs(length, dst, src);
+    Q15_VectorShift(length, dst, dst, (int16_t)shift);
+}
+
+/* Un tick de Timer3 = una muestra de salida */
+void DAC_ISR_Handler(void)
+{
+    const fractional *cur = dac_cur;
+    fractional x;
+    uint16_t code;
+
+    IFS0bits.T3IF = 0;
+
+    /* Flanco de subida de CS: el DAC carga la palabra del tick anterior */
+    DAC_CS_LAT = 1;
+    (void)SPI1BUF;
+    SPI1STATbits.SPIROV = 0;
+
+    if (cur == 0) {
+        return;
+    }
+
+    x = cur[dac_pos];
+    if (dac_format == DAC_FORMAT_BIPOLAR) {
+        code = (uint16_t)((uint16_t)x ^ 0x8000u) >> (16u - DAC_RESOLUTION_BITS);
+    } else {
+        code = (uint16_t)(x & ~(x >> 15)) >> (15u - DAC_RESOLUTION_BITS);
+    }
+
+    DAC_CS_LAT = 0;
+    SPI1BUF = DAC_COMMAND_BITS | code;
+
+    if (++dac_pos >= dac_cur_len) {
+        dac_pos = 0;
+        if (dac_next != 0) {
+            dac_cur_len = dac_next_len;
+            dac_cur = dac_next;
+            dac_next = 0;
+        } else {
+            dac_underruns++;   /* se repite el bloque actual */
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * dac.h
+ *
+ * Salida continua de bloques Q15 a un DAC externo por SPI1 (MCP4921 o
+ * compatible: palabra de 16 bits = 4 bits de control + 12 de dato).
+ *
+ * El dsPIC33FJ32MC204 no tiene DMA ni DCI, así que la salida la marca la
+ * interrupción de Timer3: el mismo evento de periodo que dispara el ADC en
+ * ADC_StartTimed() / ADC_ScanStart(), de modo que el DAC saca exactamente una
+ * muestra por cada muestra de entrada. En cada tick la ISR sube CS (el DAC
+ * carga la palabra anterior), baja CS y escribe la siguiente en SPI1BUF; el
+ * módulo SPI la envía solo mientras la CPU sigue con otra cosa. La salida
+ * va así una muestra por detrás, con retardo fijo y sin jitter del bucle
+ * principal.
+ *
+ * API:
+ *   void DAC_Init(void);                                 // SPI1 + PPS + CS
+ *   uint32_t DAC_StreamStart(DAC_Format_t fmt, uint32_t rate_hz); // 0 = seguir al ADC
+ *   bool DAC_StreamCanWrite(void);                       // hay hueco para otro bloque
+ *   bool DAC_StreamWrite(const fractional *block, uint16_t length);
+ *   void DAC_StreamStop(void);
+ *   uint16_t DAC_StreamGetUnderruns(void);
+ *   void DAC_Q15AbsScale(fractional *dst, const fractional *src,
+ *                        uint16_t length, uint8_t shift);
+ *   void DAC_ISR_Handler(void);                          // llamar desde _T3Interrupt
+ *
+ * USO (salida del pipeline FIR a la misma tasa que el ADC):
+ *      DAC_Init();
+ *      FIRPIPE_Start(0, 20000);
+ *      DAC_StreamStart(DAC_FORMAT_BIPOLAR, 0);
+ *      ...
+ *      if (FIRPIPE_Process() && DAC_StreamCanWrite()) {
+ *          DAC_StreamWrite(FIRPIPE_GetOutput(), FIRPIPE_BLOCK_LENGTH);
+ *      }
+ *
+ * Nota:
+ * - DAC_StreamWrite() no copia: el bloque debe seguir válido hasta que
+ *   DAC_StreamCanWrite() vuelva a dar true (el DAC ya lo está reproduciendo
+ *   y el anterior se ha soltado). Los bloques ping-pong de firpipe cumplen
+ *   esto si ADC y DAC van con el mismo Timer3.
+ * - Si al acabar un bloque no hay otro preparado, se repite el mismo y se
+ *   cuenta un underrun. Un único bloque escrito una vez se reproduce en
+ *   bucle (útil para tablas estáticas como FilterOut).
+ * - Con rate_hz = 0 Timer3 debe estar ya en marcha (ADC en modo Timer3).
+ */
+
+#ifndef DAC_H
+#define DAC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pines (PPS): SCK1 -> RP16 (RC0), SDO1 -> RP17 (RC1), CS -> RC2 */
+#ifndef DAC_SCK_RPOR
+#define DAC_SCK_RPOR   RPOR8bits.RP16R
+#endif
+#ifndef DAC_SDO_RPOR
+#define DAC_SDO_RPOR   RPOR8bits.RP17R
+#endif
+#ifndef DAC_SCK_TRIS
+#define DAC_SCK_TRIS   TRISCbits.TRISC0
+#endif
+#ifndef DAC_SDO_TRIS
+#define DAC_SDO_TRIS   TRISCbits.TRISC1
+#endif
+#ifndef DAC_CS_TRIS
+#define DAC_CS_TRIS    TRISCbits.TRISC2
+#endif
+#ifndef DAC_CS_LAT
+#define DAC_CS_LAT     LATCbits.LATC2
+#endif
+
+/* Bits de control del MCP4921: canal A, sin buffer de Vref, ganancia 1x,
+   salida activa. Se combinan con los 12 bits de dato. */
+#ifndef DAC_COMMAND_BITS
+#define DAC_COMMAND_BITS 0x3000u
+#endif
+
+#define DAC_RESOLUTION_BITS 12u
+
+/* Reloj SPI = FCY / (PPRE * SPRE). Por defecto 4:1 y 1:1 -> 10 MHz a 40 MIPS */
+#ifndef DAC_SPI_PPRE
+#define DAC_SPI_PPRE   2u   /* 00 = 64:1, 01 = 16:1, 10 = 4:1, 11 = 1:1 */
+#endif
+#ifndef DAC_SPI_SPRE
+#define DAC_SPI_SPRE   7u   /* 111 = 1:1 ... 000 = 8:1 */
+#endif
+
+#ifndef DAC_IRQ_PRIORITY
+#define DAC_IRQ_PRIORITY 5  /* _T3Interrupt; igual que el streaming del ADC */
+#endif
+
+/* Correspondencia Q15 -> código del DAC */
+typedef enum {
+    DAC_FORMAT_BIPOLAR = 0,  /* -1.0 .. +1.0 -> 0 .. 4095 (0 a media escala) */
+    DAC_FORMAT_UNIPOLAR      /* 0 .. +1.0 -> 0 .. 4095 (negativos a 0) */
+} DAC_Format_t;
+
+void DAC_Init(void);
+
+/* Arranca la salida. rate_hz = 0 usa el periodo de Timer3 ya configurado
+   por el ADC; otro valor configura y arranca Timer3 a esa tasa. Devuelve la
+   tasa real (Hz) o 0 si no es posible o si el ADC ya tiene Timer3 en marcha
+   con otro periodo. */
+uint32_t DAC_StreamStart(DAC_Format_t format, uint32_t rate_hz);
+void DAC_StreamStop(void);
+
+bool DAC_StreamCanWrite(void);
+bool DAC_StreamWrite(const fractional *block, uint16_t length);
+uint16_t DAC_StreamGetUnderruns(void);
+
+/* dst[i] = |src[i]| << shift, con saturación a 0x7FFF y sin ramas por
+   muestra (src == dst permitido), sobre Q15_VectorAbs/Q15_VectorShift.
+   shift = 1 reproduce el "abs x 2" de FILTROFIR4a.c. */
+void DAC_Q15AbsScale(fractional *dst, const fractional *src, uint16_t length, uint8_t shift);
+
+/* Handler de la interrupción de Timer3 (llamar desde _T3Interrupt) */
+void DAC_ISR_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DAC_H */
@@ -7,6 +7,11 @@
  * Comentarios en español y nombres coincidentes con tus .s:
  *  - _square1k                 -> extern fractional square1k[256];
  *  - _lowpassexampleFilter     -> extern FIRStruct lowpassexampleFilter;
+ *
+ * La salida |y| x 2 sale por SPI1 a un DAC externo (dac.h) a 20 kHz, la
+ * tasa de la señal de entrada, y se repite en bucle para verla en el
+ * osciloscopio. Añade dac.c, q15vec.c, q15vec.s, config.c y clock.c al
+ * proyecto.
  **********************************************************************/
 
 // DSPIC33FJ32MC204 Configuration Bit Settings
@@ -51,16 +56,17 @@
 // #pragma config statements should precede project file includes.
 // Use project enums instead of #define for ON and OFF.
 
-#define FCY 36850000UL  /* Hz - ajusta según tu configuración real */
-
+#include "config.h"  /* FCY y SYSTEM_Initialize (oscilador y PLL en clock.c) */
 #include <xc.h>
-#include "p33Fxxxx.h"
 #include "dsp.h"
-#include <libpic30.h>
+#include "dac.h"
 
 /* Longitud del bloque (coincide con el número de hword en _square1k) */
 #define BLOCK_LENGTH 256
 
+/* Tasa de _square1k: 1 kHz en 20 muestras */
+#define SAMPLE_RATE_HZ 20000u
+
 /* Declaraciones externas (coinciden con lo exportado en tus .s) */
 extern fractional square1k[BLOCK_LENGTH];       /* _square1k en inputsignal_square1khz.s */
 extern FIRStruct lowpassexampleFilter;          /* _lowpassexampleFilter en lowpassexample.s */
@@ -70,20 +76,11 @@ fractional FilterOut[BLOCK_LENGTH];             /* Buffer de salida */
 /* Programa principal: configura reloj, inicializa y ejecuta el FIR una vez */
 int main(void)
 {
-    /* Configurar PLL como en el ejemplo original (opcional si ya lo tienes) */
-    PLLFBD = 38;                 /* M = 40 */
-    CLKDIVbits.PLLPOST = 0;      /* N1 = 2 */
-    CLKDIVbits.PLLPRE = 0;       /* N2 = 2 */
-    OSCTUN = 0;
-
     /* Deshabilitar Watchdog por software */
     RCONbits.SWDTEN = 0;
 
-    /* Cambio de reloj a Primary Oscillator with PLL */
-    __builtin_write_OSCCONH(0x03);
-    __builtin_write_OSCCONL(0x01);
-    while (OSCCONbits.COSC != 0b011) ;
-    while (OSCCONbits.LOCK != 1) ;
+    /* Reloj a 40 MIPS según config.h (PLL calculado por clock.c) */
+    SYSTEM_Initialize();
 
     /* Inicializa la línea de retardo del filtro (estado) */
     FIRDelayInit(&lowpassexampleFilter);
@@ -91,32 +88,23 @@ int main(void)
     /* Ejecuta FIR pasabajo sobre el bloque de entrada */
     FIR(BLOCK_LENGTH, &FilterOut[0], &square1k[0], &lowpassexampleFilter);
 
-    /* En FilterOut quedan las muestras filtradas; bucle infinito */
- while (1) {
-    int i;
-    
-    TRISB = 0x0000;
-    
-    for (i = 0; i < BLOCK_LENGTH; i++) {
-        /* Convertir Q15 a positivo simple:
-           Tomar el valor absoluto y multiplicar por 2 para usar 16 bits */
-        
-        int valor_q15 = FilterOut[i];  /* Valor en Q15 con signo */
-        unsigned int valor_positivo;
-        
-        if (valor_q15 < 0) {
-            valor_positivo = -valor_q15;  /* Valor absoluto */
-        } else {
-            valor_positivo = valor_q15;
-        }
-        
-        /* Escalar: Q15 usa 15 bits para magnitud, nosotros queremos 16 bits */
-        valor_positivo = valor_positivo * 2;  /* o valor_positivo << 1 */
-        
-        PORTB = valor_positivo;
-        __delay_ms(100);
+    /* |y| x 2 en Q15, sin rama por muestra */
+    DAC_Q15AbsScale(&FilterOut[0], &FilterOut[0], BLOCK_LENGTH, 1);
+
+    /* Timer3 marca cada muestra; un único bloque se reproduce en bucle */
+    DAC_Init();
+    DAC_StreamStart(DAC_FORMAT_UNIPOLAR, SAMPLE_RATE_HZ);
+    DAC_StreamWrite(&FilterOut[0], BLOCK_LENGTH);
+
+    while (1) {
+        /* La salida la mantiene la ISR de Timer3 */
     }
-}
-    
+
     return 0;
 }
+
+/* Una muestra al DAC por periodo de Timer3 */
+void __attribute__((interrupt, no_auto_psv)) _T3Interrupt(void)
+{
+    DAC_ISR_Handler();
+}
@@ -0,0 +1,34 @@
+/*
+ * filterbank.c
+ *
+ * Implementación del banco de filtros multitasa (ver filterbank.h).
+ *
+ * Uso:
+ *  - Añade multirate.s y libdsp al proyecto.
+ *  - Llama a FBANK_Init() una vez y después a las funciones de filtrado por
+ *    bloques; el estado de cada filtro se conserva entre llamadas.
+ */
+
+#include "filterbank.h"
+
+void FBANK_Init(void)
+{
+    FIRDelayInit(&decim4Filter);
+    FIRInterpDelayInit(&interp4Filter, FBANK_INTERPOLATION);
+    IIRTransposedInit(&biquadFilter);
+}
+
+fractional *FBANK_Decimate(int out_samples, fractional *dst, fractional *src)
+{
+    return FIRDecimate(out_samples, dst, src, &decim4Filter, FBANK_DECIMATION);
+}
+
+fractional *FBANK_Interpolate(int in_samples, fractional *dst, fractional *src)
+{
+    return FIRInterpolate(in_samples, dst, src, &interp4Filter, FBANK_INTERPOLATION);
+}
+
+fractional *FBANK_Biquad(int num_samples, fractional *dst, fractional *src)
+{
+    return IIRTransposed(num_samples, dst, src, &biquadFilter);
+}
@@ -0,0 +1,55 @@
+/*
+ * filterbank.h
+ *
+ * Banco de filtros multitasa sobre la librería DSP (dsp.h) y los filtros de
+ * multirate.s.
+ *
+ * Cadena típica con el ADC sobremuestreado x4:
+ *   entrada (fs)  --FBANK_Decimate-->  fs/4  --FBANK_Biquad-->  fs/4
+ *   fs/4  --FBANK_Interpolate-->  fs (p. ej. de vuelta a un DAC)
+ *
+ * FIRDecimate solo calcula una de cada R salidas y FIRInterpolate usa la
+ * forma polifásica (numTaps/R MAC por salida), así que el coste por muestra
+ * de entrada es 1/R del de FIR() con los mismos taps.
+ *
+ * API:
+ *   void FBANK_Init(void);                               // líneas de retardo a 0
+ *   fractional *FBANK_Decimate(int out_samples, fractional *dst, fractional *src);
+ *   fractional *FBANK_Interpolate(int in_samples, fractional *dst, fractional *src);
+ *   fractional *FBANK_Biquad(int num_samples, fractional *dst, fractional *src);
+ *
+ * Nota:
+ * - FBANK_Decimate lee out_samples * FBANK_DECIMATION muestras de src.
+ * - FBANK_Interpolate escribe in_samples * FBANK_INTERPOLATION muestras en dst.
+ * - src y dst no deben solaparse.
+ */
+
+#ifndef FILTERBANK_H
+#define FILTERBANK_H
+
+#include <stdint.h>
+#include "dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Factores de los filtros de multirate.s (el nº de taps es múltiplo de ambos) */
+#define FBANK_DECIMATION     4
+#define FBANK_INTERPOLATION  4
+
+/* Filtros definidos en multirate.s */
+extern FIRStruct decim4Filter;              /* _decim4Filter */
+extern FIRStruct interp4Filter;             /* _interp4Filter */
+extern IIRTransposedStruct biquadFilter;    /* _biquadFilter */
+
+void FBANK_Init(void);
+fractional *FBANK_Decimate(int out_samples, fractional *dst, fractional *src);
+fractional *FBANK_Interpolate(int in_samples, fractional *dst, fractional *src);
+fractional *FBANK_Biquad(int num_samples, fractional *dst, fractional *src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILTERBANK_H */
@@ -0,0 +1,135 @@
+/*
+ * filterpool.c
+ *
+ * Implementación de los filtros en tiempo de ejecución (ver filterpool.h).
+ */
+
+#include "filterpool.h"
+#include <xc.h>
+
+#if (FPOOL_X_BYTES & (FPOOL_X_BYTES - 1)) != 0 || (FPOOL_Y_BYTES & (FPOOL_Y_BYTES - 1)) != 0
+#error "FPOOL_X_BYTES y FPOOL_Y_BYTES deben ser potencias de 2"
+#endif
+
+/* Cada pool alineado a su propio tamaño: así cualquier bloque alineado
+   dentro del pool queda alineado también en dirección absoluta. */
+static fractional fpool_x[FPOOL_X_BYTES / 2] __attribute__((space(xmemory), aligned(FPOOL_X_BYTES)));
+static fractional fpool_y[FPOOL_Y_BYTES / 2] __attribute__((space(ymemory), aligned(FPOOL_Y_BYTES)));
+
+static uint16_t fpool_x_used = 0;   /* bytes */
+static uint16_t fpool_y_used = 0;
+
+/* Reserva 'words' palabras alineadas a la potencia de 2 >= tamaño en bytes
+   (requisito del direccionamiento modular de XMODSRT/YMODSRT). */
+static fractional *fpool_alloc(fractional *pool, uint16_t pool_bytes, uint16_t *used, uint16_t words)
+{
+    uint16_t bytes = words * 2u;
+    uint16_t align = 2;
+    uint16_t offset;
+
+    if (words == 0 || bytes > pool_bytes) {
+        return 0;
+    }
+
+    while (align < bytes) {
+        align <<= 1;
+    }
+
+    offset = (*used + align - 1u) & (uint16_t)~(align - 1u);
+    if (offset > pool_bytes - bytes) {
+        return 0;
+    }
+
+    *used = offset + bytes;
+    return pool + offset / 2u;
+}
+
+void FPOOL_Reset(void)
+{
+    fpool_x_used = 0;
+    fpool_y_used = 0;
+}
+
+fractional *FPOOL_AllocX(uint16_t words)
+{
+    return fpool_alloc(fpool_x, FPOOL_X_BYTES, &fpool_x_used, words);
+}
+
+fractional *FPOOL_AllocY(uint16_t words)
+{
+    return fpool_alloc(fpool_y, FPOOL_Y_BYTES, &fpool_y_used, words);
+}
+
+uint16_t FPOOL_FreeX(void)
+{
+    return (uint16_t)(FPOOL_X_BYTES - fpool_x_used);
+}
+
+uint16_t FPOOL_FreeY(void)
+{
+    return (uint16_t)(FPOOL_Y_BYTES - fpool_y_used);
+}
+
+/* Crea un FIR de num_taps coeficientes copiando 'taps' (RAM o flash) al
+   pool X. Con swappable reserva el segundo banco para FPOOL_FilterLoad.
+   Devuelve false si no hay sitio; en ese caso el pool queda como estaba. */
+bool FPOOL_FilterCreate(FPOOL_Filter_t *f, uint16_t num_taps, const fractional *taps, bool swappable)
+{
+    uint16_t x_used = fpool_x_used;
+    uint16_t y_used = fpool_y_used;
+    fractional *delay;
+    uint16_t i;
+
+    if (f == 0 || taps == 0 || num_taps == 0) {
+        return false;
+    }
+
+    f->taps[0] = FPOOL_AllocX(num_taps);
+    f->taps[1] = swappable ? FPOOL_AllocX(num_taps) : 0;
+    delay = FPOOL_AllocY(num_taps);
+
+    if (f->taps[0] == 0 || delay == 0 || (swappable && f->taps[1] == 0)) {
+        fpool_x_used = x_used;
+        fpool_y_used = y_used;
+        return false;
+    }
+
+    for (i = 0; i < num_taps; i++) {
+        f->taps[0][i] = taps[i];
+    }
+    f->active = 0;
+
+    FIRStructInit(&f->fir, (int)num_taps, f->taps[0], COEFFS_IN_DATA, delay);
+    FIRDelayInit(&f->fir);
+
+    return true;
+}
+
+/* Carga nuevos coeficientes (mismo número de taps) sin parar el filtro.
+   Se copian al banco inactivo y después se cambian coeffsBase/coeffsEnd
+   con las interrupciones de prioridad 1..6 bloqueadas, para que una ISR
+   que ejecuta FIR() nunca vea un puntero del banco viejo y otro del nuevo.
+   La función en sí se llama desde el bucle principal, no desde una ISR
+   (ver filterpool.h). */
+bool FPOOL_FilterLoad(FPOOL_Filter_t *f, const fractional *taps)
+{
+    fractional *next;
+    uint16_t i;
+
+    if (f == 0 || taps == 0 || f->taps[1] == 0) {
+        return false;
+    }
+
+    next = f->taps[f->active ^ 1u];
+    for (i = 0; i < (uint16_t)f->fir.numCoeffs; i++) {
+        next[i] = taps[i];
+    }
+
+    __builtin_disi(0x3FFF);
+    f->fir.coeffsBase = next;
+    f->fir.coeffsEnd = (fractional *)((uint8_t *)next + f->fir.numCoeffs * 2 - 1);
+    DISICNT = 0;
+
+    f->active ^= 1u;
+    return true;
+}
@@ -0,0 +1,118 @@
+/*
+ * filterpool.h
+ *
+ * Filtros FIR creados en tiempo de ejecución desde C.
+ *
+ * Los coeficientes van a un pool estático en memoria X y las líneas de
+ * retardo a otro en memoria Y, cada bloque alineado a la potencia de 2
+ * que exige el direccionamiento modular (lo mismo que hace .align 256 en
+ * lowpassexample.s). El FIRStruct resultante se usa igual que
+ * lowpassexampleFilter: FIR(), FIRPIPE_Init(), etc.
+ *
+ * Cambio de coeficientes sin glitch: un filtro creado con 'swappable'
+ * reserva dos bancos de taps; FPOOL_FilterLoad copia los nuevos en el banco
+ * inactivo y cambia los punteros de forma atómica. La línea de retardo no
+ * se toca, así que la salida sigue sin transitorio de arranque.
+ *
+ * USO:
+ *      static FPOOL_Filter_t lp;
+ *      FPOOL_Reset();
+ *      FPOOL_FilterCreate(&lp, 32, taps_2khz, true);
+ *      FIR(n, out, in, &lp.fir);
+ *      ...
+ *      FPOOL_FilterLoad(&lp, taps_1khz);   // mismo número de taps
+ *
+ * Nota:
+ * - No hay liberación individual: FPOOL_Reset() vacía los dos pools.
+ * - FIR() puede ejecutarse en una ISR (p. ej. modo muestra de firpipe)
+ *   mientras el bucle principal llama a FPOOL_FilterLoad: el cambio de
+ *   coeffsBase/coeffsEnd se hace con DISI y la ISR ve siempre un banco
+ *   entero. Lo que no se admite es llamar a FPOOL_FilterLoad desde una ISR:
+ *   no es reentrante y, si interrumpe a un FIR() en curso, una segunda carga
+ *   reescribiría el banco que ese FIR() sigue leyendo.
+ * - Los pools se dimensionan para FPOOL_MAX_TAPS: FPOOL_X_BYTES = 2 bancos
+ *   alineados, FPOOL_Y_BYTES = una línea de retardo alineada. Por defecto
+ *   32 taps, el filtro más largo que se crea con el pool en este árbol
+ *   (benchmain.c; los de multirate.s también son de 32): 128 + 64 bytes.
+ *   Los 75 taps de lowpassexample.s necesitarían 512 + 256 bytes.
+ * - Presupuesto de RAM (2 KB) de la aplicación más grande, firpipemain.c
+ *   con el espectro y la UART:
+ *       lowpassexample.s  taps en X + retardo en Y (.align 256)    512 B
+ *       ADC               bloques ping-pong, 2 x 64 muestras        256 B
+ *       firpipe           entrada + salida ping-pong, 3 x 64        384 B
+ *       spectrum          spec_buf en Y (64 puntos) + bins          320 B
+ *       UART              anillos TX 256 + RX 32                    288 B
+ *                                                                  -------
+ *                                                                  1760 B
+ *   Quedan unos 288 bytes para la pila y el resto de variables, así que los
+ *   pools (sólo ocupan si se enlaza filterpool.c) no pueden pasar de
+ *   FPOOL_RAM_BUDGET, 256 bytes por defecto: se comprueba al compilar. Para
+ *   filtros más largos hay que subir FPOOL_RAM_BUDGET a la vez que
+ *   FPOOL_MAX_TAPS, sabiendo qué se deja fuera (p. ej. sin la FFT).
+ */
+
+#ifndef FILTERPOOL_H
+#define FILTERPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Filtro más largo que tiene que caber con 'swappable' */
+#ifndef FPOOL_MAX_TAPS
+#define FPOOL_MAX_TAPS 32
+#endif
+
+/* RAM máxima de los dos pools juntos (ver el presupuesto de arriba) */
+#ifndef FPOOL_RAM_BUDGET
+#define FPOOL_RAM_BUDGET 256
+#endif
+
+/* Bloque alineado que ocupa un buffer de n palabras (potencia de 2 >= 2n) */
+#define FPOOL_BLOCK_BYTES(n) \
+    ((n) <= 16 ? 32 : (n) <= 32 ? 64 : (n) <= 64 ? 128 : (n) <= 128 ? 256 : 512)
+
+/* Tamaño de los pools en bytes (potencias de 2; cuentan en los 2 KB de RAM) */
+#ifndef FPOOL_X_BYTES
+#define FPOOL_X_BYTES (2 * FPOOL_BLOCK_BYTES(FPOOL_MAX_TAPS))
+#endif
+
+#ifndef FPOOL_Y_BYTES
+#define FPOOL_Y_BYTES FPOOL_BLOCK_BYTES(FPOOL_MAX_TAPS)
+#endif
+
+#if FPOOL_MAX_TAPS > 256
+#error "FPOOL_MAX_TAPS > 256: un banco no cabe en la memoria X de 1 KB"
+#endif
+#if FPOOL_X_BYTES < 2 * FPOOL_BLOCK_BYTES(FPOOL_MAX_TAPS) || FPOOL_Y_BYTES < FPOOL_BLOCK_BYTES(FPOOL_MAX_TAPS)
+#error "FPOOL_X_BYTES / FPOOL_Y_BYTES no alcanzan para un filtro de FPOOL_MAX_TAPS con doble banco"
+#endif
+#if FPOOL_X_BYTES + FPOOL_Y_BYTES > FPOOL_RAM_BUDGET
+#error "FPOOL_X_BYTES + FPOOL_Y_BYTES pasan de FPOOL_RAM_BUDGET: no caben con el resto de la RAM"
+#endif
+
+/* Filtro con coeficientes intercambiables */
+typedef struct {
+    FIRStruct fir;              /* el que se pasa a FIR() */
+    fractional *taps[2];        /* bancos de coeficientes en X (taps[1] = NULL si no es swappable) */
+    uint8_t active;             /* banco en uso */
+} FPOOL_Filter_t;
+
+void FPOOL_Reset(void);
+fractional *FPOOL_AllocX(uint16_t words);
+fractional *FPOOL_AllocY(uint16_t words);
+uint16_t FPOOL_FreeX(void);
+uint16_t FPOOL_FreeY(void);
+
+bool FPOOL_FilterCreate(FPOOL_Filter_t *f, uint16_t num_taps, const fractional *taps, bool swappable);
+bool FPOOL_FilterLoad(FPOOL_Filter_t *f, const fractional *taps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILTERPOOL_H */
@@ -0,0 +1,237 @@
+/*
+ * firpipe.c
+ *
+ * Implementación del pipeline FIR en tiempo real (ver firpipe.h).
+ *
+ * Uso:
+ *  - Llama a ADC_Init(), FIRPIPE_Init(&lowpassexampleFilter) y
+ *    FIRPIPE_Start(canal, tasa).
+ *  - En el bucle principal llama a FIRPIPE_Process() tan a menudo como puedas.
+ *  - Define _ADC1Interrupt llamando a ADC_ISR_Handler() (ver firpipemain.c).
+ *  - Para el modo muestra llama antes a FIRPIPE_SetMode(FIRPIPE_MODE_SAMPLE,
+ *    cb): cb recibe cada salida desde la ISR y FIRPIPE_Process() no se usa.
+ */
+
+#include "firpipe.h"
+#include "config.h"  /* FCY para el presupuesto de ciclos */
+#include "perf.h"
+#include "q15vec.h"
+#include <xc.h>
+
+#ifdef CONFIG_PERF_TIMER32
+#error "firpipe usa Timer3 para disparar el ADC: desactiva CONFIG_PERF_TIMER32"
+#endif
+
+/* Conversión de muestra entera sin signo del ADC a Q15 con signo: se alinea a
+   la izquierda y se invierte el bit de signo (equivale a FORM = 11). El modo
+   muestra usa ADC_ScanStart(), que trabaja en 10 bits (AD12B = 0). */
+#define FIRPIPE_SCAN_SHIFT (16u - 10u)
+
+/* Internals */
+static FIRStruct *firpipe_filter = 0;
+
+static fractional firpipe_in[FIRPIPE_BLOCK_LENGTH];      /* bloque N en Q15 */
+static fractional firpipe_out[2][FIRPIPE_BLOCK_LENGTH];  /* salida ping-pong */
+static uint8_t firpipe_out_idx = 0;                      /* último bloque publicado */
+static bool firpipe_out_valid = false;
+
+static FIRPIPE_Stats_t firpipe_stats;
+
+static FIRPIPE_Mode_t firpipe_mode = FIRPIPE_MODE_BLOCK;
+static FIRPIPE_SampleCallback_t firpipe_sample_cb = 0;
+static volatile fractional firpipe_last_sample = 0;
+
+/* Modo muestra: se ejecuta en la ISR del ADC por cada conversión */
+static void firpipe_frame_cb(const ADC_Frame_t *frame)
+{
+    PERF_Cycles_t t0;
+    uint32_t cycles;
+    fractional x;
+    fractional y;
+
+    t0 = PERF_Now();
+
+    x = (fractional)((uint16_t)(frame->ch[0] << FIRPIPE_SCAN_SHIFT) ^ 0x8000u);
+    y = FIRPIPE_FilterSample(x);
+    firpipe_last_sample = y;
+
+    cycles = PERF_Elapsed(t0) - PERF_GetOverhead();
+
+    if (firpipe_sample_cb) {
+        firpipe_sample_cb(y);
+    }
+
+    firpipe_stats.last_cycles = cycles;
+    if (cycles > firpipe_stats.max_cycles) {
+        firpipe_stats.max_cycles = cycles;
+    }
+    if (cycles > firpipe_stats.budget_cycles) {
+        firpipe_stats.overruns++;
+    }
+    firpipe_stats.blocks++;
+}
+
+void FIRPIPE_Init(FIRStruct *filter)
+{
+    firpipe_filter = filter;
+    if (filter) {
+        FIRDelayInit(filter);
+    }
+
+    firpipe_out_idx = 0;
+    firpipe_out_valid = false;
+    firpipe_stats.last_cycles = 0;
+    firpipe_stats.max_cycles = 0;
+    firpipe_stats.budget_cycles = 0;
+    firpipe_stats.blocks = 0;
+    firpipe_stats.overruns = 0;
+    firpipe_last_sample = 0;
+}
+
+void FIRPIPE_SetMode(FIRPIPE_Mode_t mode, FIRPIPE_SampleCallback_t callback)
+{
+    firpipe_mode = mode;
+    firpipe_sample_cb = (mode == FIRPIPE_MODE_SAMPLE) ? callback : 0;
+}
+
+/* FIR() con una sola muestra: el puntero de la línea de retardo avanza una
+   posición dentro del buffer circular y el bucle MAC recorre siempre los
+   numCoeffs taps, así que el coste no depende de los datos. */
+fractional FIRPIPE_FilterSample(fractional x)
+{
+    fractional y = 0;
+
+    if (firpipe_filter) {
+        FIR(1, &y, &x, firpipe_filter);
+    }
+    return y;
+}
+
+fractional FIRPIPE_GetLastSample(void)
+{
+    return firpipe_last_sample;
+}
+
+uint32_t FIRPIPE_Start(uint8_t channel, uint32_t sample_rate_hz)
+{
+    uint32_t real_rate;
+
+    if (firpipe_filter == 0) {
+        return 0;
+    }
+
+    PERF_Init();
+
+    if (firpipe_mode == FIRPIPE_MODE_SAMPLE) {
+        ADC_ScanConfig_t cfg;
+
+        cfg.num_channels = 1;
+        cfg.ch0_input = channel;
+        cfg.ch0_scan_mask = 0;
+        cfg.ch123_upper = false;
+        cfg.trigger = ADC_TRIGGER_TIMER3;
+        cfg.rate_hz = sample_rate_hz;
+
+        real_rate = ADC_ScanStart(&cfg, firpipe_frame_cb);
+        if (real_rate == 0) {
+            return 0;
+        }
+
+        /* Ciclos entre dos muestras consecutivas */
+        firpipe_stats.budget_cycles = (uint32_t)FCY / real_rate;
+        return real_rate;
+    }
+
+    real_rate = ADC_StartTimed(channel, sample_rate_hz, 0);
+    if (real_rate == 0) {
+        return 0;
+    }
+
+    /* Ciclos entre dos bloques consecutivos del ADC */
+    firpipe_stats.budget_cycles = ((uint32_t)FCY / real_rate) * FIRPIPE_BLOCK_LENGTH;
+
+    return real_rate;
+}
+
+void FIRPIPE_Stop(void)
+{
+    ADC_StreamStop();
+}
+
+bool FIRPIPE_Process(void)
+{
+    const uint16_t *block;
+    fractional *in;
+    uint8_t next;
+    PERF_Cycles_t t0;
+    uint32_t cycles;
+    uint16_t i;
+
+    if (firpipe_mode != FIRPIPE_MODE_BLOCK) {
+        return false;
+    }
+
+    block = ADC_StreamGetBlock();
+    if (block == 0 || firpipe_filter == 0) {
+        return false;
+    }
+
+    t0 = PERF_Now();
+
+    /* Con FORM = 11 (ADC_SetStreamFormat) el bloque ya es Q15 y entra al
+       filtro sin pasar por firpipe_in */
+    if (ADC_GetStreamFormat() == ADC_FORMAT_FRACTIONAL) {
+        in = (fractional *)block;
+    } else {
+        Q15_FromADC(FIRPIPE_BLOCK_LENGTH, &firpipe_in[0], block, ADC_StreamGetResolutionBits());
+        in = &firpipe_in[0];
+    }
+
+    /* Escribir en el bloque que la aplicación no está leyendo */
+    next = firpipe_out_idx ^ 1u;
+    FIR(FIRPIPE_BLOCK_LENGTH, &firpipe_out[next][0], in, firpipe_filter);
+
+    cycles = PERF_Elapsed(t0) - PERF_GetOverhead();
+
+    firpipe_out_idx = next;
+    firpipe_out_valid = true;
+
+    firpipe_stats.last_cycles = cycles;
+    if (cycles > firpipe_stats.max_cycles) {
+        firpipe_stats.max_cycles = cycles;
+    }
+    firpipe_stats.blocks++;
+    firpipe_stats.overruns = ADC_StreamGetOverruns();
+
+    return true;
+}
+
+const fractional *FIRPIPE_GetOutput(void)
+{
+    return firpipe_out_valid ? firpipe_out[firpipe_out_idx] : 0;
+}
+
+/* Sólo el máximo: los contadores siguen (METRICS_Reset) */
+void FIRPIPE_ResetMaxCycles(void)
+{
+    bool irq = IEC0bits.AD1IE;
+
+    IEC0bits.AD1IE = 0;      /* 32 bits que la ISR escribe en modo muestra */
+    firpipe_stats.max_cycles = 0;
+    IEC0bits.AD1IE = irq;
+}
+
+void FIRPIPE_GetStats(FIRPIPE_Stats_t *stats)
+{
+    bool irq;
+
+    if (stats == 0) {
+        return;
+    }
+
+    /* En modo muestra la ISR actualiza las estadísticas */
+    irq = IEC0bits.AD1IE;
+    IEC0bits.AD1IE = 0;
+    *stats = firpipe_stats;
+    IEC0bits.AD1IE = irq;
+}
@@ -0,0 +1,122 @@
+/*
+ * firpipe.h
+ *
+ * Pipeline FIR en tiempo real alimentado por el streaming del ADC.
+ *
+ * Esquema (ping-pong):
+ *   ADC (ISR) llena el bloque N+1  --->  FIR() procesa el bloque N
+ *   FIR() escribe la salida en out[k] mientras la aplicación lee out[k^1]
+ *
+ * El filtro conserva su línea de retardo entre bloques (lowpassexampleFilter
+ * o cualquier FIRStruct), así que la salida es continua.
+ *
+ * API:
+ *   void FIRPIPE_Init(FIRStruct *filter);
+ *   uint32_t FIRPIPE_Start(uint8_t channel, uint32_t sample_rate_hz);
+ *   bool FIRPIPE_Process(void);              // llamar en el bucle principal
+ *   const fractional *FIRPIPE_GetOutput(void);
+ *   void FIRPIPE_GetStats(FIRPIPE_Stats_t *stats);
+ *   void FIRPIPE_ResetMaxCycles(void);
+ *   void FIRPIPE_Stop(void);
+ *
+ * Modo por muestra (baja latencia, para lazos de control):
+ *   void FIRPIPE_SetMode(FIRPIPE_MODE_SAMPLE, callback);   // antes de Start
+ *   fractional FIRPIPE_FilterSample(fractional x);        // llamable desde ISR
+ *   fractional FIRPIPE_GetLastSample(void);
+ *
+ * En modo bloque la salida llega con FIRPIPE_BLOCK_LENGTH muestras de
+ * retraso y FIR() amortiza su sobrecoste en todo el bloque (máximo
+ * rendimiento). En modo muestra cada conversión se filtra dentro de la ISR
+ * del ADC y el callback recibe y[n] en el mismo periodo de muestreo (mínima
+ * latencia). FIRPIPE_FilterSample() es FIR() con N = 1: la línea de retardo
+ * es circular (direccionamiento modular en Y, como lowpassexampleFilter),
+ * así que no hay desplazamiento de muestras ni ramas que dependan de los
+ * datos. Su coste es un sobrecoste fijo más numCoeffs ciclos de MAC y es el
+ * mismo en todas las llamadas; max_cycles en FIRPIPE_Stats_t lo confirma.
+ *
+ * Nota:
+ * - La longitud de bloque es ADC_STREAM_BLOCK_LENGTH (adc.h). Para cambiarla
+ *   defínela en las opciones del proyecto (-DADC_STREAM_BLOCK_LENGTH=128);
+ *   debe ser múltiplo de 8.
+ * - Timer3 dispara el ADC y Timer2 queda como contador libre de ciclos
+ *   (perf.h: 16 bits más _T2Interrupt, 32 bits en total, así que
+ *   budget_cycles y max_cycles valen aunque pasen de 65535). Ninguno de los
+ *   dos está disponible para la aplicación mientras el pipeline esté en
+ *   marcha. No actives CONFIG_PERF_TIMER32 junto con el pipeline.
+ * - En modo muestra FIR() se ejecuta en la ISR del ADC. Si el bucle principal
+ *   también usa la librería DSP, la ISR debe guardar los acumuladores y los
+ *   registros de direccionamiento modular, p. ej.
+ *   __attribute__((interrupt, no_auto_psv, save(ACCAL, ACCAH, ACCAU, MODCON,
+ *   XMODSRT, XMODEND, YMODSRT, YMODEND))).
+ */
+
+#ifndef FIRPIPE_H
+#define FIRPIPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp.h"
+#include "adc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FIRPIPE_BLOCK_LENGTH ADC_STREAM_BLOCK_LENGTH
+
+/* Medidas del pipeline. Los ciclos son de instrucción (Tcy) e incluyen la
+   conversión ADC -> Q15 (nula con ADC_FORMAT_FRACTIONAL) y la llamada a
+   FIR(). */
+typedef struct {
+    uint32_t last_cycles;    /* último bloque (o muestra) */
+    uint32_t max_cycles;     /* peor caso desde FIRPIPE_Start() o FIRPIPE_ResetMaxCycles() */
+    uint32_t budget_cycles;  /* ciclos disponibles por bloque (o muestra) a la tasa actual */
+    uint32_t blocks;         /* bloques (o muestras) procesados */
+    uint16_t overruns;       /* bloques del ADC perdidos / muestras fuera de plazo */
+} FIRPIPE_Stats_t;
+
+/* Modo de funcionamiento (FIRPIPE_SetMode) */
+typedef enum {
+    FIRPIPE_MODE_BLOCK = 0,  /* bloques ping-pong procesados en FIRPIPE_Process() */
+    FIRPIPE_MODE_SAMPLE      /* una muestra por interrupción del ADC */
+} FIRPIPE_Mode_t;
+
+/* Callback del modo muestra: contexto de interrupción, una llamada por muestra */
+typedef void (*FIRPIPE_SampleCallback_t)(fractional y);
+
+void FIRPIPE_Init(FIRStruct *filter);
+
+/* Elige el modo para el próximo FIRPIPE_Start() (por defecto, bloque). En
+   modo bloque se ignora 'callback'. */
+void FIRPIPE_SetMode(FIRPIPE_Mode_t mode, FIRPIPE_SampleCallback_t callback);
+
+/* Filtra una sola muestra con el filtro de FIRPIPE_Init() y devuelve y[n].
+   Tiempo de ejecución acotado y constante; se puede llamar desde una ISR. */
+fractional FIRPIPE_FilterSample(fractional x);
+
+/* Última salida del modo muestra */
+fractional FIRPIPE_GetLastSample(void);
+
+/* Arranca el ADC a tasa fija en 'channel'. Devuelve la tasa real (Hz) o 0
+   (tasa no alcanzable o Timer3 ya en marcha a otra tasa, ver ADC_StartTimed). */
+uint32_t FIRPIPE_Start(uint8_t channel, uint32_t sample_rate_hz);
+void FIRPIPE_Stop(void);
+
+/* Procesa un bloque si el ADC tiene uno listo. Devuelve true si lo hizo.
+   En modo muestra no hace nada y devuelve false. */
+bool FIRPIPE_Process(void);
+
+/* Último bloque filtrado (FIRPIPE_BLOCK_LENGTH muestras Q15), o 0 si aún no
+   hay ninguno. Válido hasta que termine el procesado del bloque siguiente. */
+const fractional *FIRPIPE_GetOutput(void);
+
+void FIRPIPE_GetStats(FIRPIPE_Stats_t *stats);
+
+/* Reinicia max_cycles sin parar el pipeline ni tocar los contadores */
+void FIRPIPE_ResetMaxCycles(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FIRPIPE_H */
@@ -0,0 +1,174 @@
+/**********************************************************************
+ * firpipemain.c
+ * Ejemplo del pipeline FIR en tiempo real: AN0 muestreado a tasa fija
+ * por Timer3, filtrado bloque a bloque con el pasabajo de
+ * lowpassexample.s y nivel de salida en RB0..RB7.
+ * En modo bloque la salida filtrada alimenta además el monitor espectral
+ * (spectrum.h): frecuencia dominante en FftPeakHz, y uno de cada
+ * TELEMETRY_SPECTRUM_DIV espectros sale por UART1 como trama binaria
+ * (uart.h, UART_FRAME_SPECTRUM).
+ * Con FIRPIPE_DEMO_MODE = FIRPIPE_MODE_SAMPLE cada muestra se filtra en
+ * la ISR del ADC y la salida sale a los LEDs en el mismo periodo.
+ *
+ * Archivos del proyecto:
+ *  - config.h / config.c, clock.h / clock.c, adc.h / adc.c
+ *  - firpipe.h / firpipe.c, q15vec.h / q15vec.c / q15vec.s, lowpassexample.s
+ *  - spectrum.h / spectrum.c, perf.h / perf.c
+ *  - uart.h / uart.c, ringbuf.h / ringbuf.c
+ *  - metrics.h / metrics.c con METRICS_WITH_ADC=1, METRICS_WITH_FIRPIPE=1
+ *    y METRICS_WITH_UART=1 (trama UART_FRAME_STATS cada segundo)
+ *  - _lowpassexampleFilter     -> extern FIRStruct lowpassexampleFilter;
+ **********************************************************************/
+
+// DSPIC33FJ32MC204 Configuration Bit Settings (mismos que FILTROFIR4.c)
+
+// FBS
+#pragma config BWRP = WRPROTECT_OFF     // Boot Segment Write Protect (Boot Segment may be written)
+#pragma config BSS = NO_FLASH           // Boot Segment Program Flash Code Protection (No Boot program Flash segment)
+
+// FGS
+#pragma config GWRP = OFF               // General Code Segment Write Protect (User program memory is not write-protected)
+#pragma config GSS = OFF                // General Segment Code Protection (User program memory is not code-protected)
+
+// FOSCSEL
+#pragma config FNOSC = FRC              // Oscillator Mode (Internal Fast RC (FRC))
+#pragma config IESO = ON                // Internal External Switch Over Mode (Start-up device with FRC, then automatically switch to user-selected oscillator source when ready)
+
+// FOSC
+#pragma config POSCMD = XT              // Primary Oscillator Source (XT Oscillator Mode)
+#pragma config OSCIOFNC = OFF           // OSC2 Pin Function (OSC2 pin has clock out function)
+#pragma config IOL1WAY = ON             // Peripheral Pin Select Configuration (Allow Only One Re-configuration)
+#pragma config FCKSM = CSECMD           // Clock Switching and Monitor (Clock switching is enabled, Fail-Safe Clock Monitor is disabled)
+
+// FWDT
+#pragma config WDTPOST = PS32768        // Watchdog Timer Postscaler (1:32,768)
+#pragma config WDTPRE = PR128           // WDT Prescaler (1:128)
+#pragma config WINDIS = OFF             // Watchdog Timer Window (Watchdog Timer in Non-Window mode)
+#pragma config FWDTEN = OFF             // Watchdog Timer Enable (Watchdog timer enabled/disabled by user software)
+
+// FPOR
+#pragma config FPWRT = PWR1             // POR Timer Value (Disabled)
+#pragma config ALTI2C = OFF             // Alternate I2C  pins (I2C mapped to SDA1/SCL1 pins)
+#pragma config LPOL = ON                // Motor Control PWM Low Side Polarity bit (PWM module low side output pins have active-high output polarity)
+#pragma config HPOL = ON                // Motor Control PWM High Side Polarity bit (PWM module high side output pins have active-high output polarity)
+#pragma config PWMPIN = ON              // Motor Control PWM Module Pin Mode bit (PWM module pins controlled by PORT register at device Reset)
+
+// FICD
+#pragma config ICS = PGD1               // Comm Channel Select (Communicate on PGC1/EMUC1 and PGD1/EMUD1)
+#pragma config JTAGEN = OFF             // JTAG Port Enable (JTAG is Disabled)
+
+#include "config.h"
+#include "adc.h"
+#include "firpipe.h"
+#include "q15vec.h"
+#include "spectrum.h"
+#include "uart.h"
+#include "metrics.h"
+#include <xc.h>
+#include "dsp.h"
+
+/* Tasa de muestreo de la señal de prueba (square1k: 1 kHz en 20 muestras) */
+#define SAMPLE_RATE_HZ 20000u
+
+/* 20000 / 64 = 312 espectros/s; cada trama son SPEC_BINS * 2 + 8 bytes, así
+   que a 115200 baudios se envía uno de cada 8 (~2.8 kB/s) */
+#define TELEMETRY_BAUD          115200UL
+#define TELEMETRY_SPECTRUM_DIV  8u
+
+/* FIRPIPE_MODE_BLOCK: rendimiento; FIRPIPE_MODE_SAMPLE: latencia de 1 muestra */
+#ifndef FIRPIPE_DEMO_MODE
+#define FIRPIPE_DEMO_MODE FIRPIPE_MODE_BLOCK
+#endif
+
+extern FIRStruct lowpassexampleFilter;          /* _lowpassexampleFilter en lowpassexample.s */
+
+/* Estadísticas visibles desde el depurador (watch) */
+FIRPIPE_Stats_t FirStats;
+SPEC_Stats_t FftStats;
+uint32_t FftPeakHz;
+
+/* Modo muestra: se ejecuta en _ADC1Interrupt con cada salida del filtro */
+static void on_sample(fractional y)
+{
+    fractional v = (y < 0) ? -y : y;
+    LATB = (LATB & 0xFF00) | (uint8_t)((uint16_t)v >> 7);
+}
+
+int main(void)
+{
+    const fractional *out;
+    fractional pico;
+    uint32_t real_rate;
+    uint8_t spec_count = 0;
+    uint32_t metrics_ms;
+
+    SYSTEM_Initialize();         /* PLL a 40 MIPS (clock.c) y RB0..RB7 como salidas */
+
+    /* AN0 (RA0) analógico */
+    AD1PCFGL &= ~(1u << 0);
+    TRISAbits.TRISA0 = 1;
+
+    ADC_Init();
+    FIRPIPE_Init(&lowpassexampleFilter);
+    FIRPIPE_SetMode(FIRPIPE_DEMO_MODE, on_sample);
+    ADC_SetStreamFormat(ADC_FORMAT_FRACTIONAL);   /* bloques Q15 directos al FIR */
+    real_rate = FIRPIPE_Start(0, SAMPLE_RATE_HZ);
+    SPEC_Init();
+    UART_Init(TELEMETRY_BAUD);
+    METRICS_Init();
+    metrics_ms = SYSTEM_GetTickMs();
+
+    while (1)
+    {
+        FIRPIPE_GetStats(&FirStats);
+
+        /* Métricas una vez por segundo, entre bloques */
+        if ((SYSTEM_GetTickMs() - metrics_ms) >= 1000u) {
+            metrics_ms += 1000u;
+            METRICS_Update();
+            METRICS_SendFrame();
+        }
+
+        if (!FIRPIPE_Process()) {
+            continue;
+        }
+
+        /* Pico del bloque filtrado en los LEDs */
+        out = FIRPIPE_GetOutput();
+        pico = Q15_VectorPeak(FIRPIPE_BLOCK_LENGTH, out, 0);
+        LATB = (LATB & 0xFF00) | (uint8_t)((uint16_t)pico >> 7);
+
+        /* Espectro cada SPEC_POINTS muestras filtradas */
+        if (SPEC_AddSamples(out, FIRPIPE_BLOCK_LENGTH)) {
+            FftPeakHz = SPEC_BinToHz(SPEC_PeakBin(0), real_rate);
+            SPEC_GetStats(&FftStats);
+
+            /* Si la cola está llena la trama se descarta (UART_GetStats) */
+            if (++spec_count >= TELEMETRY_SPECTRUM_DIV) {
+                spec_count = 0;
+                UART_SendFrame(UART_FRAME_SPECTRUM, SPEC_GetBins(),
+                               SPEC_BINS * sizeof(fractional));
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* El ADC entrega un bloque cada ADC_STREAM_BLOCK_LENGTH muestras (modo
+   bloque) o una muestra por interrupción (modo muestra) */
+void __attribute__((interrupt, no_auto_psv)) _ADC1Interrupt(void)
+{
+    ADC_ISR_Handler();
+}
+
+/* Telemetría: la cola de TX se vacía por interrupción */
+void __attribute__((interrupt, no_auto_psv)) _U1TXInterrupt(void)
+{
+    UART_TX_ISR_Handler();
+}
+
+void __attribute__((interrupt, no_auto_psv)) _U1RXInterrupt(void)
+{
+    UART_RX_ISR_Handler();
+}
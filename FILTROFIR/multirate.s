@@ -0,0 +1,107 @@
+; ..............................................................................
+;    File   multirate.s
+;
+;    Filtros del banco multitasa (filterbank.h), con la misma disposición que
+;    lowpassexample.s: coeficientes en X, líneas de retardo en Y y estructura
+;    en .data, para que el bucle MAC haga la doble lectura X/Y por ciclo.
+;
+;    Diseño (fs = tasa de entrada de 20 kHz, como _square1k):
+;    - decim4:  FIR 32 taps, Hamming, fc = 0.1 fs (2 kHz), ganancia DC 1.
+;               Para FIRDecimate con R = 4 (32 es múltiplo de R).
+;    - interp4: FIR 32 taps, Hamming, fc = 0.1 fs, ganancia DC 4 (compensa
+;               los ceros insertados; cada fase polifásica suma ~1).
+;               Para FIRInterpolate con R = 4.
+;    - biquad:  Butterworth de 4º orden, 2 secciones, fc = 0.2 fs/4 (1 kHz
+;               tras decimar). Todos los coeficientes |c| < 1: sin escalado.
+; ..............................................................................
+
+                .equ decim4NumTaps, 32
+                .equ interp4NumTaps, 32
+                .equ interp4Rate, 4
+                .equ biquadNumSections, 2
+
+; ..............................................................................
+; Allocate and initialize filter taps
+
+                .section .xdata, data, xmemory
+                .align 64
+
+decim4Taps:
+.hword  0xFFEF, 0x0014, 0x0049, 0x0087, 0x00A4, 0x005B, 0xFF7F, 0xFE2E, 0xFCF1
+.hword  0xFCAE, 0xFE4D, 0x024C, 0x085D, 0x0F57, 0x157D, 0x1918, 0x1918, 0x157D
+.hword  0x0F57, 0x085D, 0x024C, 0xFE4D, 0xFCAE, 0xFCF1, 0xFE2E, 0xFF7F, 0x005B
+.hword  0x00A4, 0x0087, 0x0049, 0x0014, 0xFFEF
+
+                .align 64
+
+interp4Taps:
+.hword  0xFFBE, 0x004F, 0x0125, 0x021E, 0x028E, 0x016C, 0xFDFD, 0xF8B6, 0xF3C6
+.hword  0xF2B9, 0xF935, 0x092F, 0x2174, 0x3D5A, 0x55F3, 0x645F, 0x645F, 0x55F3
+.hword  0x3D5A, 0x2174, 0x092F, 0xF935, 0xF2B9, 0xF3C6, 0xF8B6, 0xFDFD, 0x016C
+.hword  0x028E, 0x021E, 0x0125, 0x004F, 0xFFBE
+
+; Por sección: b0, b1, a1, b2, a2 (a1 y a2 con el signo de la librería:
+; y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2])
+biquadCoefs:
+.hword  0x178A, 0x2F14, 0x2A1C, 0x178A, 0xF7BB
+.hword  0x206C, 0x40D8, 0x3A00, 0x206C, 0xC44F
+
+; ..............................................................................
+; Allocate delay lines in (uninitialized) Y data space
+
+                .section .ydata, data, ymemory
+                .align 64
+
+decim4Delay:
+                .space decim4NumTaps*2
+
+                .align 64
+
+interp4Delay:
+                .space interp4NumTaps*2
+
+biquadDelay1:
+                .space biquadNumSections*2
+biquadDelay2:
+                .space biquadNumSections*2
+
+; ..............................................................................
+; Allocate and intialize filter structures
+
+                .section .data
+                .global _decim4Filter
+                .global _interp4Filter
+                .global _biquadFilter
+
+_decim4Filter:
+.hword decim4NumTaps
+.hword decim4Taps
+.hword decim4Taps+decim4NumTaps*2-1
+.hword 0xff00
+.hword decim4Delay
+.hword decim4Delay+decim4NumTaps*2-1
+.hword decim4Delay
+
+; La línea de retardo del interpolador solo usa numTaps/R palabras
+; (FIRInterpDelayInit), pero se reserva entera para mantener la alineación.
+_interp4Filter:
+.hword interp4NumTaps
+.hword interp4Taps
+.hword interp4Taps+interp4NumTaps*2-1
+.hword 0xff00
+.hword interp4Delay
+.hword interp4Delay+interp4NumTaps*2/interp4Rate-1
+.hword interp4Delay
+
+; IIRTransposedStruct: numSectionsLess1, coeffsBase, coeffsPage,
+; delayBase1, delayBase2, initialGain, finalShift
+_biquadFilter:
+.hword biquadNumSections-1
+.hword biquadCoefs
+.hword 0xff00
+.hword biquadDelay1
+.hword biquadDelay2
+.hword 0x7FFF
+.hword 0
+
+                .end
@@ -0,0 +1,238 @@
+/*
+ * q15ref.c - Modelo de referencia de FIR() y q15vec.s (ver q15ref.h)
+ *
+ * El acumulador es un int64_t con la escala del ACCA: 1.0 = 2^31, 40 bits
+ * útiles (8 de guarda). Cada función hace lo mismo, instrucción a
+ * instrucción, que su versión en ensamblador.
+ */
+
+#include "q15ref.h"
+
+#define Q15REF_ACC_MAX  ((int64_t)549755813887LL)   /* 2^39 - 1 */
+#define Q15REF_ACC_MIN  (-Q15REF_ACC_MAX - 1)
+
+typedef int64_t q15ref_acc_t;
+
+/* SATA + ACCSAT: saturación del acumulador en 9.31 */
+static inline q15ref_acc_t q15ref_sat40(q15ref_acc_t acc)
+{
+    if (acc > Q15REF_ACC_MAX) return Q15REF_ACC_MAX;
+    if (acc < Q15REF_ACC_MIN) return Q15REF_ACC_MIN;
+    return acc;
+}
+
+/* LAC / ADD Ws, A: el dato entra en ACCAH (bits 31..16) */
+static inline q15ref_acc_t q15ref_lac(int16_t x)
+{
+    return (q15ref_acc_t)x * 65536;
+}
+
+/* MPY/MAC con IF = 0: producto fraccional (desplazado un bit) */
+static inline q15ref_acc_t q15ref_mul(int16_t a, int16_t b)
+{
+    return (q15ref_acc_t)((int32_t)a * b) * 2;
+}
+
+/* SFTAC: positivo desplaza a la derecha */
+static inline q15ref_acc_t q15ref_sftac(q15ref_acc_t acc, int16_t shift)
+{
+    if (shift >= 0) {
+        acc >>= shift;
+    } else {
+        acc *= (q15ref_acc_t)1 << (-shift);
+    }
+    return q15ref_sat40(acc);
+}
+
+/* SATDW: fuera de 1.15 se escribe 0x7FFF / 0x8000 */
+static inline int16_t q15ref_sat16(q15ref_acc_t hi)
+{
+    if (hi > 32767) return 32767;
+    if (hi < -32768) return -32768;
+    return (int16_t)hi;
+}
+
+/* SAC: bits 31..16, truncado */
+static inline int16_t q15ref_sac(q15ref_acc_t acc)
+{
+    return q15ref_sat16(acc >> 16);
+}
+
+/* SAC.R con RND = 0: redondeo convergente (empate al par) */
+static inline int16_t q15ref_sac_r(q15ref_acc_t acc)
+{
+    q15ref_acc_t hi = acc >> 16;
+    uint16_t lo = (uint16_t)(acc & 0xFFFF);
+
+    if (lo > 0x8000u || (lo == 0x8000u && (hi & 1))) {
+        hi++;
+    }
+    return q15ref_sat16(hi);
+}
+
+void Q15REF_FirInit(Q15REF_Fir_t *f, const int16_t *taps, int16_t *delay, uint16_t num_taps)
+{
+    uint16_t i;
+
+    f->taps = taps;
+    f->delay = delay;
+    f->num_taps = num_taps;
+    f->index = 0;
+    for (i = 0; i < num_taps; i++) {
+        delay[i] = 0;
+    }
+}
+
+int16_t Q15REF_FirSample(Q15REF_Fir_t *f, int16_t x)
+{
+    q15ref_acc_t acc = 0;
+    uint16_t k, d;
+
+    if (f->num_taps == 0) {
+        return 0;
+    }
+
+    /* Retardo circular: index apunta a x[n], index - k a x[n - k] */
+    f->index = (f->index + 1u < f->num_taps) ? f->index + 1u : 0u;
+    f->delay[f->index] = x;
+
+    d = f->index;
+    for (k = 0; k < f->num_taps; k++) {
+        acc = q15ref_sat40(acc + q15ref_mul(f->taps[k], f->delay[d]));
+        d = (d == 0u) ? f->num_taps - 1u : d - 1u;
+    }
+    return q15ref_sac_r(acc);
+}
+
+void Q15REF_Fir(Q15REF_Fir_t *f, uint16_t n, int16_t *dst, const int16_t *src)
+{
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = Q15REF_FirSample(f, src[i]);
+    }
+}
+
+int16_t *Q15REF_VectorAbs(uint16_t n, int16_t *dst, const int16_t *src)
+{
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        int16_t x = src[i];
+        dst[i] = (x == -32768) ? 32767 : (int16_t)((x < 0) ? -x : x);
+    }
+    return dst;
+}
+
+int16_t *Q15REF_VectorShift(uint16_t n, int16_t *dst, const int16_t *src, int16_t shift)
+{
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = q15ref_sac(q15ref_sftac(q15ref_lac(src[i]), (int16_t)-shift));
+    }
+    return dst;
+}
+
+int16_t *Q15REF_VectorScale(uint16_t n, int16_t *dst, const int16_t *src,
+                            int16_t scale, int16_t shift)
+{
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = q15ref_sac_r(q15ref_sftac(q15ref_mul(src[i], scale), (int16_t)-shift));
+    }
+    return dst;
+}
+
+int16_t *Q15REF_VectorAdd(uint16_t n, int16_t *dst, const int16_t *a, const int16_t *b)
+{
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = q15ref_sac(q15ref_sat40(q15ref_lac(a[i]) + q15ref_lac(b[i])));
+    }
+    return dst;
+}
+
+int16_t Q15REF_DotProduct(uint16_t n, const int16_t *a, const int16_t *b)
+{
+    q15ref_acc_t acc = 0;
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        acc = q15ref_sat40(acc + q15ref_mul(a[i], b[i]));
+    }
+    return q15ref_sac_r(acc);
+}
+
+uint32_t Q15REF_SumSquares(uint16_t n, const int16_t *src, uint16_t shift)
+{
+    q15ref_acc_t acc = 0;
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        acc = q15ref_sat40(acc + q15ref_mul(src[i], src[i]));
+    }
+    /* ACCAH:ACCAL, sin los 8 bits de guarda */
+    return (uint32_t)q15ref_sftac(acc, (int16_t)shift);
+}
+
+int16_t *Q15REF_FromADC(uint16_t n, int16_t *dst, const uint16_t *src, uint16_t bits)
+{
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = (int16_t)((uint16_t)(src[i] << (16u - bits)) ^ 0x8000u);
+    }
+    return dst;
+}
+
+/* Primer máximo de sign * src (sign = -1: mínimo). n = 0: 0 en la posición 0 */
+static int16_t q15ref_select(uint16_t n, const int16_t *src, uint16_t *index, int16_t sign)
+{
+    int16_t best = 0;
+    uint16_t best_i = 0;
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        if (i == 0 || (int32_t)sign * src[i] > (int32_t)sign * best) {
+            best = src[i];
+            best_i = i;
+        }
+    }
+    if (index != 0) {
+        *index = best_i;
+    }
+    return best;
+}
+
+int16_t Q15REF_VectorMax(uint16_t n, const int16_t *src, uint16_t *index)
+{
+    return q15ref_select(n, src, index, 1);
+}
+
+int16_t Q15REF_VectorMin(uint16_t n, const int16_t *src, uint16_t *index)
+{
+    return q15ref_select(n, src, index, -1);
+}
+
+int16_t Q15REF_VectorPeak(uint16_t n, const int16_t *src, uint16_t *index)
+{
+    int16_t best = 0;
+    uint16_t best_i = 0;
+    uint16_t i;
+
+    for (i = 0; i < n; i++) {
+        int16_t x = src[i];
+        int16_t mag = (x == -32768) ? 32767 : (int16_t)((x < 0) ? -x : x);
+        if (mag > best) {
+            best = mag;
+            best_i = i;
+        }
+    }
+    if (index != 0) {
+        *index = best_i;
+    }
+    return best;
+}
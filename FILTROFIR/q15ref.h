@@ -0,0 +1,91 @@
+/*
+ * q15ref.h
+ *
+ * Modelo de referencia en C portable de FIR() (libdsp) y de los núcleos de
+ * q15vec.s: mismos resultados bit a bit, sin motor DSP ni <xc.h>. Se
+ * compila igual con XC16 que con el gcc del PC, así que sirve para:
+ *   - comprobar en el micro (o en MPLAB SIM) que los núcleos en ensamblador
+ *     no cambian de resultado al optimizarlos (benchmain.c lo hace);
+ *   - generar en el PC las salidas esperadas (vectores dorados) de un
+ *     filtro y una entrada: test_q15ref.c filtra _square1k con los taps de
+ *     lowpassexample.s y compara con golden_lowpass_square1k.txt
+ *     ('make test' en FILTROFIR/, 'make golden' para regenerarlo).
+ *
+ * Se emula el acumulador de 40 bits en el modo de q15vec.s: multiplicación
+ * fraccional (IF = 0), saturación de ACCA en 9.31, SAC con saturación a
+ * 0x7FFF / 0x8000 y redondeo convergente en SAC.R. FIR() de libdsp usa el
+ * mismo MAC + SAC.R; con filtros de ganancia normal el acumulador no llega
+ * a saturar y el modo de saturación no influye.
+ *
+ * API (mismo orden de argumentos que q15vec.h):
+ *   void Q15REF_FirInit(f, taps, delay, num_taps);
+ *   int16_t Q15REF_FirSample(f, x);
+ *   void Q15REF_Fir(f, n, dst, src);
+ *   int16_t *Q15REF_VectorAbs(n, dst, src);
+ *   int16_t *Q15REF_VectorShift(n, dst, src, shift);
+ *   int16_t *Q15REF_VectorScale(n, dst, src, scale, shift);
+ *   int16_t *Q15REF_VectorAdd(n, dst, a, b);
+ *   int16_t Q15REF_DotProduct(n, a, b);
+ *   uint32_t Q15REF_SumSquares(n, src, shift);
+ *   int16_t *Q15REF_FromADC(n, dst, adc, bits);
+ *   int16_t Q15REF_VectorMax(n, src, &index);
+ *   int16_t Q15REF_VectorMin(n, src, &index);
+ *   int16_t Q15REF_VectorPeak(n, src, &index);
+ *
+ * USO (cadena ADC -> FIR de firpipe con 'muestras' del ADC a 12 bits):
+ *      static int16_t retardo[75];
+ *      Q15REF_Fir_t ref;
+ *      Q15REF_FirInit(&ref, taps, retardo, 75);
+ *      Q15REF_FromADC(n, bloque, muestras, 12);
+ *      Q15REF_Fir(&ref, n, salida, bloque);
+ *
+ * Nota:
+ * - Lento (entero de 64 bits por MAC): es para verificar, no para el
+ *   camino de la señal.
+ * - 'delay' es un array normal: no necesita alineación ni memoria Y.
+ */
+
+#ifndef Q15REF_H
+#define Q15REF_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const int16_t *taps;     /* h[0..num_taps-1], y[n] = sum h[k] x[n-k] */
+    int16_t *delay;          /* num_taps muestras */
+    uint16_t num_taps;
+    uint16_t index;          /* posición de la muestra más reciente */
+} Q15REF_Fir_t;
+
+/* Deja la línea de retardo a cero (como FIRDelayInit) */
+void Q15REF_FirInit(Q15REF_Fir_t *f, const int16_t *taps, int16_t *delay, uint16_t num_taps);
+
+/* Una muestra de entrada, una de salida (FIR(1, ...)) */
+int16_t Q15REF_FirSample(Q15REF_Fir_t *f, int16_t x);
+
+/* Bloque (FIR(n, dst, src, ...)); dst == src permitido */
+void Q15REF_Fir(Q15REF_Fir_t *f, uint16_t n, int16_t *dst, const int16_t *src);
+
+int16_t *Q15REF_VectorAbs(uint16_t n, int16_t *dst, const int16_t *src);
+int16_t *Q15REF_VectorShift(uint16_t n, int16_t *dst, const int16_t *src, int16_t shift);
+int16_t *Q15REF_VectorScale(uint16_t n, int16_t *dst, const int16_t *src,
+                            int16_t scale, int16_t shift);
+int16_t *Q15REF_VectorAdd(uint16_t n, int16_t *dst, const int16_t *a, const int16_t *b);
+int16_t Q15REF_DotProduct(uint16_t n, const int16_t *a, const int16_t *b);
+uint32_t Q15REF_SumSquares(uint16_t n, const int16_t *src, uint16_t shift);
+int16_t *Q15REF_FromADC(uint16_t n, int16_t *dst, const uint16_t *src, uint16_t bits);
+
+/* Como Q15_VectorMax/Min/Peak: primera posición, index puede ser 0 */
+int16_t Q15REF_VectorMax(uint16_t n, const int16_t *src, uint16_t *index);
+int16_t Q15REF_VectorMin(uint16_t n, const int16_t *src, uint16_t *index);
+int16_t Q15REF_VectorPeak(uint16_t n, const int16_t *src, uint16_t *index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Q15REF_H */
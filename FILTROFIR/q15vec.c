@@ -0,0 +1,54 @@
+/*
+ * q15vec.c
+ *
+ * Parte en C de la librería Q15 (ver q15vec.h): lo que no está en el bucle
+ * interno. Los núcleos por muestra están en q15vec.s.
+ */
+
+#include "q15vec.h"
+
+/* Raíz cuadrada entera de 32 bits, resultado de 16 bits (bit a bit) */
+uint16_t Q15_ISqrt32(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)root;
+}
+
+/* sqrt(mean(x^2)). La suma de cuadrados se hace en el acumulador (SQRAC) y
+   se escala por 2^shift >= n para que quepa en Q31; después la media se
+   pasa a Q30, cuya raíz entera es directamente el resultado en Q15. */
+fractional Q15_RMS(uint16_t n, const fractional *src)
+{
+    uint16_t shift = 0;
+    uint32_t sum;
+    uint32_t mean_q30;
+    uint16_t root;
+
+    if (n == 0 || n > Q15_SUMSQ_MAX_LENGTH) {
+        return 0;
+    }
+
+    while ((1u << shift) < n) {
+        shift++;
+    }
+
+    sum = Q15_SumSquares(n, src, shift);
+    mean_q30 = (uint32_t)((((uint64_t)sum << shift) / n) >> 1);
+
+    root = Q15_ISqrt32(mean_q30);
+    return (fractional)((root > 0x7FFFu) ? 0x7FFFu : root);
+}
@@ -0,0 +1,76 @@
+/*
+ * q15vec.h
+ *
+ * Operaciones vectoriales Q15 escritas para el motor DSP (q15vec.s): bucle
+ * DO sin saltos por muestra, acumulador A de 40 bits con 8 bits de guarda y
+ * saturación en la escritura. Complementan a FIR() y a la librería DSP.
+ *
+ * API (mismo orden de argumentos que libdsp: n, destino, origen...):
+ *   fractional *Q15_VectorAbs(n, dst, src);               // |x|, -1.0 -> 0x7FFF
+ *   fractional *Q15_VectorShift(n, dst, src, shift);      // x * 2^shift saturado
+ *   fractional *Q15_VectorScale(n, dst, src, scale, shift); // x * scale * 2^shift
+ *   fractional *Q15_VectorAdd(n, dst, a, b);              // a + b saturado
+ *   fractional Q15_DotProduct(n, a, b);                   // sum(a * b) saturado
+ *   uint32_t Q15_SumSquares(n, src, shift);               // sum(x^2) / 2^shift, Q31
+ *   fractional Q15_RMS(n, src);                           // sqrt(mean(x^2))
+ *   uint16_t Q15_ISqrt32(v);                              // raíz entera (Q30 -> Q15)
+ *   fractional Q15_VectorMax(n, src, &index);
+ *   fractional Q15_VectorMin(n, src, &index);
+ *   fractional Q15_VectorPeak(n, src, &index);            // max |x|
+ *   fractional *Q15_FromADC(n, dst, adc, bits);           // entero sin signo -> Q15
+ *
+ * Nota:
+ * - Trabajan sobre cualquier buffer en RAM: los bloques de
+ *   ADC_StreamGetBlock() (tras Q15_FromADC, que admite dst == src si el
+ *   bloque es propio) y los fractional de FILTROFIR sin copias intermedias.
+ *   Por ese contrato no se usa la doble precarga X/Y del MAC (pediría el
+ *   segundo operando en memoria Y): Q15_SumSquares precarga por X (1 ciclo
+ *   por muestra) y Q15_DotProduct precarga 'a' por X y carga 'b' con mov
+ *   (2 ciclos por muestra). Para productos largos con 'b' en memoria Y,
+ *   VectorDotProduct() de libdsp hace la doble precarga.
+ * - Todas admiten n = 0 y dst == src.
+ * - Usan el acumulador A y CORCON (que restauran). Si se llaman desde una
+ *   ISR y el bucle principal también usa el DSP, la ISR debe guardar
+ *   ACCA (save(ACCAL, ACCAH, ACCAU)).
+ * - Q15_SumSquares y Q15_RMS admiten hasta n = 256 (rango 9.31 del
+ *   acumulador).
+ */
+
+#ifndef Q15VEC_H
+#define Q15VEC_H
+
+#include <stdint.h>
+#include "dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define Q15_SUMSQ_MAX_LENGTH 256u
+
+fractional *Q15_VectorAbs(uint16_t n, fractional *dst, const fractional *src);
+fractional *Q15_VectorShift(uint16_t n, fractional *dst, const fractional *src, int16_t shift);
+fractional *Q15_VectorScale(uint16_t n, fractional *dst, const fractional *src,
+                            fractional scale, int16_t shift);
+fractional *Q15_VectorAdd(uint16_t n, fractional *dst, const fractional *a, const fractional *b);
+
+fractional Q15_DotProduct(uint16_t n, const fractional *a, const fractional *b);
+uint32_t Q15_SumSquares(uint16_t n, const fractional *src, uint16_t shift);
+fractional Q15_RMS(uint16_t n, const fractional *src);
+
+/* floor(sqrt(v)). Con v en Q30 el resultado queda en Q15 (0..32768) */
+uint16_t Q15_ISqrt32(uint32_t v);
+
+/* Valor y posición (index puede ser 0) */
+fractional Q15_VectorMax(uint16_t n, const fractional *src, uint16_t *index);
+fractional Q15_VectorMin(uint16_t n, const fractional *src, uint16_t *index);
+fractional Q15_VectorPeak(uint16_t n, const fractional *src, uint16_t *index);
+
+/* Resultado del ADC (FORM = 00, 'bits' de resolución) a Q15 con signo */
+fractional *Q15_FromADC(uint16_t n, fractional *dst, const uint16_t *src, uint16_t bits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Q15VEC_H */
@@ -0,0 +1,287 @@
+; ..............................................................................
+;    File   q15vec.s
+;
+;    Núcleos vectoriales Q15 (ver q15vec.h) sobre el motor DSP: bucles DO
+;    sin coste de salto, acumulador A de 40 bits y escritura saturada (SAC
+;    con SATDW). Convención de llamada de XC16: argumentos en w0..w7, valor
+;    de retorno en w0 (w1:w0 si es de 32 bits); w0..w7 y ACCA se pueden
+;    destruir, w8 se guarda en la pila donde se usa.
+;
+;    Todas las funciones aceptan n = 0 y dst == src. Los buffers pueden estar
+;    en cualquier parte de la RAM, así que sirven tal cual para los bloques
+;    del ADC y los fractional de FILTROFIR. Por eso sólo se usa la precarga
+;    X del MAC (w8, llega a toda la memoria de datos): la Y (w10/w11) exige
+;    el operando en memoria Y, y el segundo operando de Q15_DotProduct se
+;    carga con mov. La precarga lee una palabra más allá del final del
+;    buffer (se descarta).
+;
+;    CORCON se guarda en la pila y se restaura al salir.
+; ..............................................................................
+
+                .include "xc.inc"
+
+                .text
+                .global _Q15_VectorAbs
+                .global _Q15_VectorShift
+                .global _Q15_VectorScale
+                .global _Q15_VectorAdd
+                .global _Q15_DotProduct
+                .global _Q15_SumSquares
+                .global _Q15_VectorMax
+                .global _Q15_VectorMin
+                .global _Q15_VectorPeak
+                .global _Q15_FromADC
+
+; ..............................................................................
+; Modo del motor DSP para todo el módulo: fraccional, saturación de ACCA en
+; 9.31 y saturación al escribir (SAC). Destruye nada más que CORCON (apilado).
+
+                .macro  q15_corcon_enter
+                push    CORCON
+                bclr    CORCON, #IF         ; multiplicación fraccional
+                bset    CORCON, #SATA       ; saturación del acumulador A
+                bset    CORCON, #ACCSAT     ; ... en 9.31 (guarda bits)
+                bset    CORCON, #SATDW      ; SAC satura a 0x7FFF / 0x8000
+                bclr    CORCON, #RND        ; redondeo convergente en SAC.R
+                .endm
+
+                .macro  q15_corcon_exit
+                pop     CORCON
+                .endm
+
+; ..............................................................................
+; fractional *Q15_VectorAbs(uint16_t n, fractional *dst, const fractional *src)
+; dst[i] = |src[i]|, -1.0 satura a 0x7FFF. Sin saltos: 6 ciclos por muestra.
+
+_Q15_VectorAbs:
+                mov     w1, w3              ; dst para el retorno
+                cp0     w0
+                bra     z, 1f
+                dec     w0, w0
+                do      w0, 2f
+                mov     [w2++], w4
+                asr     w4, #15, w5         ; 0 o -1 según el signo
+                xor     w4, w5, w4
+                sub     w4, w5, w4          ; |x| (0x8000 sigue siendo 0x8000)
+                asr     w4, #15, w5         ; -1 sólo si quedó 0x8000
+2:              xor     w4, w5, [w1++]      ; 0x8000 -> 0x7FFF
+1:              mov     w3, w0
+                return
+
+; ..............................................................................
+; fractional *Q15_VectorShift(uint16_t n, fractional *dst, const fractional *src,
+;                             int16_t shift)
+; dst[i] = sat(src[i] * 2^shift), -15 <= shift <= 15 (positivo = ganancia).
+
+_Q15_VectorShift:
+                q15_corcon_enter
+                mov     w1, w5
+                neg     w3, w3              ; SFTAC: positivo desplaza a la derecha
+                cp0     w0
+                bra     z, 1f
+                dec     w0, w0
+                do      w0, 2f
+                lac     [w2++], A
+                sftac   A, w3
+2:              sac     A, [w1++]
+1:              mov     w5, w0
+                q15_corcon_exit
+                return
+
+; ..............................................................................
+; fractional *Q15_VectorScale(uint16_t n, fractional *dst, const fractional *src,
+;                             fractional scale, int16_t shift)
+; dst[i] = sat(src[i] * scale * 2^shift) con redondeo. Ganancia total
+; scale * 2^shift: p. ej. 1.5 = 0x6000 con shift = 1.
+
+_Q15_VectorScale:
+                q15_corcon_enter
+                mov     w1, w7
+                mov     w3, w5              ; scale en w5 (operando de MPY)
+                neg     w4, w6
+                cp0     w0
+                bra     z, 1f
+                dec     w0, w0
+                do      w0, 2f
+                mov     [w2++], w4
+                mpy     w4*w5, A
+                sftac   A, w6
+2:              sac.r   A, [w1++]
+1:              mov     w7, w0
+                q15_corcon_exit
+                return
+
+; ..............................................................................
+; fractional *Q15_VectorAdd(uint16_t n, fractional *dst, const fractional *a,
+;                           const fractional *b)
+; dst[i] = sat(a[i] + b[i]).
+
+_Q15_VectorAdd:
+                q15_corcon_enter
+                mov     w1, w5
+                cp0     w0
+                bra     z, 1f
+                dec     w0, w0
+                do      w0, 2f
+                lac     [w2++], A
+                add     [w3++], A
+2:              sac     A, [w1++]
+1:              mov     w5, w0
+                q15_corcon_exit
+                return
+
+; ..............................................................................
+; fractional Q15_DotProduct(uint16_t n, const fractional *a, const fractional *b)
+; sat(sum(a[i] * b[i])). El acumulador tiene 8 bits de guarda: la suma
+; intermedia puede pasar de 1.0 sin desbordar, sólo se satura al final.
+; 'a' llega por la precarga X del MAC: 2 ciclos por muestra.
+
+_Q15_DotProduct:
+                q15_corcon_enter
+                push    w8
+                clr     A
+                cp0     w0
+                bra     z, 1f
+                mov     w1, w8
+                clr     A, [w8]+=2, w4      ; a[0]
+                dec     w0, w0
+                do      w0, 2f
+                mov     [w2++], w5
+2:              mac     w4*w5, A, [w8]+=2, w4
+1:              sac.r   A, w0
+                pop     w8
+                q15_corcon_exit
+                return
+
+; ..............................................................................
+; uint32_t Q15_SumSquares(uint16_t n, const fractional *src, uint16_t shift)
+; sum(src[i]^2) / 2^shift en Q31 (ACCAH:ACCAL). Con 2^shift >= n el resultado
+; no pasa de 1.0 (0x80000000) y cabe en 32 bits sin signo. La suma se
+; acumula en 9.31: con n = 256 sólo satura si todas las muestras son -1.0,
+; y el error es entonces de 1 LSB. REPEAT + SQRAC con precarga X: 1 ciclo
+; por muestra.
+
+_Q15_SumSquares:
+                q15_corcon_enter
+                push    w8
+                clr     A
+                cp0     w0
+                bra     z, 1f
+                mov     w1, w8
+                clr     A, [w8]+=2, w4      ; src[0]
+                dec     w0, w0
+                repeat  w0
+                sqrac   w4*w4, A, [w8]+=2, w4
+1:              sftac   A, w2
+                mov     ACCAL, w0
+                mov     ACCAH, w1
+                pop     w8
+                q15_corcon_exit
+                return
+
+; ..............................................................................
+; fractional Q15_VectorMax(uint16_t n, const fractional *src, uint16_t *index)
+; fractional Q15_VectorMin(uint16_t n, const fractional *src, uint16_t *index)
+; Máximo / mínimo y su posición (la primera si se repite). index puede ser 0.
+; Con n = 0 devuelven 0 e index = 0.
+
+_Q15_VectorMax:
+                clr     w3                  ; mejor valor
+                clr     w4                  ; su índice
+                cp0     w0
+                bra     z, 3f
+                mov     [w1++], w3
+                clr     w5                  ; índice actual
+                dec     w0, w0
+                bra     z, 3f
+                dec     w0, w0
+                do      w0, 2f
+                mov     [w1++], w6
+                inc     w5, w5
+                cp      w6, w3
+                bra     le, 2f
+                mov     w6, w3
+                mov     w5, w4
+2:              nop
+3:              cp0     w2
+                bra     z, 4f
+                mov     w4, [w2]
+4:              mov     w3, w0
+                return
+
+_Q15_VectorMin:
+                clr     w3
+                clr     w4
+                cp0     w0
+                bra     z, 3f
+                mov     [w1++], w3
+                clr     w5
+                dec     w0, w0
+                bra     z, 3f
+                dec     w0, w0
+                do      w0, 2f
+                mov     [w1++], w6
+                inc     w5, w5
+                cp      w6, w3
+                bra     ge, 2f
+                mov     w6, w3
+                mov     w5, w4
+2:              nop
+3:              cp0     w2
+                bra     z, 4f
+                mov     w4, [w2]
+4:              mov     w3, w0
+                return
+
+; ..............................................................................
+; fractional Q15_VectorPeak(uint16_t n, const fractional *src, uint16_t *index)
+; max |src[i]| (saturado a 0x7FFF) y su posición: detector de pico por bloque.
+
+_Q15_VectorPeak:
+                clr     w3
+                clr     w4
+                setm    w5                  ; índice actual (-1: se incrementa antes)
+                cp0     w0
+                bra     z, 3f
+                dec     w0, w0
+                do      w0, 2f
+                mov     [w1++], w6
+                inc     w5, w5
+                asr     w6, #15, w7
+                xor     w6, w7, w6
+                sub     w6, w7, w6
+                asr     w6, #15, w7
+                xor     w6, w7, w6          ; |x| saturado
+                cp      w6, w3
+                bra     le, 2f
+                mov     w6, w3
+                mov     w5, w4
+2:              nop
+3:              cp0     w2
+                bra     z, 4f
+                mov     w4, [w2]
+4:              mov     w3, w0
+                return
+
+; ..............................................................................
+; fractional *Q15_FromADC(uint16_t n, fractional *dst, const uint16_t *src,
+;                         uint16_t bits)
+; Resultado entero sin signo del ADC (FORM = 00, 'bits' de resolución) a Q15
+; con signo: alineado a la izquierda y bit de signo invertido, lo mismo que
+; daría FORM = 11. dst == src permitido (conversión en el propio bloque).
+
+_Q15_FromADC:
+                mov     w1, w5
+                subr    w3, #16, w3         ; desplazamiento = 16 - bits
+                cp0     w0
+                bra     z, 1f
+                dec     w0, w0
+                do      w0, 2f
+                mov     [w2++], w4
+                sl      w4, w3, w4
+                btg     w4, #15
+2:              mov     w4, [w1++]
+1:              mov     w5, w0
+                return
+
+                .end
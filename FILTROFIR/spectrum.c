@@ -0,0 +1,277 @@
+/*
+ * spectrum.c
+ *
+ * Implementación del monitor espectral (ver spectrum.h).
+ *
+ * Uso:
+ *  - Añade libdsp, q15vec.c/q15vec.s y perf.c al proyecto.
+ *  - Llama a SPEC_Init() y entrega bloques con SPEC_AddSamples() o
+ *    SPEC_AddAdcBlock() desde el bucle principal.
+ */
+
+#include "spectrum.h"
+#include "adc.h"     /* formato y resolución del streaming */
+#include "perf.h"
+#include "q15vec.h"
+#include <xc.h>
+
+/* --------------------------------------------------------------------------
+ * Tablas en memoria de programa (PSV)
+ *
+ * spec_twiddle: W^k = cos(2 pi k / N) - j sin(2 pi k / N), k = 0 .. N/2 - 1,
+ * el mismo contenido que TwidFactorInit(log2N, tw, 0) dejaría en RAM.
+ * spec_window: Hann periódica w[n] = 0.5 (1 - cos(2 pi n / N)) para
+ * n = 0 .. N/2; la otra mitad es simétrica (w[N - n] = w[n]).
+ * ------------------------------------------------------------------------ */
+
+#if SPEC_POINTS == 64
+
+static const fractcomplex spec_twiddle[SPEC_POINTS / 2]
+    __attribute__((space(auto_psv), aligned(SPEC_POINTS * 2))) = {
+    { 0x7FFF, 0x0000 }, { 0x7F62, 0xF374 }, { 0x7D8A, 0xE707 }, { 0x7A7D, 0xDAD8 },
+    { 0x7642, 0xCF04 }, { 0x70E3, 0xC3A9 }, { 0x6A6E, 0xB8E3 }, { 0x62F2, 0xAECC },
+    { 0x5A82, 0xA57E }, { 0x5134, 0x9D0E }, { 0x471D, 0x9592 }, { 0x3C57, 0x8F1D },
+    { 0x30FC, 0x89BE }, { 0x2528, 0x8583 }, { 0x18F9, 0x8276 }, { 0x0C8C, 0x809E },
+    { 0x0000, 0x8000 }, { 0xF374, 0x809E }, { 0xE707, 0x8276 }, { 0xDAD8, 0x8583 },
+    { 0xCF04, 0x89BE }, { 0xC3A9, 0x8F1D }, { 0xB8E3, 0x9592 }, { 0xAECC, 0x9D0E },
+    { 0xA57E, 0xA57E }, { 0x9D0E, 0xAECC }, { 0x9592, 0xB8E3 }, { 0x8F1D, 0xC3A9 },
+    { 0x89BE, 0xCF04 }, { 0x8583, 0xDAD8 }, { 0x8276, 0xE707 }, { 0x809E, 0xF374 }
+};
+
+static const fractional spec_window[SPEC_POINTS / 2 + 1] __attribute__((space(auto_psv))) = {
+    0x0000, 0x004F, 0x013B, 0x02C1, 0x04DF, 0x078F, 0x0AC9, 0x0E87,
+    0x12BF, 0x1766, 0x1C72, 0x21D5, 0x2782, 0x2D6C, 0x3384, 0x39BA,
+    0x4000, 0x4646, 0x4C7C, 0x5294, 0x587E, 0x5E2B, 0x638E, 0x689A,
+    0x6D41, 0x7179, 0x7537, 0x7871, 0x7B21, 0x7D3F, 0x7EC5, 0x7FB1,
+    0x7FFF
+};
+
+#elif SPEC_POINTS == 128
+
+static const fractcomplex spec_twiddle[SPEC_POINTS / 2]
+    __attribute__((space(auto_psv), aligned(SPEC_POINTS * 2))) = {
+    { 0x7FFF, 0x0000 }, { 0x7FD9, 0xF9B8 }, { 0x7F62, 0xF374 }, { 0x7E9D, 0xED38 },
+    { 0x7D8A, 0xE707 }, { 0x7C2A, 0xE0E6 }, { 0x7A7D, 0xDAD8 }, { 0x7885, 0xD4E1 },
+    { 0x7642, 0xCF04 }, { 0x73B6, 0xC946 }, { 0x70E3, 0xC3A9 }, { 0x6DCA, 0xBE32 },
+    { 0x6A6E, 0xB8E3 }, { 0x66D0, 0xB3C0 }, { 0x62F2, 0xAECC }, { 0x5ED7, 0xAA0A },
+    { 0x5A82, 0xA57E }, { 0x55F6, 0xA129 }, { 0x5134, 0x9D0E }, { 0x4C40, 0x9930 },
+    { 0x471D, 0x9592 }, { 0x41CE, 0x9236 }, { 0x3C57, 0x8F1D }, { 0x36BA, 0x8C4A },
+    { 0x30FC, 0x89BE }, { 0x2B1F, 0x877B }, { 0x2528, 0x8583 }, { 0x1F1A, 0x83D6 },
+    { 0x18F9, 0x8276 }, { 0x12C8, 0x8163 }, { 0x0C8C, 0x809E }, { 0x0648, 0x8027 },
+    { 0x0000, 0x8000 }, { 0xF9B8, 0x8027 }, { 0xF374, 0x809E }, { 0xED38, 0x8163 },
+    { 0xE707, 0x8276 }, { 0xE0E6, 0x83D6 }, { 0xDAD8, 0x8583 }, { 0xD4E1, 0x877B },
+    { 0xCF04, 0x89BE }, { 0xC946, 0x8C4A }, { 0xC3A9, 0x8F1D }, { 0xBE32, 0x9236 },
+    { 0xB8E3, 0x9592 }, { 0xB3C0, 0x9930 }, { 0xAECC, 0x9D0E }, { 0xAA0A, 0xA129 },
+    { 0xA57E, 0xA57E }, { 0xA129, 0xAA0A }, { 0x9D0E, 0xAECC }, { 0x9930, 0xB3C0 },
+    { 0x9592, 0xB8E3 }, { 0x9236, 0xBE32 }, { 0x8F1D, 0xC3A9 }, { 0x8C4A, 0xC946 },
+    { 0x89BE, 0xCF04 }, { 0x877B, 0xD4E1 }, { 0x8583, 0xDAD8 }, { 0x83D6, 0xE0E6 },
+    { 0x8276, 0xE707 }, { 0x8163, 0xED38 }, { 0x809E, 0xF374 }, { 0x8027, 0xF9B8 }
+};
+
+static const fractional spec_window[SPEC_POINTS / 2 + 1] __attribute__((space(auto_psv))) = {
+    0x0000, 0x0014, 0x004F, 0x00B1, 0x013B, 0x01EB, 0x02C1, 0x03BE,
+    0x04DF, 0x0625, 0x078F, 0x091B, 0x0AC9, 0x0C98, 0x0E87, 0x1094,
+    0x12BF, 0x1505, 0x1766, 0x19E0, 0x1C72, 0x1F19, 0x21D5, 0x24A3,
+    0x2782, 0x2A70, 0x2D6C, 0x3073, 0x3384, 0x369C, 0x39BA, 0x3CDC,
+    0x4000, 0x4324, 0x4646, 0x4964, 0x4C7C, 0x4F8D, 0x5294, 0x5590,
+    0x587E, 0x5B5D, 0x5E2B, 0x60E7, 0x638E, 0x6620, 0x689A, 0x6AFB,
+    0x6D41, 0x6F6C, 0x7179, 0x7368, 0x7537, 0x76E5, 0x7871, 0x79DB,
+    0x7B21, 0x7C42, 0x7D3F, 0x7E15, 0x7EC5, 0x7F4F, 0x7FB1, 0x7FEC,
+    0x7FFF
+};
+
+#elif SPEC_POINTS == 256
+
+static const fractcomplex spec_twiddle[SPEC_POINTS / 2]
+    __attribute__((space(auto_psv), aligned(SPEC_POINTS * 2))) = {
+    { 0x7FFF, 0x0000 }, { 0x7FF6, 0xFCDC }, { 0x7FD9, 0xF9B8 }, { 0x7FA7, 0xF695 },
+    { 0x7F62, 0xF374 }, { 0x7F0A, 0xF055 }, { 0x7E9D, 0xED38 }, { 0x7E1E, 0xEA1E },
+    { 0x7D8A, 0xE707 }, { 0x7CE4, 0xE3F4 }, { 0x7C2A, 0xE0E6 }, { 0x7B5D, 0xDDDC },
+    { 0x7A7D, 0xDAD8 }, { 0x798A, 0xD7D9 }, { 0x7885, 0xD4E1 }, { 0x776C, 0xD1EF },
+    { 0x7642, 0xCF04 }, { 0x7505, 0xCC21 }, { 0x73B6, 0xC946 }, { 0x7255, 0xC673 },
+    { 0x70E3, 0xC3A9 }, { 0x6F5F, 0xC0E9 }, { 0x6DCA, 0xBE32 }, { 0x6C24, 0xBB85 },
+    { 0x6A6E, 0xB8E3 }, { 0x68A7, 0xB64C }, { 0x66D0, 0xB3C0 }, { 0x64E9, 0xB140 },
+    { 0x62F2, 0xAECC }, { 0x60EC, 0xAC65 }, { 0x5ED7, 0xAA0A }, { 0x5CB4, 0xA7BD },
+    { 0x5A82, 0xA57E }, { 0x5843, 0xA34C }, { 0x55F6, 0xA129 }, { 0x539B, 0x9F14 },
+    { 0x5134, 0x9D0E }, { 0x4EC0, 0x9B17 }, { 0x4C40, 0x9930 }, { 0x49B4, 0x9759 },
+    { 0x471D, 0x9592 }, { 0x447B, 0x93DC }, { 0x41CE, 0x9236 }, { 0x3F17, 0x90A1 },
+    { 0x3C57, 0x8F1D }, { 0x398D, 0x8DAB }, { 0x36BA, 0x8C4A }, { 0x33DF, 0x8AFB },
+    { 0x30FC, 0x89BE }, { 0x2E11, 0x8894 }, { 0x2B1F, 0x877B }, { 0x2827, 0x8676 },
+    { 0x2528, 0x8583 }, { 0x2224, 0x84A3 }, { 0x1F1A, 0x83D6 }, { 0x1C0C, 0x831C },
+    { 0x18F9, 0x8276 }, { 0x15E2, 0x81E2 }, { 0x12C8, 0x8163 }, { 0x0FAB, 0x80F6 },
+    { 0x0C8C, 0x809E }, { 0x096B, 0x8059 }, { 0x0648, 0x8027 }, { 0x0324, 0x800A },
+    { 0x0000, 0x8000 }, { 0xFCDC, 0x800A }, { 0xF9B8, 0x8027 }, { 0xF695, 0x8059 },
+    { 0xF374, 0x809E }, { 0xF055, 0x80F6 }, { 0xED38, 0x8163 }, { 0xEA1E, 0x81E2 },
+    { 0xE707, 0x8276 }, { 0xE3F4, 0x831C }, { 0xE0E6, 0x83D6 }, { 0xDDDC, 0x84A3 },
+    { 0xDAD8, 0x8583 }, { 0xD7D9, 0x8676 }, { 0xD4E1, 0x877B }, { 0xD1EF, 0x8894 },
+    { 0xCF04, 0x89BE }, { 0xCC21, 0x8AFB }, { 0xC946, 0x8C4A }, { 0xC673, 0x8DAB },
+    { 0xC3A9, 0x8F1D }, { 0xC0E9, 0x90A1 }, { 0xBE32, 0x9236 }, { 0xBB85, 0x93DC },
+    { 0xB8E3, 0x9592 }, { 0xB64C, 0x9759 }, { 0xB3C0, 0x9930 }, { 0xB140, 0x9B17 },
+    { 0xAECC, 0x9D0E }, { 0xAC65, 0x9F14 }, { 0xAA0A, 0xA129 }, { 0xA7BD, 0xA34C },
+    { 0xA57E, 0xA57E }, { 0xA34C, 0xA7BD }, { 0xA129, 0xAA0A }, { 0x9F14, 0xAC65 },
+    { 0x9D0E, 0xAECC }, { 0x9B17, 0xB140 }, { 0x9930, 0xB3C0 }, { 0x9759, 0xB64C },
+    { 0x9592, 0xB8E3 }, { 0x93DC, 0xBB85 }, { 0x9236, 0xBE32 }, { 0x90A1, 0xC0E9 },
+    { 0x8F1D, 0xC3A9 }, { 0x8DAB, 0xC673 }, { 0x8C4A, 0xC946 }, { 0x8AFB, 0xCC21 },
+    { 0x89BE, 0xCF04 }, { 0x8894, 0xD1EF }, { 0x877B, 0xD4E1 }, { 0x8676, 0xD7D9 },
+    { 0x8583, 0xDAD8 }, { 0x84A3, 0xDDDC }, { 0x83D6, 0xE0E6 }, { 0x831C, 0xE3F4 },
+    { 0x8276, 0xE707 }, { 0x81E2, 0xEA1E }, { 0x8163, 0xED38 }, { 0x80F6, 0xF055 },
+    { 0x809E, 0xF374 }, { 0x8059, 0xF695 }, { 0x8027, 0xF9B8 }, { 0x800A, 0xFCDC }
+};
+
+static const fractional spec_window[SPEC_POINTS / 2 + 1] __attribute__((space(auto_psv))) = {
+    0x0000, 0x0005, 0x0014, 0x002C, 0x004F, 0x007B, 0x00B1, 0x00F1,
+    0x013B, 0x018E, 0x01EB, 0x0251, 0x02C1, 0x033B, 0x03BE, 0x044A,
+    0x04DF, 0x057E, 0x0625, 0x06D5, 0x078F, 0x0850, 0x091B, 0x09EE,
+    0x0AC9, 0x0BAD, 0x0C98, 0x0D8C, 0x0E87, 0x0F8A, 0x1094, 0x11A6,
+    0x12BF, 0x13DF, 0x1505, 0x1632, 0x1766, 0x18A0, 0x19E0, 0x1B26,
+    0x1C72, 0x1DC3, 0x1F19, 0x2074, 0x21D5, 0x233A, 0x24A3, 0x2611,
+    0x2782, 0x28F7, 0x2A70, 0x2BED, 0x2D6C, 0x2EEE, 0x3073, 0x31FA,
+    0x3384, 0x350F, 0x369C, 0x382A, 0x39BA, 0x3B4B, 0x3CDC, 0x3E6E,
+    0x4000, 0x4192, 0x4324, 0x44B5, 0x4646, 0x47D6, 0x4964, 0x4AF1,
+    0x4C7C, 0x4E06, 0x4F8D, 0x5112, 0x5294, 0x5413, 0x5590, 0x5709,
+    0x587E, 0x59EF, 0x5B5D, 0x5CC6, 0x5E2B, 0x5F8C, 0x60E7, 0x623D,
+    0x638E, 0x64DA, 0x6620, 0x6760, 0x689A, 0x69CE, 0x6AFB, 0x6C21,
+    0x6D41, 0x6E5A, 0x6F6C, 0x7076, 0x7179, 0x7274, 0x7368, 0x7453,
+    0x7537, 0x7612, 0x76E5, 0x77B0, 0x7871, 0x792B, 0x79DB, 0x7A82,
+    0x7B21, 0x7BB6, 0x7C42, 0x7CC5, 0x7D3F, 0x7DAF, 0x7E15, 0x7E72,
+    0x7EC5, 0x7F0F, 0x7F4F, 0x7F85, 0x7FB1, 0x7FD4, 0x7FEC, 0x7FFB,
+    0x7FFF
+};
+
+#endif
+
+/* Internals */
+
+/* Buffer complejo de la FFT in situ: memoria Y, alineado a su tamaño para
+   el direccionamiento bit-reverso de BitReverseComplex */
+static fractcomplex spec_buf[SPEC_POINTS]
+    __attribute__((space(ymemory), aligned(SPEC_POINTS * 2 * 2)));
+
+static fractional spec_bins[SPEC_BINS];
+static uint16_t spec_pos = 0;            /* muestras en la trama en curso */
+static bool spec_valid = false;
+static SPEC_Stats_t spec_stats;
+
+static fractional spec_window_at(uint16_t n)
+{
+    return (n <= SPEC_POINTS / 2u) ? spec_window[n] : spec_window[SPEC_POINTS - n];
+}
+
+/* Trama completa: FFT, reordenado y módulo. Las muestras ya tienen la
+   ventana aplicada (SPEC_AddSamples). */
+static void spec_compute(void)
+{
+    PERF_Cycles_t t0 = PERF_Now();
+    uint16_t k;
+
+    FFTComplexIP(SPEC_LOG2_POINTS, &spec_buf[0],
+                 (fractcomplex *)__builtin_psvoffset(&spec_twiddle[0]),
+                 (int)__builtin_psvpage(&spec_twiddle[0]));
+    BitReverseComplex(SPEC_LOG2_POINTS, &spec_buf[0]);
+
+    /* |X|^2 en Q15 y raíz: sqrt(p * 2^15) = |X| en Q15 */
+    SquareMagnitudeCplx(SPEC_BINS, &spec_buf[0], &spec_bins[0]);
+    for (k = 0; k < SPEC_BINS; k++) {
+        uint16_t m = Q15_ISqrt32((uint32_t)(uint16_t)spec_bins[k] << 15);
+        spec_bins[k] = (fractional)((m > 0x7FFFu) ? 0x7FFFu : m);
+    }
+
+    spec_valid = true;
+    spec_stats.frames++;
+    spec_stats.last_cycles = PERF_Elapsed(t0) - PERF_GetOverhead();
+}
+
+void SPEC_Init(void)
+{
+    spec_pos = 0;
+    spec_valid = false;
+    spec_stats.frames = 0;
+    spec_stats.last_cycles = 0;
+}
+
+bool SPEC_AddSamples(const fractional *x, uint16_t length)
+{
+    bool done = false;
+    uint16_t i;
+
+    if (x == 0) {
+        return false;
+    }
+
+    for (i = 0; i < length; i++) {
+        fractional w = spec_window_at(spec_pos);
+
+        spec_buf[spec_pos].real = (fractional)(((int32_t)x[i] * w) >> 15);
+        spec_buf[spec_pos].imag = 0;
+
+        if (++spec_pos == SPEC_POINTS) {
+            spec_compute();
+            spec_pos = 0;
+            done = true;
+        }
+    }
+
+    return done;
+}
+
+/* Conversión a Q15 por tramos para no necesitar un segundo buffer del
+   tamaño del bloque */
+bool SPEC_AddAdcBlock(const uint16_t *block, uint16_t length)
+{
+    fractional tmp[ADC_STREAM_HALF_LENGTH];
+    bool done = false;
+
+    if (block == 0) {
+        return false;
+    }
+
+    /* Con FORM = 11 el bloque ya es Q15 */
+    if (ADC_GetStreamFormat() == ADC_FORMAT_FRACTIONAL) {
+        return SPEC_AddSamples((const fractional *)block, length);
+    }
+
+    while (length > 0) {
+        uint16_t n = (length < ADC_STREAM_HALF_LENGTH) ? length : ADC_STREAM_HALF_LENGTH;
+
+        Q15_FromADC(n, &tmp[0], block, ADC_StreamGetResolutionBits());
+        if (SPEC_AddSamples(&tmp[0], n)) {
+            done = true;
+        }
+        block += n;
+        length -= n;
+    }
+
+    return done;
+}
+
+const fractional *SPEC_GetBins(void)
+{
+    return spec_valid ? spec_bins : 0;
+}
+
+uint16_t SPEC_PeakBin(fractional *magnitude)
+{
+    uint16_t index = 0;
+    fractional peak = 0;
+
+    if (spec_valid) {
+        peak = Q15_VectorMax(SPEC_BINS - 1u, &spec_bins[1], &index);
+        index++;
+    }
+    if (magnitude) {
+        *magnitude = peak;
+    }
+    return spec_valid ? index : 0;
+}
+
+uint32_t SPEC_BinToHz(uint16_t bin, uint32_t sample_rate_hz)
+{
+    return ((uint32_t)bin * sample_rate_hz) >> SPEC_LOG2_POINTS;
+}
+
+void SPEC_GetStats(SPEC_Stats_t *stats)
+{
+    if (stats) {
+        *stats = spec_stats;
+    }
+}
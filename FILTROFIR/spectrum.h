@@ -0,0 +1,101 @@
+/*
+ * spectrum.h
+ *
+ * Monitor espectral por FFT en coma fija sobre la librería DSP.
+ *
+ * Recoge SPEC_POINTS muestras Q15 (bloques del ADC o la salida de firpipe),
+ * aplica una ventana de Hann y calcula la FFT compleja radix-2 in situ
+ * (FFTComplexIP), el reordenado con direccionamiento bit-reverso por
+ * hardware (BitReverseComplex) y el módulo de los SPEC_POINTS / 2 bins
+ * útiles. Así el espectro de vibración o de corriente se obtiene en el
+ * propio micro, sin sacar las muestras en bruto.
+ *
+ * Los factores de giro y la ventana están precalculados en memoria de
+ * programa (PSV): no ocupan RAM ni tiempo de inicialización. En RAM sólo
+ * queda el buffer complejo (en memoria Y, como exige FFTComplexIP) y los
+ * bins de salida.
+ *
+ * API:
+ *   void SPEC_Init(void);
+ *   bool SPEC_AddSamples(const fractional *x, uint16_t length);  // true: espectro nuevo
+ *   bool SPEC_AddAdcBlock(const uint16_t *block, uint16_t length);
+ *   const fractional *SPEC_GetBins(void);        // SPEC_BINS módulos Q15
+ *   uint16_t SPEC_PeakBin(fractional *magnitude);
+ *   uint32_t SPEC_BinToHz(uint16_t bin, uint32_t sample_rate_hz);
+ *   void SPEC_GetStats(SPEC_Stats_t *stats);
+ *
+ * USO (detrás del pipeline FIR):
+ *      SPEC_Init();
+ *      ...
+ *      if (FIRPIPE_Process() &&
+ *          SPEC_AddSamples(FIRPIPE_GetOutput(), FIRPIPE_BLOCK_LENGTH)) {
+ *          bin = SPEC_PeakBin(&mag);
+ *          f = SPEC_BinToHz(bin, real_rate);
+ *      }
+ *
+ * Nota:
+ * - SPEC_POINTS se elige al compilar (64, 128 o 256). El buffer complejo
+ *   ocupa SPEC_POINTS * 4 bytes de memoria Y alineados a su tamaño: 256
+ *   puntos llenan toda la memoria Y del dsPIC33FJ32MC204, así que sólo es
+ *   viable sin otros filtros con la línea de retardo en Y.
+ * - FFTComplexIP divide por 2 en cada etapa (escala total 1/N) y la ventana
+ *   de Hann tiene ganancia coherente 0.5: una senoidal de amplitud A en el
+ *   centro de un bin da un módulo de A / 4 en ese bin.
+ * - El cálculo se hace dentro de la llamada que completa la trama (contexto
+ *   del llamador). Llamar desde el bucle principal, no desde una ISR.
+ */
+
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Puntos de la FFT: 2^SPEC_LOG2_POINTS, de 6 (64) a 8 (256) */
+#ifndef SPEC_LOG2_POINTS
+#define SPEC_LOG2_POINTS 6
+#endif
+
+#if SPEC_LOG2_POINTS < 6 || SPEC_LOG2_POINTS > 8
+#error "SPEC_LOG2_POINTS debe estar entre 6 (64 puntos) y 8 (256 puntos)"
+#endif
+
+#define SPEC_POINTS (1u << SPEC_LOG2_POINTS)
+#define SPEC_BINS   (SPEC_POINTS / 2u)    /* de 0 a fs/2 (sin incluir) */
+
+typedef struct {
+    uint32_t frames;         /* espectros calculados */
+    uint32_t last_cycles;    /* ventana + FFT + módulo del último (perf.h) */
+} SPEC_Stats_t;
+
+void SPEC_Init(void);
+
+/* Añade muestras a la trama en curso. Cuando se completan SPEC_POINTS
+   calcula el espectro y devuelve true; las muestras sobrantes del bloque
+   empiezan la trama siguiente. */
+bool SPEC_AddSamples(const fractional *x, uint16_t length);
+
+/* Igual, con un bloque entero del ADC (ADC_StreamGetBlock) */
+bool SPEC_AddAdcBlock(const uint16_t *block, uint16_t length);
+
+/* Módulo de los SPEC_BINS bins del último espectro (0 si aún no hay) */
+const fractional *SPEC_GetBins(void);
+
+/* Bin de mayor módulo sin contar la continua (bin 0). magnitude puede ser 0 */
+uint16_t SPEC_PeakBin(fractional *magnitude);
+
+/* Frecuencia central de un bin */
+uint32_t SPEC_BinToHz(uint16_t bin, uint32_t sample_rate_hz);
+
+void SPEC_GetStats(SPEC_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPECTRUM_H */
@@ -0,0 +1,520 @@
+/*
+ * test_q15ref.c - Prueba en el PC del modelo de referencia (q15ref.h)
+ *
+ * Lee los taps de lowpassexample.s y la señal _square1k de
+ * inputsignal_square1khz.s (las mismas .hword que enlaza el proyecto),
+ * filtra con Q15REF_Fir y compara con la salida guardada en
+ * golden_lowpass_square1k.txt. Un cambio en el modelo, en los taps o en
+ * la señal de prueba sale aquí antes de grabar el micro; benchmain.c
+ * compara después FIR() y q15vec.s con el mismo modelo en la placa.
+ *
+ * Además de la comparación con el fichero dorado:
+ *   - nº de taps = lowpassexampleNumTaps (.equ) y 256 muestras de entrada;
+ *   - taps simétricos (fase lineal, como los genera dsPIC Filter Design);
+ *   - cada salida a 1 LSB como mucho del cálculo exacto con enteros de
+ *     64 bits y saturación a 1.15 (el redondeo convergente de SAC.R es la
+ *     única diferencia posible), así que el fichero dorado no puede fijar
+ *     un error del modelo;
+ *   - modo bloque in-place (dst == src) y muestra a muestra: mismo
+ *     resultado; Q15REF_DotProduct y Q15REF_SumSquares frente al dorado y
+ *     frente al cálculo exacto;
+ *   - bloque a bloque (1, 7, 64, 75 y 100 muestras) igual que de una vez:
+ *     la línea de retardo pasa de un bloque al siguiente. Reiniciándola en
+ *     cada bloque la salida tiene que cambiar, o la prueba no vería nada;
+ *   - la cadena de firpipe: _square1k como ADC de 12 bits, bloques de
+ *     TEST_ADC_BLOCK muestras, Q15REF_FromADC y Q15REF_Fir, frente al
+ *     cálculo exacto con la entrada cuantizada;
+ *   - abs, shift, scale, add, max, min, peak y FromADC con vectores de
+ *     casos límite (saturación, -1.0, redondeo convergente, primera
+ *     posición, n = 0) y resultados escritos a mano, no del modelo.
+ *
+ * USO (make test en FILTROFIR/):
+ *      test_q15ref lowpassexample.s inputsignal_square1khz.s golden_lowpass_square1k.txt
+ *      test_q15ref -g lowpassexample.s inputsignal_square1khz.s > golden_lowpass_square1k.txt
+ *
+ * Con -g escribe el fichero dorado: sólo para un cambio intencionado del
+ * filtro o de la señal, revisando el diff.
+ */
+
+#include "q15ref.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_MAX_WORDS   512u
+#define TEST_NUM_SAMPLES 256u
+#define TEST_LINE        256u
+#define TEST_ADC_BLOCK   64u    /* ADC_STREAM_BLOCK_LENGTH por defecto */
+#define TEST_ADC_BITS    12u
+
+static int test_failures = 0;
+
+static void test_fail(const char *what)
+{
+    printf("FALLO: %s\n", what);
+    test_failures++;
+}
+
+/* Quita el comentario ';' y los blancos del principio */
+static char *test_strip(char *line)
+{
+    char *c = strchr(line, ';');
+
+    if (c != 0) {
+        *c = '\0';
+    }
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    return line;
+}
+
+/* Palabras de las .hword que siguen a 'label' hasta la primera línea que
+   no lo es. Devuelve el número leído o -1 si no se encuentra la etiqueta. */
+static int test_read_hwords(const char *path, const char *label,
+                            int16_t *words, unsigned max_words)
+{
+    char line[TEST_LINE];
+    FILE *f = fopen(path, "r");
+    int found = 0;
+    unsigned n = 0;
+
+    if (f == 0) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f) != 0) {
+        char *p = test_strip(line);
+        size_t len = strlen(label);
+
+        if (!found) {
+            found = (strncmp(p, label, len) == 0 && p[len] == ':');
+            continue;
+        }
+        if (strncmp(p, ".hword", 6) != 0) {
+            if (n > 0) {
+                break;
+            }
+            continue;
+        }
+        for (p = strtok(p + 6, ", \t\r\n"); p != 0; p = strtok(0, ", \t\r\n")) {
+            if (n == max_words) {
+                fclose(f);
+                return -1;
+            }
+            words[n++] = (int16_t)(uint16_t)strtoul(p, 0, 0);
+        }
+    }
+
+    fclose(f);
+    return found ? (int)n : -1;
+}
+
+/* Valor de '.equ name, valor' o -1 */
+static long test_read_equ(const char *path, const char *name)
+{
+    char line[TEST_LINE];
+    FILE *f = fopen(path, "r");
+    long value = -1;
+
+    if (f == 0) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f) != 0) {
+        char *p = test_strip(line);
+        size_t len = strlen(name);
+
+        if (strncmp(p, ".equ", 4) != 0) {
+            continue;
+        }
+        p += 4;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (strncmp(p, name, len) == 0 && p[len] == ',') {
+            value = strtol(p + len + 1, 0, 0);
+            break;
+        }
+    }
+
+    fclose(f);
+    return value;
+}
+
+/* Fichero dorado: una palabra hexadecimal por línea, '#' comenta */
+static int test_read_golden(const char *path, uint16_t *words, unsigned max_words)
+{
+    char line[TEST_LINE];
+    FILE *f = fopen(path, "r");
+    unsigned n = 0;
+
+    if (f == 0) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f) != 0) {
+        char *p = test_strip(line);
+
+        if (*p == '#' || *p == '\r' || *p == '\n' || *p == '\0') {
+            continue;
+        }
+        if (n == max_words) {
+            fclose(f);
+            return -1;
+        }
+        words[n++] = (uint16_t)strtoul(p, 0, 16);
+    }
+
+    fclose(f);
+    return (int)n;
+}
+
+/* y[n] exacto en LSB de Q15 (sum h x / 2^15) con la saturación de SATDW */
+static long test_exact(const int16_t *taps, unsigned num_taps, const int16_t *x, unsigned n)
+{
+    long long acc = 0;
+    unsigned k;
+    long y;
+
+    for (k = 0; k < num_taps && k <= n; k++) {
+        acc += (long long)taps[k] * x[n - k];
+    }
+    /* Redondeo al más cercano: el convergente difiere como mucho en 1 */
+    y = (long)((acc + 16384) >> 15);
+    if (y > 32767) y = 32767;
+    if (y < -32768) y = -32768;
+    return y;
+}
+
+static void test_expect(const char *what, long got, long expected)
+{
+    if (got != expected) {
+        printf("%s: %ld, esperado %ld\n", what, got, expected);
+        test_fail(what);
+    }
+}
+
+static void test_expect_vector(const char *what, const int16_t *got,
+                               const int16_t *expected, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        if (got[i] != expected[i]) {
+            printf("%s[%u]: %d, esperado %d\n", what, i, got[i], expected[i]);
+            test_fail(what);
+            return;
+        }
+    }
+}
+
+#define TEST_LEN(a) ((uint16_t)(sizeof(a) / sizeof((a)[0])))
+
+/* Núcleos de q15vec.h que usa la cadena (abs, shift, scale, add, max, min,
+   peak, FromADC) con resultados calculados a mano */
+static void test_vector_helpers(void)
+{
+    static const int16_t abs_in[] = { 0, 1, -1, 32767, -32767, -32768, 0x4000, -0x4000 };
+    static const int16_t abs_out[] = { 0, 1, 1, 32767, 32767, 32767, 0x4000, 0x4000 };
+    static const int16_t shl_in[] = { 0x3FFF, 0x4000, -0x4000, -0x4001, -1, 1 };
+    static const int16_t shl_out[] = { 0x7FFE, 0x7FFF, -0x8000, -0x8000, -2, 2 };
+    /* Hacia la derecha SAC trunca: redondeo hacia -infinito */
+    static const int16_t shr_in[] = { 3, -3, -1, 1, -32768, 32767 };
+    static const int16_t shr_out[] = { 1, -2, -1, 0, -16384, 16383 };
+    /* x * 0.75 * 2: 1.5 satura; x * 0.5 con SAC.R convergente */
+    static const int16_t scl_in[] = { 0x4000, 0x7FFF, -0x8000 };
+    static const int16_t scl_out[] = { 0x6000, 0x7FFF, -0x8000 };
+    static const int16_t half_in[] = { 1, 3, 5, -1, -3 };
+    static const int16_t half_out[] = { 0, 2, 2, 0, -2 };
+    static const int16_t add_a[] = { 0x7000, -0x7000, 100, 0x7FFF, -0x8000 };
+    static const int16_t add_b[] = { 0x7000, -0x7000, -50, 1, 0x7FFF };
+    static const int16_t add_out[] = { 0x7FFF, -0x8000, 50, 0x7FFF, -1 };
+    static const int16_t sel[] = { -5, 12, 3, 12, -32768, 7, -12 };
+    static const int16_t peak_tie[] = { 3, -9, 9, 0 };
+    static const int16_t zeros[] = { 0, 0, 0 };
+    static const int16_t one[] = { -7 };
+    static const uint16_t adc12[] = { 0, 2048, 4095, 1 };
+    static const int16_t adc12_q15[] = { -32768, 0, 0x7FF0, -32768 + 16 };
+    static const uint16_t adc10[] = { 0, 512, 1023 };
+    static const int16_t adc10_q15[] = { -32768, 0, 0x7FC0 };
+    int16_t out[8];
+    uint16_t index;
+
+    Q15REF_VectorAbs(TEST_LEN(abs_in), out, abs_in);
+    test_expect_vector("Q15REF_VectorAbs", out, abs_out, TEST_LEN(abs_in));
+
+    Q15REF_VectorShift(TEST_LEN(shl_in), out, shl_in, 1);
+    test_expect_vector("Q15REF_VectorShift(+1)", out, shl_out, TEST_LEN(shl_in));
+    Q15REF_VectorShift(TEST_LEN(shr_in), out, shr_in, -1);
+    test_expect_vector("Q15REF_VectorShift(-1)", out, shr_out, TEST_LEN(shr_in));
+    Q15REF_VectorShift(TEST_LEN(shr_in), out, shr_in, -15);
+    test_expect("Q15REF_VectorShift(-15) de 32767", out[5], 0);
+    test_expect("Q15REF_VectorShift(-15) de -32768", out[4], -1);
+
+    Q15REF_VectorScale(TEST_LEN(scl_in), out, scl_in, 0x6000, 1);
+    test_expect_vector("Q15REF_VectorScale(0.75, 1)", out, scl_out, TEST_LEN(scl_in));
+    Q15REF_VectorScale(TEST_LEN(half_in), out, half_in, 0x4000, 0);
+    test_expect_vector("Q15REF_VectorScale(0.5, 0)", out, half_out, TEST_LEN(half_in));
+
+    Q15REF_VectorAdd(TEST_LEN(add_a), out, add_a, add_b);
+    test_expect_vector("Q15REF_VectorAdd", out, add_out, TEST_LEN(add_a));
+
+    test_expect("Q15REF_VectorMax", Q15REF_VectorMax(TEST_LEN(sel), sel, &index), 12);
+    test_expect("Q15REF_VectorMax (posición)", index, 1);
+    test_expect("Q15REF_VectorMin", Q15REF_VectorMin(TEST_LEN(sel), sel, &index), -32768);
+    test_expect("Q15REF_VectorMin (posición)", index, 4);
+    test_expect("Q15REF_VectorPeak", Q15REF_VectorPeak(TEST_LEN(sel), sel, &index), 32767);
+    test_expect("Q15REF_VectorPeak (posición)", index, 4);
+    test_expect("Q15REF_VectorPeak empate", Q15REF_VectorPeak(TEST_LEN(peak_tie), peak_tie, &index), 9);
+    test_expect("Q15REF_VectorPeak empate (posición)", index, 1);
+    test_expect("Q15REF_VectorPeak ceros", Q15REF_VectorPeak(TEST_LEN(zeros), zeros, &index), 0);
+    test_expect("Q15REF_VectorPeak ceros (posición)", index, 0);
+    test_expect("Q15REF_VectorMax n = 1", Q15REF_VectorMax(1, one, 0), -7);
+    test_expect("Q15REF_VectorPeak n = 1", Q15REF_VectorPeak(1, one, 0), 7);
+    index = 99;
+    test_expect("Q15REF_VectorMax n = 0", Q15REF_VectorMax(0, sel, &index), 0);
+    test_expect("Q15REF_VectorMax n = 0 (posición)", index, 0);
+    index = 99;
+    test_expect("Q15REF_VectorMin n = 0", Q15REF_VectorMin(0, sel, &index), 0);
+    test_expect("Q15REF_VectorMin n = 0 (posición)", index, 0);
+    index = 99;
+    test_expect("Q15REF_VectorPeak n = 0", Q15REF_VectorPeak(0, sel, &index), 0);
+    test_expect("Q15REF_VectorPeak n = 0 (posición)", index, 0);
+
+    Q15REF_FromADC(TEST_LEN(adc12), out, adc12, 12);
+    test_expect_vector("Q15REF_FromADC(12)", out, adc12_q15, TEST_LEN(adc12));
+    Q15REF_FromADC(TEST_LEN(adc10), out, adc10, 10);
+    test_expect_vector("Q15REF_FromADC(10)", out, adc10_q15, TEST_LEN(adc10));
+}
+
+/* Filtra 'x' en bloques de 'block' muestras (el último puede ser menor).
+   Con 'reset' reinicia la línea de retardo en cada bloque. */
+static void test_fir_blocks(const int16_t *taps, uint16_t num_taps, const int16_t *x,
+                            int16_t *y, unsigned block, int reset)
+{
+    static int16_t delay[TEST_MAX_WORDS];
+    Q15REF_Fir_t fir;
+    unsigned pos;
+
+    Q15REF_FirInit(&fir, taps, delay, num_taps);
+    for (pos = 0; pos < TEST_NUM_SAMPLES; pos += block) {
+        unsigned n = (TEST_NUM_SAMPLES - pos < block) ? TEST_NUM_SAMPLES - pos : block;
+        if (reset) {
+            Q15REF_FirInit(&fir, taps, delay, num_taps);
+        }
+        Q15REF_Fir(&fir, (uint16_t)n, &y[pos], &x[pos]);
+    }
+}
+
+/* La línea de retardo pasa de un bloque a otro: mismo resultado que de una
+   vez con cualquier tamaño de bloque (también menor que el filtro) */
+static void test_block_carry(const int16_t *taps, uint16_t num_taps, const int16_t *x,
+                             const int16_t *y_once)
+{
+    static const unsigned blocks[] = { 1u, 7u, 64u, 75u, 100u };
+    int16_t y[TEST_NUM_SAMPLES];
+    unsigned b;
+
+    for (b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+        char what[64];
+        test_fir_blocks(taps, num_taps, x, y, blocks[b], 0);
+        snprintf(what, sizeof(what), "FIR en bloques de %u", blocks[b]);
+        test_expect_vector(what, y, y_once, TEST_NUM_SAMPLES);
+    }
+
+    test_fir_blocks(taps, num_taps, x, y, 64u, 1);
+    if (memcmp(y, y_once, sizeof(y)) == 0) {
+        test_fail("FIR reiniciando el retardo en cada bloque da lo mismo: la prueba no sirve");
+    }
+}
+
+/* Cadena de firpipe en modo bloque: bloque del ADC (entero sin signo de
+   TEST_ADC_BITS) -> Q15REF_FromADC -> Q15REF_Fir con el retardo de un
+   bloque al siguiente. La referencia es el cálculo exacto sobre la entrada
+   cuantizada, que en Q15 es la muestra con los bits bajos a cero. */
+static void test_adc_chain(const int16_t *taps, uint16_t num_taps, const int16_t *x)
+{
+    static int16_t delay[TEST_MAX_WORDS];
+    uint16_t adc[TEST_NUM_SAMPLES];
+    int16_t xq[TEST_NUM_SAMPLES];
+    int16_t in[TEST_ADC_BLOCK];
+    int16_t out[TEST_NUM_SAMPLES];
+    uint16_t mask = (uint16_t)(0xFFFFu << (16u - TEST_ADC_BITS));
+    Q15REF_Fir_t fir;
+    unsigned i, pos;
+
+    for (i = 0; i < TEST_NUM_SAMPLES; i++) {
+        adc[i] = (uint16_t)(((uint16_t)x[i] ^ 0x8000u) >> (16u - TEST_ADC_BITS));
+        xq[i] = (int16_t)((uint16_t)x[i] & mask);
+    }
+
+    Q15REF_FirInit(&fir, taps, delay, num_taps);
+    for (pos = 0; pos < TEST_NUM_SAMPLES; pos += TEST_ADC_BLOCK) {
+        Q15REF_FromADC(TEST_ADC_BLOCK, in, &adc[pos], TEST_ADC_BITS);
+        test_expect_vector("Q15REF_FromADC de la cadena", in, &xq[pos], TEST_ADC_BLOCK);
+        Q15REF_Fir(&fir, TEST_ADC_BLOCK, &out[pos], in);
+    }
+
+    for (i = 0; i < TEST_NUM_SAMPLES; i++) {
+        long exact = test_exact(taps, num_taps, xq, i);
+        long err = (long)out[i] - exact;
+        if (err > 1 || err < -1) {
+            printf("muestra %u: cadena %d, exacto %ld\n", i, out[i], exact);
+            test_fail("cadena ADC -> FIR a más de 1 LSB del cálculo exacto");
+            break;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static int16_t taps[TEST_MAX_WORDS];
+    static int16_t x[TEST_MAX_WORDS];
+    static int16_t y[TEST_NUM_SAMPLES];
+    static int16_t y_inplace[TEST_NUM_SAMPLES];
+    static int16_t y_sample[TEST_NUM_SAMPLES];
+    static int16_t delay[TEST_MAX_WORDS];
+    static uint16_t golden[TEST_NUM_SAMPLES + 4u];
+    Q15REF_Fir_t fir;
+    const char *taps_path, *input_path, *golden_path = 0;
+    int generate = 0;
+    int num_taps, num_samples, num_golden;
+    long equ_taps;
+    int16_t dot;
+    uint32_t sumsq;
+    unsigned i;
+
+    if (argc == 4 && strcmp(argv[1], "-g") == 0) {
+        generate = 1;
+        taps_path = argv[2];
+        input_path = argv[3];
+    } else if (argc == 4) {
+        taps_path = argv[1];
+        input_path = argv[2];
+        golden_path = argv[3];
+    } else {
+        fprintf(stderr, "uso: %s [-g] lowpassexample.s inputsignal_square1khz.s [dorado.txt]\n",
+                argv[0]);
+        return 2;
+    }
+
+    num_taps = test_read_hwords(taps_path, "lowpassexampleTaps", taps, TEST_MAX_WORDS);
+    num_samples = test_read_hwords(input_path, "_square1k", x, TEST_MAX_WORDS);
+    equ_taps = test_read_equ(taps_path, "lowpassexampleNumTaps");
+    if (num_taps <= 0 || num_samples <= 0) {
+        fprintf(stderr, "no se encuentran los taps o la señal\n");
+        return 2;
+    }
+    if (num_taps != equ_taps) {
+        test_fail("nº de taps distinto de lowpassexampleNumTaps");
+    }
+    if (num_samples != (int)TEST_NUM_SAMPLES) {
+        test_fail("_square1k no tiene 256 muestras");
+        return 1;
+    }
+    for (i = 0; i < (unsigned)num_taps / 2u; i++) {
+        if (taps[i] != taps[num_taps - 1 - i]) {
+            test_fail("taps no simétricos");
+            break;
+        }
+    }
+
+    Q15REF_FirInit(&fir, taps, delay, (uint16_t)num_taps);
+    Q15REF_Fir(&fir, TEST_NUM_SAMPLES, y, x);
+
+    memcpy(y_inplace, x, sizeof(y_inplace));
+    Q15REF_FirInit(&fir, taps, delay, (uint16_t)num_taps);
+    Q15REF_Fir(&fir, TEST_NUM_SAMPLES, y_inplace, y_inplace);
+
+    Q15REF_FirInit(&fir, taps, delay, (uint16_t)num_taps);
+    for (i = 0; i < TEST_NUM_SAMPLES; i++) {
+        y_sample[i] = Q15REF_FirSample(&fir, x[i]);
+    }
+
+    dot = Q15REF_DotProduct((uint16_t)num_taps, x, taps);
+    sumsq = Q15REF_SumSquares(TEST_NUM_SAMPLES, x, 8);
+
+    if (generate) {
+        printf("# Salida de Q15REF_Fir: lowpassexample.s (%d taps) sobre _square1k\n", num_taps);
+        printf("# (%u muestras), después Q15REF_DotProduct(taps, _square1k) y\n",
+               TEST_NUM_SAMPLES);
+        printf("# Q15REF_SumSquares(_square1k, shift 8) (alta, baja).\n");
+        printf("# Regenerar con: make golden (revisar el diff antes de subirlo)\n");
+        for (i = 0; i < TEST_NUM_SAMPLES; i++) {
+            printf("%04X\n", (uint16_t)y[i]);
+        }
+        printf("%04X\n", (uint16_t)dot);
+        printf("%04X\n", (uint16_t)(sumsq >> 16));
+        printf("%04X\n", (uint16_t)sumsq);
+        return 0;
+    }
+
+    for (i = 0; i < TEST_NUM_SAMPLES; i++) {
+        long exact = test_exact(taps, (unsigned)num_taps, x, i);
+        long err = (long)y[i] - exact;
+        if (err > 1 || err < -1) {
+            printf("muestra %u: modelo %d, exacto %ld\n", i, y[i], exact);
+            test_fail("modelo a más de 1 LSB del cálculo exacto");
+            break;
+        }
+    }
+    if (memcmp(y, y_inplace, sizeof(y)) != 0) {
+        test_fail("Q15REF_Fir con dst == src");
+    }
+    if (memcmp(y, y_sample, sizeof(y)) != 0) {
+        test_fail("Q15REF_FirSample distinto del modo bloque");
+    }
+
+    /* Q31 exacto: el producto fraccional vale 2ab */
+    {
+        long long acc = 0;
+        long exact;
+        for (i = 0; i < TEST_NUM_SAMPLES; i++) {
+            acc += 2LL * x[i] * x[i];
+        }
+        test_expect("Q15REF_SumSquares exacto (alta)", (long)(sumsq >> 16),
+                    (long)((uint32_t)(acc >> 8) >> 16));
+        test_expect("Q15REF_SumSquares exacto (baja)", (long)(sumsq & 0xFFFFu),
+                    (long)((uint32_t)(acc >> 8) & 0xFFFFu));
+        acc = 0;
+        for (i = 0; i < (unsigned)num_taps; i++) {
+            acc += (long long)x[i] * taps[i];
+        }
+        exact = (long)((acc + 16384) >> 15);
+        if (dot - exact > 1 || dot - exact < -1) {
+            test_fail("Q15REF_DotProduct a más de 1 LSB del cálculo exacto");
+        }
+    }
+
+    test_block_carry(taps, (uint16_t)num_taps, x, y);
+    test_adc_chain(taps, (uint16_t)num_taps, x);
+    test_vector_helpers();
+
+    num_golden = test_read_golden(golden_path, golden, TEST_NUM_SAMPLES + 4u);
+    if (num_golden != (int)TEST_NUM_SAMPLES + 3) {
+        test_fail("fichero dorado incompleto");
+        return 1;
+    }
+    for (i = 0; i < TEST_NUM_SAMPLES; i++) {
+        if ((uint16_t)y[i] != golden[i]) {
+            printf("muestra %u: %04X, dorado %04X\n", i, (uint16_t)y[i], golden[i]);
+            test_fail("salida FIR distinta del dorado");
+            break;
+        }
+    }
+    if ((uint16_t)dot != golden[TEST_NUM_SAMPLES]) {
+        test_fail("Q15REF_DotProduct distinto del dorado");
+    }
+    if ((uint16_t)(sumsq >> 16) != golden[TEST_NUM_SAMPLES + 1u] ||
+        (uint16_t)sumsq != golden[TEST_NUM_SAMPLES + 2u]) {
+        test_fail("Q15REF_SumSquares distinto del dorado");
+    }
+
+    printf("%s (%d taps, %u muestras)\n", test_failures ? "FALLO" : "OK",
+           num_taps, TEST_NUM_SAMPLES);
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * eeprom_24lc256.c - Implementación del driver de EEPROM 24LC256
+ *
+ * Cada página se escribe en una transacción (dirección de 16 bits + hasta
+ * 64 datos) y se espera el ciclo interno de grabación con ACK polling: el
+ * chip no reconoce su dirección mientras graba. Frente a un byte por
+ * transacción con retardo fijo de 10 ms, un registro de 64 bytes pasa de
+ * ~640 ms a ~5 ms.
+ *
+ ******************************************************************************/
+
+#include "eeprom_24lc256.h"
+#include "config.h"
+#include <string.h>
+
+// =============================================================================
+// VARIABLES PRIVADAS
+// =============================================================================
+
+static I2C_Module_t eeprom_module = I2C_MODULE_1;
+static uint8_t eeprom_address = EEPROM_24LC256_ADDRESS;
+
+// =============================================================================
+// FUNCIONES PÚBLICAS
+// =============================================================================
+
+/**
+ * @brief Selecciona el módulo I2C (ya inicializado como maestro) y la dirección
+ */
+void EEPROM_Init(I2C_Module_t module, uint8_t address) {
+    eeprom_module = module;
+    eeprom_address = address;
+}
+
+/**
+ * @brief Espera el fin del ciclo de escritura por ACK polling
+ */
+bool EEPROM_WaitReady(void) {
+    uint32_t start = SYSTEM_GetTickMs();
+
+    do {
+        // Mientras graba, el chip responde NACK a su dirección (no cuenta
+        // como error en I2C_GetStats)
+        if (I2C_PollDevice(eeprom_module, eeprom_address)) {
+            return true;
+        }
+    } while ((SYSTEM_GetTickMs() - start) <= EEPROM_WRITE_TIMEOUT_MS);
+
+    return false;
+}
+
+/**
+ * @brief Escribe 'length' bytes desde mem_addr, partiendo en páginas
+ *
+ * Vuelve cuando el último ciclo de escritura ha terminado.
+ */
+bool EEPROM_Write(uint16_t mem_addr, const uint8_t *data, uint16_t length) {
+    uint8_t frame[2 + EEPROM_PAGE_SIZE];
+
+    if (data == NULL || length == 0) return false;
+    if ((uint32_t)mem_addr + length > EEPROM_SIZE) return false;
+
+    while (length > 0) {
+        // Lo que cabe hasta el final de la página actual
+        uint16_t chunk = EEPROM_PAGE_SIZE - (mem_addr & (EEPROM_PAGE_SIZE - 1));
+        if (chunk > length) chunk = length;
+
+        frame[0] = (uint8_t)(mem_addr >> 8);    // Dirección alta
+        frame[1] = (uint8_t)(mem_addr & 0xFF);  // Dirección baja
+        memcpy(&frame[2], data, chunk);
+
+        if (!I2C_WriteBuffer(eeprom_module, eeprom_address, frame, chunk + 2)) {
+            return false;
+        }
+        if (!EEPROM_WaitReady()) {
+            return false;
+        }
+
+        mem_addr += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Lee 'length' bytes desde mem_addr en una sola transacción
+ *
+ * El puntero interno del chip avanza solo: no hay límite de página en lectura.
+ */
+bool EEPROM_Read(uint16_t mem_addr, uint8_t *buffer, uint16_t length) {
+    if (buffer == NULL || length == 0) return false;
+    if ((uint32_t)mem_addr + length > EEPROM_SIZE) return false;
+
+    return I2C_ReadRegisters16(eeprom_module, eeprom_address, mem_addr, buffer, length);
+}
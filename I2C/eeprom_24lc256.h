@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * eeprom_24lc256.h - Driver de EEPROM 24LC256 sobre la librería I2C
+ *
+ * Descripción: Escritura por páginas de 64 bytes con ACK polling y lectura
+ *              secuencial en una sola transacción.
+ *
+ * Características:
+ * - Los buffers se parten en los límites de página (una escritura que cruza
+ *   el límite volvería al inicio de la página dentro del chip)
+ * - Fin del ciclo de escritura por ACK polling, sin esperas fijas
+ * - Lectura aleatoria + secuencial con REPEATED START
+ *
+ * USO:
+ *      I2C_Init(&config);
+ *      EEPROM_Init(I2C_MODULE_1, EEPROM_24LC256_ADDRESS);
+ *      EEPROM_Write(0x0100, registro, sizeof(registro));
+ *      EEPROM_Read(0x0100, copia, sizeof(copia));
+ *
+ ******************************************************************************/
+
+#ifndef EEPROM_24LC256_H
+#define EEPROM_24LC256_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "i2c.h"
+
+// =============================================================================
+// DEFINICIONES
+// =============================================================================
+
+#define EEPROM_24LC256_ADDRESS  0x50     // A2..A0 = 0
+#define EEPROM_PAGE_SIZE        64       // Bytes por página
+#define EEPROM_SIZE             32768UL  // 256 Kbit
+
+// Máximo a esperar el fin del ciclo de escritura (tWC = 5 ms según datasheet)
+#ifndef EEPROM_WRITE_TIMEOUT_MS
+#define EEPROM_WRITE_TIMEOUT_MS 10
+#endif
+
+// =============================================================================
+// PROTOTIPOS DE FUNCIONES
+// =============================================================================
+
+void EEPROM_Init(I2C_Module_t module, uint8_t address);
+bool EEPROM_Write(uint16_t mem_addr, const uint8_t *data, uint16_t length);
+bool EEPROM_Read(uint16_t mem_addr, uint8_t *buffer, uint16_t length);
+bool EEPROM_WaitReady(void);
+
+#endif /* EEPROM_24LC256_H */
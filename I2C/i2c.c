@@ -7,57 +7,264 @@
  ******************************************************************************/
 
 #include "i2c.h"
+#include "config.h"
 #include <string.h>
 #include <stdio.h>
 
+// Módulo fijado al compilar (config.h): con un solo módulo habilitado los
+// switch de abajo se resuelven en una constante y el compilador deja el
+// acceso directo al SFR de ese módulo
+#if defined(CONFIG_I2C1_ENABLED) && !defined(CONFIG_I2C2_ENABLED)
+#define I2C_MODULE_SEL(m)  ((void)(m), I2C_MODULE_1)
+#elif defined(CONFIG_I2C2_ENABLED) && !defined(CONFIG_I2C1_ENABLED)
+#define I2C_MODULE_SEL(m)  ((void)(m), I2C_MODULE_2)
+#else
+#define I2C_MODULE_SEL(m)  (m)
+#endif
+
 // =============================================================================
 // VARIABLES GLOBALES
 // =============================================================================
 
+// El estado de I2C2 sólo existe con CONFIG_I2C2_ENABLED: en el
+// dsPIC33FJ32MC204 (solo I2C1) serían ~100 bytes de RAM sin uso
 volatile I2C_State_t I2C1_State = I2C_STATE_IDLE;
-volatile I2C_State_t I2C2_State = I2C_STATE_IDLE;
 volatile bool I2C1_Busy = false;
-volatile bool I2C2_Busy = false;
 I2C_Config_t I2C1_Config;
+#ifdef CONFIG_I2C2_ENABLED
+volatile I2C_State_t I2C2_State = I2C_STATE_IDLE;
+volatile bool I2C2_Busy = false;
 I2C_Config_t I2C2_Config;
-
-// Buffers para transmisión/recepción
-static uint8_t i2c1_rx_buffer[256];
-static uint8_t i2c1_tx_buffer[256];
-static uint8_t i2c2_rx_buffer[256];
-static uint8_t i2c2_tx_buffer[256];
-
-static uint16_t i2c1_rx_index = 0;
-static uint16_t i2c1_tx_index = 0;
-static uint16_t i2c2_rx_index = 0;
-static uint16_t i2c2_tx_index = 0;
+#endif
 
 // Callbacks
 static I2C_Callback_t i2c1_callback = NULL;
+#ifdef CONFIG_I2C2_ENABLED
 static I2C_Callback_t i2c2_callback = NULL;
+#endif
+
+// Mapa de registros I2Cx (mismo orden que en la memoria SFR del dsPIC33F)
+typedef struct {
+    uint16_t rcv;   // I2CxRCV
+    uint16_t trn;   // I2CxTRN
+    uint16_t brg;   // I2CxBRG
+    uint16_t con;   // I2CxCON
+    uint16_t stat;  // I2CxSTAT
+    uint16_t add;   // I2CxADD
+    uint16_t msk;   // I2CxMSK
+} I2C_Regs_t;
+
+// Bits de I2CxCON
+#define I2C_CON_SEN     (1u << 0)   // START
+#define I2C_CON_RSEN    (1u << 1)   // REPEATED START
+#define I2C_CON_PEN     (1u << 2)   // STOP
+#define I2C_CON_RCEN    (1u << 3)   // Recepción
+#define I2C_CON_ACKEN   (1u << 4)   // Secuencia ACK
+#define I2C_CON_ACKDT   (1u << 5)   // Valor ACK (1 = NACK)
+#define I2C_CON_STREN   (1u << 6)   // Clock stretching (esclavo)
+#define I2C_CON_GCEN    (1u << 7)   // General call
+#define I2C_CON_SMEN    (1u << 8)   // Niveles SMBus
+#define I2C_CON_DISSLW  (1u << 9)   // Slew rate deshabilitado
+#define I2C_CON_A10M    (1u << 10)  // Dirección 10-bit
+#define I2C_CON_SCLREL  (1u << 12)  // Liberar SCL (esclavo)
+#define I2C_CON_I2CEN   (1u << 15)  // Módulo habilitado
+#define I2C_CON_BUSY_MASK (I2C_CON_SEN | I2C_CON_RSEN | I2C_CON_PEN | I2C_CON_RCEN | I2C_CON_ACKEN)
+
+// Bits de I2CxSTAT
+#define I2C_STAT_TBF     (1u << 0)   // Buffer TX lleno
+#define I2C_STAT_RBF     (1u << 1)   // Buffer RX lleno
+#define I2C_STAT_RW      (1u << 2)   // R/W del último byte de dirección
+#define I2C_STAT_S       (1u << 3)   // START detectado
+#define I2C_STAT_P       (1u << 4)   // STOP detectado
+#define I2C_STAT_DA      (1u << 5)   // Último byte: 1 = dato, 0 = dirección
+#define I2C_STAT_I2COV   (1u << 6)   // Overflow de recepción
+#define I2C_STAT_IWCOL   (1u << 7)   // Colisión de escritura
+#define I2C_STAT_BCL     (1u << 10)  // Colisión de bus (maestro)
+#define I2C_STAT_TRSTAT  (1u << 14)  // Transmisión en curso (maestro)
+#define I2C_STAT_ACKSTAT (1u << 15)  // 1 = NACK recibido
+
+// Generador de baudios
+#define I2C_PGD_DIVISOR  10000000UL  // 1 / Tpgd (retardo del pulse gobbler, 100 ns)
+#define I2C_BRG_MIN      2
+#define I2C_BRG_MAX      0x01FF      // I2CxBRG<8:0>
+
+// Fases del motor de transacciones maestro (dirigido por la interrupción MI2Cx)
+typedef enum {
+    I2C_PHASE_IDLE,
+    I2C_PHASE_START,       // esperando fin de START
+    I2C_PHASE_ADDR_W,      // dirección + W enviada
+    I2C_PHASE_WRITE,       // byte de datos enviado
+    I2C_PHASE_RESTART,     // esperando fin de REPEATED START
+    I2C_PHASE_ADDR_R,      // dirección + R enviada
+    I2C_PHASE_READ,        // esperando byte recibido
+    I2C_PHASE_ACK,         // esperando fin de la secuencia ACK/NACK
+    I2C_PHASE_STOP         // esperando fin de STOP
+} I2C_Phase_t;
+
+#define I2C_QUEUE_MASK (I2C_QUEUE_LENGTH - 1u)
+
+#if (I2C_QUEUE_LENGTH & I2C_QUEUE_MASK) != 0
+#error "I2C_QUEUE_LENGTH debe ser potencia de 2"
+#endif
+
+typedef struct {
+    I2C_Transaction_t* current;    // transacción en curso (NULL = libre)
+    volatile I2C_Phase_t phase;
+    uint16_t index;                // byte actual de escritura o lectura
+    uint32_t start_tick;           // SYSTEM_GetTickMs() al arrancar (I2C_CheckTimeout)
+    I2C_State_t result;            // resultado que se entrega tras el STOP
+    
+    // Cola de transacciones pendientes (índices libres, se enmascaran al usar)
+    I2C_Transaction_t* queue[I2C_QUEUE_LENGTH];
+    volatile uint8_t head;         // escribe I2C_Submit
+    volatile uint8_t tail;         // lee el motor al arrancar la siguiente
+} I2C_Engine_t;
+
+static I2C_Engine_t i2c1_engine;
+#ifdef CONFIG_I2C2_ENABLED
+static I2C_Engine_t i2c2_engine;
+#endif
+
+// Esclavo con banco de registros (ver I2C_SlaveRegMapInit)
+typedef struct {
+    uint8_t* bank[2];              // bank[front] lo lee el maestro; el otro, la aplicación
+    uint8_t size;
+    volatile uint8_t front;
+    volatile bool swap_pending;    // I2C_SlavePublish esperando fin de transferencia
+    volatile bool addressed;       // transferencia hacia nosotros en curso
+    uint8_t index;                 // puntero de registro (autoincremento)
+    bool expect_index;             // el siguiente byte escrito es el índice
+    uint8_t last_address;          // última dirección recibida (7-bit)
+} I2C_Slave_t;
+
+static I2C_Slave_t i2c1_slave;
+#ifdef CONFIG_I2C2_ENABLED
+static I2C_Slave_t i2c2_slave;
+#endif
+
+// Escaneo no bloqueante (una transacción de sondeo que se reencola sola)
+typedef struct {
+    I2C_Module_t module;
+    I2C_Transaction_t probe;       // solo dirección + W: ACK = dispositivo presente
+    uint8_t* bitmap;
+    uint8_t found;
+    volatile bool running;
+} I2C_Scan_t;
+
+static I2C_Scan_t i2c1_scan;
+#ifdef CONFIG_I2C2_ENABLED
+static I2C_Scan_t i2c2_scan;
+#endif
+
+// Contadores (I2C_GetStats)
+static volatile I2C_Stats_t i2c1_stats;
+#ifdef CONFIG_I2C2_ENABLED
+static volatile I2C_Stats_t i2c2_stats;
+#endif
 
 // =============================================================================
 // FUNCIONES PRIVADAS
 // =============================================================================
 
 /**
- * @brief Obtiene puntero al módulo I2C
+ * @brief Obtiene puntero a los registros del módulo I2C
+ */
+static inline volatile I2C_Regs_t* _I2C_GetRegs(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: return (volatile I2C_Regs_t*)&I2C1RCV;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: return (volatile I2C_Regs_t*)&I2C2RCV;
+        #endif
+        default: return (volatile I2C_Regs_t*)&I2C1RCV;
+    }
+}
+
+/**
+ * @brief Obtiene el motor de transacciones del módulo
+ */
+static inline I2C_Engine_t* _I2C_GetEngine(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: return &i2c1_engine;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: return &i2c2_engine;
+        #endif
+        default: return &i2c1_engine;
+    }
+}
+
+/**
+ * @brief Obtiene el escaneo no bloqueante del módulo
  */
-static volatile uint16_t* _I2C_GetModuleBase(I2C_Module_t module) {
-    switch(module) {
-        case I2C_MODULE_1: return (volatile uint16_t*)&I2C1CON;
-        case I2C_MODULE_2: return (volatile uint16_t*)&I2C2CON;
-        default: return (volatile uint16_t*)&I2C1CON;
+static inline I2C_Scan_t* _I2C_GetScan(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: return &i2c1_scan;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: return &i2c2_scan;
+        #endif
+        default: return &i2c1_scan;
+    }
+}
+
+/**
+ * @brief Obtiene el estado del esclavo del módulo
+ */
+static inline I2C_Slave_t* _I2C_GetSlave(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: return &i2c1_slave;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: return &i2c2_slave;
+        #endif
+        default: return &i2c1_slave;
+    }
+}
+
+/**
+ * @brief Obtiene los contadores del módulo
+ */
+static inline volatile I2C_Stats_t* _I2C_GetStats(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: return &i2c1_stats;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: return &i2c2_stats;
+        #endif
+        default: return &i2c1_stats;
+    }
+}
+
+/**
+ * @brief Suma un resultado con error al contador que le corresponde
+ */
+static void _I2C_CountError(I2C_Module_t module, I2C_State_t result) {
+    volatile I2C_Stats_t* st = _I2C_GetStats(module);
+    
+    switch (result) {
+        case I2C_STATE_ADDR_NACK:
+        case I2C_STATE_DATA_NACK:
+            st->nacks++;
+            break;
+        case I2C_STATE_TIMEOUT:
+            st->timeouts++;
+            break;
+        case I2C_STATE_ARB_LOST:
+        case I2C_STATE_BUS_COLLISION:
+        case I2C_STATE_OVERRUN:
+        case I2C_STATE_ERROR:
+            st->errors++;
+            break;
+        default:
+            break;
     }
 }
 
 /**
  * @brief Obtiene estado actual del módulo
  */
-static volatile I2C_State_t* _I2C_GetState(I2C_Module_t module) {
-    switch(module) {
+static inline volatile I2C_State_t* _I2C_GetState(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
         case I2C_MODULE_1: return &I2C1_State;
+        #ifdef CONFIG_I2C2_ENABLED
         case I2C_MODULE_2: return &I2C2_State;
+        #endif
         default: return &I2C1_State;
     }
 }
@@ -65,10 +272,12 @@ static volatile I2C_State_t* _I2C_GetState(I2C_Module_t module) {
 /**
  * @brief Obtiene flag de busy
  */
-static volatile bool* _I2C_GetBusyFlag(I2C_Module_t module) {
-    switch(module) {
+static inline volatile bool* _I2C_GetBusyFlag(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
         case I2C_MODULE_1: return &I2C1_Busy;
+        #ifdef CONFIG_I2C2_ENABLED
         case I2C_MODULE_2: return &I2C2_Busy;
+        #endif
         default: return &I2C1_Busy;
     }
 }
@@ -76,10 +285,12 @@ static volatile bool* _I2C_GetBusyFlag(I2C_Module_t module) {
 /**
  * @brief Obtiene configuración
  */
-static I2C_Config_t* _I2C_GetConfig(I2C_Module_t module) {
-    switch(module) {
+static inline I2C_Config_t* _I2C_GetConfig(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
         case I2C_MODULE_1: return &I2C1_Config;
+        #ifdef CONFIG_I2C2_ENABLED
         case I2C_MODULE_2: return &I2C2_Config;
+        #endif
         default: return &I2C1_Config;
     }
 }
@@ -88,73 +299,391 @@ static I2C_Config_t* _I2C_GetConfig(I2C_Module_t module) {
  * @brief Configura pines I2C
  */
 static void _I2C_ConfigurePins(I2C_Module_t module) {
-    switch(module) {
+    // Con I2CEN = 1 el módulo toma los pines en drenador abierto. Como GPIO
+    // (recuperación del bus) se emula igual: LAT = 0 y TRIS suelta/baja la línea.
+    switch(I2C_MODULE_SEL(module)) {
         case I2C_MODULE_1:
-            // I2C1: SCL1 - RC3, SDA1 - RC4
-            ANSELCbits.ANSC3 = 0;  // Digital
-            ANSELCbits.ANSC4 = 0;  // Digital
-            TRISCbits.TRISC3 = 1;  // Input
-            TRISCbits.TRISC4 = 1;  // Input
-            // Open-drain configuration
-            ODCONCbits.ODCC3 = 1;  // Open-drain
-            ODCONCbits.ODCC4 = 1;  // Open-drain
+            I2C1_SCL_LAT = 0;
+            I2C1_SDA_LAT = 0;
+            I2C1_SCL_TRIS = 1;  // Suelta (pull-up)
+            I2C1_SDA_TRIS = 1;
             break;
             
+        #ifdef CONFIG_I2C2_ENABLED
         case I2C_MODULE_2:
-            // I2C2: SCL2 - RG2, SDA2 - RG3
-            ANSELGbits.ANSG2 = 0;  // Digital
-            ANSELGbits.ANSG3 = 0;  // Digital
-            TRISGbits.TRISG2 = 1;  // Input
-            TRISGbits.TRISG3 = 1;  // Input
-            // Open-drain configuration
-            ODCONGbits.ODCG2 = 1;  // Open-drain
-            ODCONGbits.ODCG3 = 1;  // Open-drain
+            I2C2_SCL_LAT = 0;
+            I2C2_SDA_LAT = 0;
+            I2C2_SCL_TRIS = 1;
+            I2C2_SDA_TRIS = 1;
             break;
+        #endif
+        default: break;
     }
 }
 
 /**
- * @brief Calcula baud rate register
+ * @brief Suelta (high = true) o lleva a nivel bajo la línea SCL como GPIO
  */
-static uint16_t _I2C_CalculateBRG(uint32_t fcy, uint32_t desired_speed) {
-    // Fórmula: BRG = (Fcy / (2 * Fscl)) - 2
-    // Donde Fscl = desired_speed
-    uint32_t brg = (fcy / (2 * desired_speed)) - 2;
-    
-    // Limitar a valor máximo de 16 bits
-    if (brg > 0xFFFF) brg = 0xFFFF;
-    if (brg < 2) brg = 2;  // Mínimo según datasheet
-    
-    return (uint16_t)brg;
+static void _I2C_DriveSCL(I2C_Module_t module, bool high) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: I2C1_SCL_TRIS = high; break;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: I2C2_SCL_TRIS = high; break;
+        #endif
+        default: break;
+    }
+}
+
+/**
+ * @brief Suelta (high = true) o lleva a nivel bajo la línea SDA como GPIO
+ */
+static void _I2C_DriveSDA(I2C_Module_t module, bool high) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: I2C1_SDA_TRIS = high; break;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: I2C2_SDA_TRIS = high; break;
+        #endif
+        default: break;
+    }
+}
+
+/**
+ * @brief Nivel actual de SCL
+ */
+static bool _I2C_ReadSCL(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: return I2C1_SCL_PORT;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: return I2C2_SCL_PORT;
+        #endif
+        default: return true;
+    }
+}
+
+/**
+ * @brief Nivel actual de SDA
+ */
+static bool _I2C_ReadSDA(I2C_Module_t module) {
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: return I2C1_SDA_PORT;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: return I2C2_SDA_PORT;
+        #endif
+        default: return true;
+    }
+}
+
+/**
+ * @brief Indica si pasaron más de timeout_ms desde 'start' (tick del sistema)
+ *
+ * Se compara con '>' para no cortar antes de tiempo: el primer tick puede
+ * llegar en cualquier momento del milisegundo en curso.
+ */
+static bool _I2C_Expired(uint32_t start, uint16_t timeout_ms) {
+    return (SYSTEM_GetTickMs() - start) > timeout_ms;
+}
+
+/**
+ * @brief Timeout en una espera bloqueante: recupera el bus y lo reporta
+ *
+ * Una secuencia que no termina (SEN/PEN/RCEN pendientes, TRSTAT fijo) deja
+ * el módulo bloqueado; I2C_RecoverBus lo reinicia y libera SDA si hace falta.
+ */
+static void _I2C_Timeout(I2C_Module_t module) {
+    I2C_RecoverBus(module);
+    *_I2C_GetState(module) = I2C_STATE_TIMEOUT;
+    _I2C_GetStats(module)->timeouts++;
+}
+
+/**
+ * @brief SCL real que genera un valor de I2CxBRG
+ *
+ * Inversa de I2C_CalculateBaudRate: Fscl = Fcy / (BRG + 1 + Fcy * Tpgd).
+ */
+static uint32_t _I2C_BRGToSpeed(uint32_t fcy, uint16_t brg) {
+    uint64_t den = (uint64_t)(brg + 1u) * I2C_PGD_DIVISOR + fcy;
+    return (uint32_t)(((uint64_t)fcy * I2C_PGD_DIVISOR + den / 2) / den);
 }
 
 /**
  * @brief Espera condición I2C
  */
 static bool _I2C_WaitCondition(I2C_Module_t module, uint16_t timeout_ms) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    uint32_t timeout_counter = timeout_ms * 1000;  // Aproximado
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    uint32_t start = SYSTEM_GetTickMs();
     
-    while ((*i2c_con & 0x1F) != 0 && timeout_counter--) {
+    while ((regs->con & I2C_CON_BUSY_MASK) != 0) {
         // Verificar errores
-        if (*i2c_con & (1 << 9)) {  // I2COV (Overflow)
+        if (regs->stat & I2C_STAT_I2COV) {  // Overflow
             *_I2C_GetState(module) = I2C_STATE_OVERRUN;
             return false;
         }
-        if (*i2c_con & (1 << 8)) {  // IWCOL (Write collision)
+        if (regs->stat & I2C_STAT_IWCOL) {  // Write collision
             *_I2C_GetState(module) = I2C_STATE_BUS_COLLISION;
             return false;
         }
+        if (_I2C_Expired(start, timeout_ms)) {
+            _I2C_Timeout(module);
+            return false;
+        }
     }
     
-    if (timeout_counter == 0) {
-        *_I2C_GetState(module) = I2C_STATE_TIMEOUT;
-        return false;
+    return true;
+}
+
+/**
+ * @brief Espera fin de transmisión de un byte (TRSTAT)
+ */
+static bool _I2C_WaitTransmit(I2C_Module_t module, uint16_t timeout_ms) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    uint32_t start = SYSTEM_GetTickMs();
+    
+    while (regs->stat & I2C_STAT_TRSTAT) {
+        if (regs->stat & I2C_STAT_BCL) {
+            *_I2C_GetState(module) = I2C_STATE_BUS_COLLISION;
+            return false;
+        }
+        if (_I2C_Expired(start, timeout_ms)) {
+            _I2C_Timeout(module);
+            return false;
+        }
     }
     
     return true;
 }
 
+/**
+ * @brief Bloquea la interrupción MI2Cx y devuelve si estaba habilitada
+ */
+static bool _I2C_MasterIrqDisable(I2C_Module_t module) {
+    bool was_enabled = false;
+    
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1:
+            was_enabled = IEC1bits.MI2C1IE;
+            IEC1bits.MI2C1IE = 0;
+            break;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2:
+            was_enabled = IEC3bits.MI2C2IE;
+            IEC3bits.MI2C2IE = 0;
+            break;
+        #endif
+        default: break;
+    }
+    return was_enabled;
+}
+
+/**
+ * @brief Restaura la interrupción MI2Cx
+ */
+static void _I2C_MasterIrqRestore(I2C_Module_t module, bool was_enabled) {
+    if (!was_enabled) return;
+    
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: IEC1bits.MI2C1IE = 1; break;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: IEC3bits.MI2C2IE = 1; break;
+        #endif
+        default: break;
+    }
+}
+
+/**
+ * @brief Saca la siguiente transacción de la cola y genera START/RESTART
+ *
+ * Con la cola vacía libera el módulo. 'restart' encadena sin STOP: el bus
+ * no llega a quedar libre entre transacciones.
+ */
+static void _I2C_StartNext(I2C_Module_t module, bool restart) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    
+    if (eng->head == eng->tail) {
+        eng->current = NULL;
+        eng->phase = I2C_PHASE_IDLE;
+        *_I2C_GetBusyFlag(module) = false;
+        return;
+    }
+    
+    eng->current = eng->queue[eng->tail & I2C_QUEUE_MASK];
+    eng->tail++;
+    eng->index = 0;
+    eng->start_tick = SYSTEM_GetTickMs();
+    eng->result = I2C_STATE_SUCCESS;
+    eng->phase = I2C_PHASE_START;
+    *_I2C_GetBusyFlag(module) = true;
+    *_I2C_GetState(module) = I2C_STATE_BUSY;
+    
+    // El resto sigue en _I2C_MasterEngine()
+    regs->con |= restart ? I2C_CON_RSEN : I2C_CON_SEN;
+}
+
+/**
+ * @brief Entrega el resultado de la transacción en curso al llamador
+ */
+static I2C_Transaction_t* _I2C_Deliver(I2C_Module_t module, I2C_State_t result) {
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    I2C_Transaction_t* t = eng->current;
+    
+    eng->current = NULL;
+    *_I2C_GetState(module) = result;
+    
+    _I2C_GetStats(module)->transactions++;
+    _I2C_CountError(module, result);
+    
+    if (t != NULL) {
+        t->result = result;
+        if (t->callback != NULL) {
+            t->callback(t);
+        }
+    }
+    return t;
+}
+
+/**
+ * @brief Cierra la transacción en curso (bus ya en STOP) y lanza la siguiente
+ */
+static void _I2C_FinishTransaction(I2C_Module_t module, I2C_State_t result) {
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    
+    eng->phase = I2C_PHASE_IDLE;
+    _I2C_Deliver(module, result);
+    
+    // El callback puede haber encolado y arrancado ya otra transacción
+    if (eng->phase == I2C_PHASE_IDLE) {
+        _I2C_StartNext(module, false);
+    }
+}
+
+/**
+ * @brief Fin correcto de la parte de datos: STOP o encadenado con RESTART
+ */
+static void _I2C_CompleteTransaction(I2C_Module_t module) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    
+    if (eng->current->keep_bus && eng->head != eng->tail) {
+        // Mientras se entrega el resultado el bus sigue tomado (fase START)
+        eng->phase = I2C_PHASE_START;
+        _I2C_Deliver(module, I2C_STATE_SUCCESS);
+        _I2C_StartNext(module, true);
+        return;
+    }
+    
+    eng->result = I2C_STATE_SUCCESS;
+    eng->phase = I2C_PHASE_STOP;
+    regs->con |= I2C_CON_PEN;
+}
+
+/**
+ * @brief Termina con error: STOP y entrega del resultado al completarse
+ */
+static void _I2C_AbortTransaction(I2C_Module_t module, I2C_State_t error) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    
+    eng->result = error;
+    eng->phase = I2C_PHASE_STOP;
+    regs->con |= I2C_CON_PEN;
+}
+
+/**
+ * @brief Paso del motor maestro: se llama en cada interrupción MI2Cx
+ *
+ * Cada evento (fin de START/RESTART/STOP, byte enviado con su ACK, byte
+ * recibido, fin de la secuencia ACK) avanza una fase y arranca la siguiente
+ * operación del bus sin esperas activas.
+ */
+static void _I2C_MasterEngine(I2C_Module_t module) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    I2C_Transaction_t* t = eng->current;
+    
+    // Eventos de las funciones bloqueantes: no hay nada que hacer
+    if (t == NULL) return;
+    
+    // Colisión de bus: el hardware ya ha soltado el bus, no generar STOP
+    if (regs->stat & I2C_STAT_BCL) {
+        regs->stat &= ~I2C_STAT_BCL;
+        _I2C_FinishTransaction(module, I2C_STATE_BUS_COLLISION);
+        return;
+    }
+    
+    switch(eng->phase) {
+        case I2C_PHASE_START:
+            eng->index = 0;
+            if (t->write_length > 0 || t->read_length == 0) {
+                eng->phase = I2C_PHASE_ADDR_W;
+                regs->trn = (uint16_t)(t->address << 1) | 0x00;
+            } else {
+                eng->phase = I2C_PHASE_ADDR_R;
+                regs->trn = (uint16_t)(t->address << 1) | 0x01;
+            }
+            break;
+            
+        case I2C_PHASE_ADDR_W:
+        case I2C_PHASE_WRITE:
+            if (regs->stat & I2C_STAT_ACKSTAT) {
+                _I2C_AbortTransaction(module, eng->phase == I2C_PHASE_ADDR_W ?
+                                      I2C_STATE_ADDR_NACK : I2C_STATE_DATA_NACK);
+            } else if (eng->index < t->write_length) {
+                eng->phase = I2C_PHASE_WRITE;
+                regs->trn = t->write_data[eng->index++];
+            } else if (t->read_length > 0) {
+                // Formato combinado: REPEATED START sin soltar el bus
+                eng->phase = I2C_PHASE_RESTART;
+                regs->con |= I2C_CON_RSEN;
+            } else {
+                _I2C_CompleteTransaction(module);
+            }
+            break;
+            
+        case I2C_PHASE_RESTART:
+            eng->index = 0;
+            eng->phase = I2C_PHASE_ADDR_R;
+            regs->trn = (uint16_t)(t->address << 1) | 0x01;
+            break;
+            
+        case I2C_PHASE_ADDR_R:
+            if (regs->stat & I2C_STAT_ACKSTAT) {
+                _I2C_AbortTransaction(module, I2C_STATE_ADDR_NACK);
+            } else {
+                eng->phase = I2C_PHASE_READ;
+                regs->con |= I2C_CON_RCEN;
+            }
+            break;
+            
+        case I2C_PHASE_READ:
+            t->read_data[eng->index++] = (uint8_t)(regs->rcv & 0x00FF);
+            // ACK en todos menos el último
+            if (eng->index < t->read_length) {
+                regs->con &= ~I2C_CON_ACKDT;
+            } else {
+                regs->con |= I2C_CON_ACKDT;
+            }
+            eng->phase = I2C_PHASE_ACK;
+            regs->con |= I2C_CON_ACKEN;
+            break;
+            
+        case I2C_PHASE_ACK:
+            if (eng->index < t->read_length) {
+                eng->phase = I2C_PHASE_READ;
+                regs->con |= I2C_CON_RCEN;
+            } else {
+                _I2C_CompleteTransaction(module);
+            }
+            break;
+            
+        case I2C_PHASE_STOP:
+            _I2C_FinishTransaction(module, eng->result);
+            break;
+            
+        default:
+            break;
+    }
+}
+
 // =============================================================================
 // FUNCIONES PÚBLICAS
 // =============================================================================
@@ -163,117 +692,160 @@ static bool _I2C_WaitCondition(I2C_Module_t module, uint16_t timeout_ms) {
  * @brief Inicializa el módulo I2C
  */
 void I2C_Init(I2C_Config_t *config) {
-    if (config == NULL) return;
+    if (config == NULL || !I2C_MODULE_ENABLED(config->module)) return;
     
     volatile I2C_Config_t* cfg = _I2C_GetConfig(config->module);
     memcpy((void*)cfg, config, sizeof(I2C_Config_t));
     
+    // Activar el módulo (PMD): con CONFIG_PMD_AUTO está apagado hasta aquí
+    #ifdef CONFIG_I2C2_ENABLED
+    if (config->module == I2C_MODULE_2) {
+        PMD3bits.I2C2MD = 0;
+    } else
+    #endif
+    {
+        PMD1bits.I2C1MD = 0;
+    }
+    
     // Configurar pines
     _I2C_ConfigurePins(config->module);
     
     // Obtener puntero a registros
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(config->module);
-    volatile uint16_t* i2c_stat = i2c_con + 1;  // I2CxSTAT
-    volatile uint16_t* i2c_add = i2c_con + 2;   // I2CxADD
-    volatile uint16_t* i2c_msk = i2c_con + 3;   // I2CxMSK
-    volatile uint16_t* i2c_brg = i2c_con + 4;   // I2CxBRG
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(config->module);
+    uint16_t con = I2C_CON_I2CEN;
     
     // Deshabilitar módulo durante configuración
-    *i2c_con = 0x0000;
+    regs->con = 0x0000;
     
-    // Configurar velocidad (BRG)
-    uint32_t fcy = 40000000;  // 40 MHz Fcy para dsPIC33FJ32MC204
-    *i2c_brg = _I2C_CalculateBRG(fcy, config->speed);
+    // Configurar velocidad (BRG) con el FCY real del sistema
+    regs->brg = (uint16_t)I2C_CalculateBaudRate(SYSTEM_GetClockFrequency(), config->speed);
     
-    // Configurar según modo
+    // Configurar según modo. El módulo siempre responde como esclavo a su
+    // dirección; en maestro basta con dejar I2CxADD en una dirección libre.
     switch(config->mode) {
         case I2C_MODE_MASTER:
-            // Modo maestro
-            *i2c_con = 0x8000;  // I2CEN = 1
             break;
             
+        case I2C_MODE_SLAVE:
         case I2C_MODE_SLAVE_7BIT:
-            // Esclavo 7-bit
-            *i2c_add = config->slave_address << 1;  // Dirección en 7-bit
-            *i2c_msk = 0x0000;  // Sin máscara
-            *i2c_con = 0x8000;  // I2CEN = 1
-            *i2c_con |= 0x4000; // Slave mode
+            regs->add = config->slave_address;  // Dirección 7-bit (ADD<6:0>)
+            regs->msk = 0x0000;                 // Sin máscara
+            con |= I2C_CON_STREN | I2C_CON_SCLREL;  // Clock stretching en recepción
             break;
             
         case I2C_MODE_SLAVE_10BIT:
-            // Esclavo 10-bit
-            *i2c_add = config->slave_address;  // Dirección en 10-bit
-            *i2c_con = 0x8000;  // I2CEN = 1
-            *i2c_con |= 0x4400; // Slave mode + 10-bit address
+            regs->add = config->slave_address;  // Dirección 10-bit
+            regs->msk = 0x0000;
+            con |= I2C_CON_STREN | I2C_CON_SCLREL | I2C_CON_A10M;
             break;
             
         default:
             break;
     }
     
-    // Configurar SMBus si es necesario
-    if (config->smbus_enable) {
-        *i2c_con |= 0x0020;  // SMBEN = 1
+    // General call
+    if (config->general_call_enable) {
+        con |= I2C_CON_GCEN;
     }
     
-    // Configurar slew rate
-    if (config->slew_rate_control) {
-        *i2c_con |= 0x0040;  // DISSLW = 0 (slew rate enabled)
-    } else {
-        *i2c_con |= 0x0080;  // DISSLW = 1 (slew rate disabled)
+    // Configurar SMBus si es necesario
+    if (config->smbus_enable) {
+        con |= I2C_CON_SMEN;
     }
     
-    // Configurar interrupciones
-    if (config->interrupt_enable) {
-        switch(config->module) {
-            case I2C_MODULE_1:
-                IFS1bits.I2C1BIF = 0;
-                IEC1bits.I2C1BIE = 1;
-                IPC7bits.I2C1BIP = 4;
-                break;
-            case I2C_MODULE_2:
-                IFS3bits.I2C2BIF = 0;
-                IEC3bits.I2C2BIE = 1;
-                IPC14bits.I2C2BIP = 4;
-                break;
-        }
+    // Slew rate: el datasheet solo lo especifica para 400 kHz; a 100 kHz no
+    // aporta y a 1 MHz alarga los flancos por encima de lo permitido
+    if (!config->slew_rate_control ||
+        config->speed <= I2C_SPEED_100KHZ || config->speed > I2C_SPEED_400KHZ) {
+        con |= I2C_CON_DISSLW;  // DISSLW = 1 (slew rate disabled)
     }
     
-    // Inicializar estado
+    // Inicializar estado antes de habilitar nada
     *_I2C_GetState(config->module) = I2C_STATE_IDLE;
     *_I2C_GetBusyFlag(config->module) = false;
+    memset(_I2C_GetEngine(config->module), 0, sizeof(I2C_Engine_t));
+    memset(_I2C_GetSlave(config->module), 0, sizeof(I2C_Slave_t));
+    _I2C_GetScan(config->module)->running = false;
     
     // Configurar callback
     I2C_SetCallback(config->module, config->callback);
+    
+    regs->con = con;
+    
+    // Configurar interrupciones
+    if (config->interrupt_enable) {
+        I2C_EnableInterrupts(config->module, true);
+    }
 }
 
 /**
  * @brief Deshabilita el módulo I2C
  */
 void I2C_Deinit(I2C_Module_t module) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    *i2c_con = 0x0000;  // Deshabilitar módulo
-    
     // Deshabilitar interrupciones
-    switch(module) {
+    I2C_EnableInterrupts(module, false);
+    
+    _I2C_GetRegs(module)->con = 0x0000;  // Deshabilitar módulo
+    
+    // Resetear estado
+    memset(_I2C_GetEngine(module), 0, sizeof(I2C_Engine_t));
+    _I2C_GetScan(module)->running = false;
+    *_I2C_GetState(module) = I2C_STATE_IDLE;
+    *_I2C_GetBusyFlag(module) = false;
+}
+
+/**
+ * @brief Habilita/deshabilita la interrupción del módulo
+ *
+ * En maestro se usa MI2Cx (motor de transacciones); en esclavo, SI2Cx.
+ */
+void I2C_EnableInterrupts(I2C_Module_t module, bool enable) {
+    bool master = (_I2C_GetConfig(module)->mode == I2C_MODE_MASTER);
+    
+    switch(I2C_MODULE_SEL(module)) {
         case I2C_MODULE_1:
-            IEC1bits.I2C1BIE = 0;
+            IEC1bits.MI2C1IE = 0;
+            IEC1bits.SI2C1IE = 0;
+            if (enable) {
+                IPC4bits.MI2C1IP = 4;
+                IPC4bits.SI2C1IP = 4;
+                if (master) {
+                    IFS1bits.MI2C1IF = 0;
+                    IEC1bits.MI2C1IE = 1;
+                } else {
+                    IFS1bits.SI2C1IF = 0;
+                    IEC1bits.SI2C1IE = 1;
+                }
+            }
             break;
+        #ifdef CONFIG_I2C2_ENABLED
         case I2C_MODULE_2:
-            IEC3bits.I2C2BIE = 0;
+            IEC3bits.MI2C2IE = 0;
+            IEC3bits.SI2C2IE = 0;
+            if (enable) {
+                IPC12bits.MI2C2IP = 4;
+                IPC12bits.SI2C2IP = 4;
+                if (master) {
+                    IFS3bits.MI2C2IF = 0;
+                    IEC3bits.MI2C2IE = 1;
+                } else {
+                    IFS3bits.SI2C2IF = 0;
+                    IEC3bits.SI2C2IE = 1;
+                }
+            }
             break;
+        #endif
+        default: break;
     }
     
-    // Resetear estado
-    *_I2C_GetState(module) = I2C_STATE_IDLE;
-    *_I2C_GetBusyFlag(module) = false;
+    _I2C_GetConfig(module)->interrupt_enable = enable;
 }
 
 /**
  * @brief Genera condición START
  */
 bool I2C_Start(I2C_Module_t module) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
     volatile bool* busy = _I2C_GetBusyFlag(module);
     
     if (*busy) return false;
@@ -282,7 +854,7 @@ bool I2C_Start(I2C_Module_t module) {
     *_I2C_GetState(module) = I2C_STATE_BUSY;
     
     // Generar condición START
-    *i2c_con |= 0x0001;  // SEN = 1
+    regs->con |= I2C_CON_SEN;
     
     // Esperar a que se complete
     if (!_I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms)) {
@@ -297,10 +869,10 @@ bool I2C_Start(I2C_Module_t module) {
  * @brief Genera condición REPEATED START
  */
 bool I2C_Restart(I2C_Module_t module) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
     
     // Generar REPEATED START
-    *i2c_con |= 0x0002;  // RSEN = 1
+    regs->con |= I2C_CON_RSEN;
     
     // Esperar a que se complete
     return _I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms);
@@ -310,44 +882,63 @@ bool I2C_Restart(I2C_Module_t module) {
  * @brief Genera condición STOP
  */
 bool I2C_Stop(I2C_Module_t module) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
     volatile bool* busy = _I2C_GetBusyFlag(module);
     
+    volatile I2C_State_t* state = _I2C_GetState(module);
+    bool ok;
+    
     // Generar condición STOP
-    *i2c_con |= 0x0004;  // PEN = 1
+    regs->con |= I2C_CON_PEN;
     
     // Esperar a que se complete
-    if (!_I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms)) {
-        return false;
+    ok = _I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms);
+    if (ok) {
+        *state = I2C_STATE_IDLE;
+    } else if (*state != I2C_STATE_TIMEOUT) {
+        // I2COV/IWCOL: el STOP no llegó al bus, se fuerza por GPIO. Con
+        // timeout ya lo hizo _I2C_WaitCondition
+        I2C_RecoverBus(module);
     }
     
-    // Marcar como no ocupado
+    // Tras el STOP (o la recuperación) el bus queda libre: el módulo se
+    // libera también con error, si no I2C_Start y la cola quedarían parados.
+    // El estado conserva el error para I2C_GetState
     *busy = false;
-    *_I2C_GetState(module) = I2C_STATE_IDLE;
     
-    return true;
+    // Transacciones encoladas mientras se usaba la API bloqueante
+    if (_I2C_GetConfig(module)->interrupt_enable) {
+        bool irq = _I2C_MasterIrqDisable(module);
+        if (_I2C_GetEngine(module)->phase == I2C_PHASE_IDLE) {
+            _I2C_StartNext(module, false);
+        }
+        _I2C_MasterIrqRestore(module, irq);
+    }
+    
+    return ok;
 }
 
 /**
- * @brief Escribe un byte en el bus
+ * @brief Envía un byte y espera su ACK, sin contar el NACK en las estadísticas
  */
-bool I2C_WriteByte(I2C_Module_t module, uint8_t data) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    volatile uint16_t* i2c_trn = i2c_con + 5;  // I2CxTRN
-    
-    // Escribir dato en buffer de transmisión
-    *i2c_trn = data;
+static bool _I2C_SendByte(I2C_Module_t module, uint8_t data) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
     
-    // Iniciar transmisión
-    *i2c_con |= 0x0008;  // RCEN = 0, PEN = 0, SEN = 0, RSEN = 0, ACKEN = 0
+    // Escribir dato en buffer de transmisión (inicia la transmisión)
+    regs->trn = data;
+    if (regs->stat & I2C_STAT_IWCOL) {
+        regs->stat &= ~I2C_STAT_IWCOL;
+        *_I2C_GetState(module) = I2C_STATE_BUS_COLLISION;
+        return false;
+    }
     
-    // Esperar a que se complete
-    if (!_I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms)) {
+    // Esperar a que se complete (8 bits + ACK)
+    if (!_I2C_WaitTransmit(module, _I2C_GetConfig(module)->timeout_ms)) {
         return false;
     }
     
     // Verificar ACK
-    if (*i2c_con & (1 << 15)) {  // ACKSTAT = 1 (NACK recibido)
+    if (regs->stat & I2C_STAT_ACKSTAT) {  // ACKSTAT = 1 (NACK recibido)
         *_I2C_GetState(module) = I2C_STATE_DATA_NACK;
         return false;
     }
@@ -356,43 +947,89 @@ bool I2C_WriteByte(I2C_Module_t module, uint8_t data) {
 }
 
 /**
- * @brief Lee un byte del bus
+ * @brief Escribe un byte en el bus
  */
-uint8_t I2C_ReadByte(I2C_Module_t module, bool ack) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    volatile uint16_t* i2c_rcv = i2c_con + 6;  // I2CxRCV
-    
-    // Configurar recepción
-    if (ack) {
-        *i2c_con &= ~(1 << 4);  // ACKDT = 0 (ACK)
-    } else {
-        *i2c_con |= (1 << 4);   // ACKDT = 1 (NACK)
+bool I2C_WriteByte(I2C_Module_t module, uint8_t data) {
+    if (_I2C_SendByte(module, data)) {
+        return true;
+    }
+    if (*_I2C_GetState(module) == I2C_STATE_DATA_NACK) {
+        _I2C_GetStats(module)->nacks++;
     }
+    return false;
+}
+
+/**
+ * @brief Recibe un byte y responde ACK/NACK; false si falla la recepción
+ *
+ * Si RCEN no termina (timeout, el bus ya se recuperó) no se genera la
+ * secuencia ACK: no hay byte al que responder.
+ */
+static bool _I2C_ReceiveByte(I2C_Module_t module, bool ack, uint8_t* data) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
     
     // Iniciar recepción
-    *i2c_con |= 0x0008;  // RCEN = 1
+    regs->con |= I2C_CON_RCEN;
     
     // Esperar a que se complete
-    _I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms);
+    if (!_I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms)) {
+        *data = 0xFF;
+        return false;
+    }
     
     // Leer dato recibido
-    return (uint8_t)(*i2c_rcv & 0x00FF);
+    *data = (uint8_t)(regs->rcv & 0x00FF);
+    
+    // Responder ACK/NACK
+    return ack ? I2C_SendAck(module) : I2C_SendNack(module);
 }
 
 /**
- * @brief Escribe datos a un dispositivo esclavo
+ * @brief Lee un byte del bus (0xFF y estado de error si falla)
  */
-bool I2C_WriteData(I2C_Module_t module, uint8_t address, uint8_t *data, uint8_t length) {
-    if (length == 0 || data == NULL) return false;
-    
-    // Generar START
-    if (!I2C_Start(module)) return false;
+uint8_t I2C_ReadByte(I2C_Module_t module, bool ack) {
+    uint8_t data;
     
-    // Enviar dirección + bit de escritura
-    if (!I2C_WriteByte(module, (address << 1) | 0x00)) {
-        I2C_Stop(module);
-        return false;
-    }
+    _I2C_ReceiveByte(module, ack, &data);
+    return data;
+}
+
+/**
+ * @brief Envía ACK tras un byte recibido
+ */
+bool I2C_SendAck(I2C_Module_t module) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    
+    regs->con &= ~I2C_CON_ACKDT;  // ACKDT = 0 (ACK)
+    regs->con |= I2C_CON_ACKEN;
+    return _I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms);
+}
+
+/**
+ * @brief Envía NACK tras un byte recibido (último byte de una lectura)
+ */
+bool I2C_SendNack(I2C_Module_t module) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    
+    regs->con |= I2C_CON_ACKDT;   // ACKDT = 1 (NACK)
+    regs->con |= I2C_CON_ACKEN;
+    return _I2C_WaitCondition(module, _I2C_GetConfig(module)->timeout_ms);
+}
+
+/**
+ * @brief Escribe datos a un dispositivo esclavo
+ */
+bool I2C_WriteData(I2C_Module_t module, uint8_t address, uint8_t *data, uint8_t length) {
+    if (length == 0 || data == NULL) return false;
+    
+    // Generar START
+    if (!I2C_Start(module)) return false;
+    
+    // Enviar dirección + bit de escritura
+    if (!I2C_WriteByte(module, (address << 1) | 0x00)) {
+        I2C_Stop(module);
+        return false;
+    }
     
     // Enviar datos
     for (uint8_t i = 0; i < length; i++) {
@@ -424,7 +1061,78 @@ bool I2C_ReadData(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint8_t
     // Leer datos
     for (uint8_t i = 0; i < length; i++) {
         bool ack = (i < length - 1);  // ACK en todos menos el último
-        buffer[i] = I2C_ReadByte(module, ack);
+        if (!_I2C_ReceiveByte(module, ack, &buffer[i])) {
+            I2C_Stop(module);
+            return false;
+        }
+    }
+    
+    // Generar STOP
+    return I2C_Stop(module);
+}
+
+/**
+ * @brief Transferencia bloqueante en formato combinado
+ *
+ * START, dirección+W, 'reg' (reg_length bytes, el más significativo
+ * primero), datos; si hay lectura, REPEATED START, dirección+R y lectura
+ * con NACK en el último byte; STOP. El puntero de registro del esclavo no
+ * se pierde porque el bus no se suelta entre escritura y lectura. Sin
+ * registro ni datos que escribir, la lectura empieza directamente tras START.
+ */
+static bool _I2C_RegisterTransfer(I2C_Module_t module, uint8_t dev_addr,
+                                  uint16_t reg, uint8_t reg_length,
+                                  const uint8_t *wdata, uint16_t wlength,
+                                  uint8_t *rdata, uint16_t rlength) {
+    bool write_phase = (reg_length > 0 || wlength > 0 || rlength == 0);
+    
+    // Generar START
+    if (!I2C_Start(module)) return false;
+    
+    if (write_phase) {
+        // Dirección + bit de escritura
+        if (!I2C_WriteByte(module, (dev_addr << 1) | 0x00)) {
+            I2C_Stop(module);
+            return false;
+        }
+        
+        // Dirección de registro
+        while (reg_length > 0) {
+            reg_length--;
+            if (!I2C_WriteByte(module, (uint8_t)(reg >> (8 * reg_length)))) {
+                I2C_Stop(module);
+                return false;
+            }
+        }
+        
+        // Datos
+        for (uint16_t i = 0; i < wlength; i++) {
+            if (!I2C_WriteByte(module, wdata[i])) {
+                I2C_Stop(module);
+                return false;
+            }
+        }
+        
+        // REPEATED START para la lectura
+        if (rlength > 0 && !I2C_Restart(module)) {
+            I2C_Stop(module);
+            return false;
+        }
+    }
+    
+    if (rlength > 0) {
+        // Dirección + bit de lectura
+        if (!I2C_WriteByte(module, (dev_addr << 1) | 0x01)) {
+            I2C_Stop(module);
+            return false;
+        }
+        
+        for (uint16_t i = 0; i < rlength; i++) {
+            if (!_I2C_ReceiveByte(module, i < rlength - 1, &rdata[i])) {
+                I2C_Stop(module);
+                return false;
+            }
+        }
     }
     
     // Generar STOP
@@ -435,27 +1143,79 @@ bool I2C_ReadData(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint8_t
  * @brief Escribe a un registro específico
  */
 bool I2C_WriteRegister(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr, uint8_t data) {
-    uint8_t buffer[2] = {reg_addr, data};
-    return I2C_WriteData(module, dev_addr, buffer, 2);
+    return _I2C_RegisterTransfer(module, dev_addr, reg_addr, 1, &data, 1, NULL, 0);
 }
 
 /**
- * @brief Lee de un registro específico
+ * @brief Lee de un registro específico (REPEATED START, sin STOP intermedio)
  */
 uint8_t I2C_ReadRegister(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr) {
     uint8_t value = 0;
     
-    // Primero escribir la dirección del registro
-    if (!I2C_WriteData(module, dev_addr, &reg_addr, 1)) {
+    if (!_I2C_RegisterTransfer(module, dev_addr, reg_addr, 1, NULL, 0, &value, 1)) {
         return 0;
     }
     
-    // Luego leer el valor
-    I2C_ReadData(module, dev_addr, &value, 1);
-    
     return value;
 }
 
+/**
+ * @brief Escribe 'length' registros consecutivos desde reg_addr
+ *
+ * El esclavo debe autoincrementar su puntero de registro.
+ */
+bool I2C_WriteRegisters(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr,
+                        const uint8_t *data, uint16_t length) {
+    if (length == 0 || data == NULL) return false;
+    return _I2C_RegisterTransfer(module, dev_addr, reg_addr, 1, data, length, NULL, 0);
+}
+
+/**
+ * @brief Lee 'length' registros consecutivos desde reg_addr
+ */
+bool I2C_ReadRegisters(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr,
+                       uint8_t *buffer, uint16_t length) {
+    if (length == 0 || buffer == NULL) return false;
+    return _I2C_RegisterTransfer(module, dev_addr, reg_addr, 1, NULL, 0, buffer, length);
+}
+
+/**
+ * @brief Escritura con dirección de registro de 16 bits (p. ej. 24LC256)
+ *
+ * La dirección se envía en big-endian. No parte en páginas: en una EEPROM
+ * una escritura que cruza el límite de página vuelve al inicio de la página.
+ */
+bool I2C_WriteRegisters16(I2C_Module_t module, uint8_t dev_addr, uint16_t reg_addr,
+                          const uint8_t *data, uint16_t length) {
+    if (length == 0 || data == NULL) return false;
+    return _I2C_RegisterTransfer(module, dev_addr, reg_addr, 2, data, length, NULL, 0);
+}
+
+/**
+ * @brief Lectura con dirección de registro de 16 bits (p. ej. 24LC256)
+ */
+bool I2C_ReadRegisters16(I2C_Module_t module, uint8_t dev_addr, uint16_t reg_addr,
+                         uint8_t *buffer, uint16_t length) {
+    if (length == 0 || buffer == NULL) return false;
+    return _I2C_RegisterTransfer(module, dev_addr, reg_addr, 2, NULL, 0, buffer, length);
+}
+
+/**
+ * @brief Escribe un buffer de hasta 64 KB en una sola transacción
+ */
+bool I2C_WriteBuffer(I2C_Module_t module, uint8_t address, uint8_t *data, uint16_t length) {
+    if (length == 0 || data == NULL) return false;
+    return _I2C_RegisterTransfer(module, address, 0, 0, data, length, NULL, 0);
+}
+
+/**
+ * @brief Lee un buffer de hasta 64 KB en una sola transacción
+ */
+bool I2C_ReadBuffer(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint16_t length) {
+    if (length == 0 || buffer == NULL) return false;
+    return _I2C_RegisterTransfer(module, address, 0, 0, NULL, 0, buffer, length);
+}
+
 /**
  * @brief Escanea el bus I2C buscando dispositivos
  */
@@ -490,57 +1250,578 @@ bool I2C_CheckDevice(I2C_Module_t module, uint8_t address) {
     return success;
 }
 
+/**
+ * @brief Sondeo de fin de ciclo interno (ACK polling de una EEPROM)
+ *
+ * Igual que I2C_CheckDevice, pero el NACK es la respuesta esperada mientras
+ * el chip graba: se cuenta en 'busy_polls', no en 'nacks'.
+ */
+bool I2C_PollDevice(I2C_Module_t module, uint8_t address) {
+    bool success;
+    
+    if (!I2C_Start(module)) return false;
+    
+    success = _I2C_SendByte(module, (address << 1) | 0x00);
+    if (!success && *_I2C_GetState(module) == I2C_STATE_DATA_NACK) {
+        _I2C_GetStats(module)->busy_polls++;
+    }
+    
+    I2C_Stop(module);
+    
+    return success;
+}
+
 /**
  * @brief Configura callback para interrupciones
  */
 void I2C_SetCallback(I2C_Module_t module, I2C_Callback_t callback) {
-    switch(module) {
+    switch(I2C_MODULE_SEL(module)) {
         case I2C_MODULE_1:
             i2c1_callback = callback;
             break;
+        #ifdef CONFIG_I2C2_ENABLED
         case I2C_MODULE_2:
             i2c2_callback = callback;
             break;
+        #endif
+        default: break;
+    }
+}
+
+/**
+ * @brief Evento SI2Cx con banco de registros
+ *
+ * Protocolo: START, dirección+W, índice y, opcionalmente, datos que se
+ * escriben desde ese registro; la lectura (normalmente tras REPEATED START)
+ * devuelve registros desde el índice. El índice se autoincrementa y da la
+ * vuelta al final del banco. SCL queda retenido (clock stretching) desde el
+ * fin de cada byte hasta que esta rutina ha preparado o guardado el dato.
+ * El cambio de banco pedido por I2C_SlavePublish se aplica en un byte de
+ * dirección, así que una lectura nunca mezcla dos instantáneas. Cada dato
+ * escrito por el maestro se notifica al callback (I2C_EVENT_DATA_RECEIVED).
+ */
+static void _I2C_SlaveRegMapEvent(I2C_Module_t module, I2C_Callback_t callback) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    I2C_Slave_t* slave = _I2C_GetSlave(module);
+    uint16_t stat = regs->stat;
+    uint8_t data;
+    
+    if (!(stat & I2C_STAT_DA)) {
+        // Byte de dirección
+        data = (uint8_t)(regs->rcv & 0x00FF);
+        slave->last_address = data >> 1;
+        slave->addressed = true;
+        if (slave->swap_pending) {
+            slave->front ^= 1;
+            slave->swap_pending = false;
+        }
+        if (!(stat & I2C_STAT_RW)) {
+            slave->expect_index = true;
+            regs->con |= I2C_CON_SCLREL;
+            return;
+        }
+    }
+    else if (!(stat & I2C_STAT_RW)) {
+        // Byte escrito por el maestro: índice o dato
+        data = (uint8_t)(regs->rcv & 0x00FF);
+        if (slave->expect_index) {
+            slave->index = (data < slave->size) ? data : 0;
+            slave->expect_index = false;
+        } else {
+            // En las dos copias: la aplicación no lo pierde al publicar
+            slave->bank[0][slave->index] = data;
+            slave->bank[1][slave->index] = data;
+            if (++slave->index >= slave->size) slave->index = 0;
+            if (callback != NULL) {
+                callback(I2C_EVENT_DATA_RECEIVED, data);
+            }
+        }
+        regs->con |= I2C_CON_SCLREL;
+        return;
+    }
+    else if (stat & I2C_STAT_ACKSTAT) {
+        // NACK del maestro: fin de la lectura, no se carga más
+        return;
+    }
+    
+    // Lectura: siguiente registro del banco visible
+    regs->trn = slave->bank[slave->front][slave->index];
+    if (++slave->index >= slave->size) slave->index = 0;
+    regs->con |= I2C_CON_SCLREL;
+}
+
+/**
+ * @brief Eventos de esclavo (interrupción SI2Cx)
+ */
+static void _I2C_SlaveEvent(I2C_Module_t module, I2C_Callback_t callback) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    I2C_Slave_t* slave = _I2C_GetSlave(module);
+    uint16_t stat = regs->stat;
+    uint8_t data;
+    
+    if (slave->size > 0) {
+        _I2C_SlaveRegMapEvent(module, callback);
+        return;
+    }
+    
+    if (callback == NULL) {
+        // Sin callback: vaciar RBF para no bloquear el bus
+        if (stat & I2C_STAT_RBF) (void)regs->rcv;
+        regs->con |= I2C_CON_SCLREL;
+        return;
+    }
+    
+    if (!(stat & I2C_STAT_DA)) {
+        // Byte de dirección: comienzo de una transferencia hacia nosotros
+        data = (uint8_t)(regs->rcv & 0x00FF);
+        slave->last_address = data >> 1;
+        callback(I2C_EVENT_START, 0);
+        callback(I2C_EVENT_ADDR_RECEIVED, data >> 1);
+        if (stat & I2C_STAT_RW) {
+            callback(I2C_EVENT_DATA_REQUESTED, 0);  // responder con I2C_PutByte
+        } else {
+            regs->con |= I2C_CON_SCLREL;
+        }
+    }
+    else if (!(stat & I2C_STAT_RW)) {  // Datos recibidos
+        data = (uint8_t)(regs->rcv & 0x00FF);
+        callback(I2C_EVENT_DATA_RECEIVED, data);
+        regs->con |= I2C_CON_SCLREL;  // Fin del clock stretching (STREN)
+    }
+    else if (stat & I2C_STAT_ACKSTAT) {  // El maestro terminó la lectura (NACK)
+        callback(I2C_EVENT_STOP, 0);
+    }
+    else {  // Solicitud de datos
+        callback(I2C_EVENT_DATA_REQUESTED, 0);
     }
 }
 
 /**
  * @brief Handler de interrupción I2C
+ *
+ * Llamar desde _MI2CxInterrupt y _SI2CxInterrupt. En modo maestro avanza el
+ * motor de transacciones (I2C_Submit); en esclavo entrega eventos al callback.
  */
 void I2C_ISR_Handler(I2C_Module_t module) {
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    volatile uint16_t* i2c_stat = i2c_con + 1;
     I2C_Callback_t callback = NULL;
+    bool master = (_I2C_GetConfig(module)->mode == I2C_MODE_MASTER);
     
-    // Obtener callback
-    switch(module) {
+    // Obtener callback y limpiar flag
+    switch(I2C_MODULE_SEL(module)) {
         case I2C_MODULE_1:
             callback = i2c1_callback;
-            IFS1bits.I2C1BIF = 0;  // Limpiar flag
+            if (master) IFS1bits.MI2C1IF = 0;
+            else        IFS1bits.SI2C1IF = 0;
             break;
+        #ifdef CONFIG_I2C2_ENABLED
         case I2C_MODULE_2:
             callback = i2c2_callback;
-            IFS3bits.I2C2BIF = 0;  // Limpiar flag
+            if (master) IFS3bits.MI2C2IF = 0;
+            else        IFS3bits.SI2C2IF = 0;
             break;
+        #endif
+        default: break;
     }
     
-    if (callback == NULL) return;
+    if (master) {
+        _I2C_MasterEngine(module);
+    } else {
+        _I2C_SlaveEvent(module, callback);
+    }
+}
+
+/**
+ * @brief Bloquea la interrupción SI2Cx y devuelve si estaba habilitada
+ */
+static bool _I2C_SlaveIrqDisable(I2C_Module_t module) {
+    bool was_enabled = false;
     
-    // Determinar evento
-    if (*i2c_stat & (1 << 15)) {  // Start bit detectado
-        callback(I2C_EVENT_START, 0);
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1:
+            was_enabled = IEC1bits.SI2C1IE;
+            IEC1bits.SI2C1IE = 0;
+            break;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2:
+            was_enabled = IEC3bits.SI2C2IE;
+            IEC3bits.SI2C2IE = 0;
+            break;
+        #endif
+        default: break;
     }
-    else if (*i2c_stat & (1 << 14)) {  // Stop bit detectado
-        callback(I2C_EVENT_STOP, 0);
+    return was_enabled;
+}
+
+/**
+ * @brief Restaura la interrupción SI2Cx
+ */
+static void _I2C_SlaveIrqRestore(I2C_Module_t module, bool was_enabled) {
+    if (!was_enabled) return;
+    
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1: IEC1bits.SI2C1IE = 1; break;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2: IEC3bits.SI2C2IE = 1; break;
+        #endif
+        default: break;
     }
-    else if (*i2c_stat & (1 << 13)) {  // Datos recibidos
-        volatile uint16_t* i2c_rcv = i2c_con + 6;
-        uint8_t data = (uint8_t)(*i2c_rcv & 0x00FF);
-        callback(I2C_EVENT_DATA_RECEIVED, data);
+}
+
+/**
+ * @brief Aplica un cambio de banco pendiente si la transferencia terminó
+ *
+ * No hay interrupción en el STOP: se consulta el bit P. Llamar con SI2Cx
+ * bloqueada.
+ */
+static void _I2C_SlaveApplySwap(I2C_Module_t module) {
+    I2C_Slave_t* slave = _I2C_GetSlave(module);
+    
+    if (slave->addressed && (_I2C_GetRegs(module)->stat & I2C_STAT_P)) {
+        slave->addressed = false;  // STOP visto
     }
-    else if (*i2c_stat & (1 << 12)) {  // Solicitud de datos
-        callback(I2C_EVENT_DATA_REQUESTED, 0);
+    if (slave->swap_pending && !slave->addressed) {
+        slave->front ^= 1;
+        slave->swap_pending = false;
+    }
+}
+
+/**
+ * @brief Asocia un banco de registros al esclavo (llamar tras I2C_Init)
+ *
+ * Con bank_b != NULL el banco tiene doble buffer: el maestro lee una copia
+ * mientras la aplicación rellena la otra (I2C_SlaveGetBank) y la publica
+ * de golpe (I2C_SlavePublish). Con bank_b == NULL hay una sola copia y la
+ * aplicación escribe directamente sobre lo que ve el maestro. size = 0
+ * desactiva el banco y vuelve a los eventos por callback.
+ */
+void I2C_SlaveRegMapInit(I2C_Module_t module, uint8_t *bank_a, uint8_t *bank_b, uint8_t size) {
+    I2C_Slave_t* slave = _I2C_GetSlave(module);
+    bool irq = _I2C_SlaveIrqDisable(module);
+    
+    slave->bank[0] = bank_a;
+    slave->bank[1] = (bank_b != NULL) ? bank_b : bank_a;
+    slave->size = (bank_a != NULL) ? size : 0;
+    slave->front = 0;
+    slave->swap_pending = false;
+    slave->addressed = false;
+    slave->index = 0;
+    slave->expect_index = false;
+    
+    _I2C_SlaveIrqRestore(module, irq);
+}
+
+/**
+ * @brief Banco que puede modificar la aplicación
+ *
+ * Devuelve NULL mientras la última publicación no se haya aplicado (hay
+ * una lectura del maestro en curso): reintentar más tarde.
+ */
+uint8_t* I2C_SlaveGetBank(I2C_Module_t module) {
+    I2C_Slave_t* slave = _I2C_GetSlave(module);
+    uint8_t* bank = NULL;
+    bool irq;
+    
+    if (slave->size == 0) return NULL;
+    
+    irq = _I2C_SlaveIrqDisable(module);
+    _I2C_SlaveApplySwap(module);
+    if (!slave->swap_pending) {
+        bank = slave->bank[slave->front ^ 1];
+    }
+    _I2C_SlaveIrqRestore(module, irq);
+    
+    return bank;
+}
+
+/**
+ * @brief Hace visible al maestro el banco rellenado por la aplicación
+ *
+ * Si no hay una transferencia hacia nosotros en curso el cambio es
+ * inmediato; si no, se aplica tras su STOP o en el siguiente byte de
+ * dirección, lo que llegue antes.
+ */
+void I2C_SlavePublish(I2C_Module_t module) {
+    I2C_Slave_t* slave = _I2C_GetSlave(module);
+    bool irq;
+    
+    if (slave->size == 0 || slave->bank[0] == slave->bank[1]) return;
+    
+    irq = _I2C_SlaveIrqDisable(module);
+    slave->swap_pending = true;
+    _I2C_SlaveApplySwap(module);
+    _I2C_SlaveIrqRestore(module, irq);
+}
+
+/**
+ * @brief Cambia la dirección del esclavo (7-bit)
+ */
+void I2C_SetSlaveAddress(I2C_Module_t module, uint8_t address) {
+    _I2C_GetConfig(module)->slave_address = address;
+    _I2C_GetRegs(module)->add = address;
+}
+
+/**
+ * @brief Habilita/deshabilita la respuesta a general call (dirección 0x00)
+ */
+void I2C_EnableGeneralCall(I2C_Module_t module, bool enable) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    
+    _I2C_GetConfig(module)->general_call_enable = enable;
+    if (enable) {
+        regs->con |= I2C_CON_GCEN;
+    } else {
+        regs->con &= ~I2C_CON_GCEN;
+    }
+}
+
+/**
+ * @brief Última dirección recibida como esclavo (7-bit; 0 = general call)
+ */
+uint8_t I2C_GetReceivedAddress(I2C_Module_t module) {
+    return _I2C_GetSlave(module)->last_address;
+}
+
+/**
+ * @brief Indica si hay un byte recibido pendiente de leer (RBF)
+ */
+bool I2C_DataReady(I2C_Module_t module) {
+    return (_I2C_GetRegs(module)->stat & I2C_STAT_RBF) != 0;
+}
+
+/**
+ * @brief Lee el byte recibido y libera SCL
+ */
+uint8_t I2C_GetByte(I2C_Module_t module) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    uint8_t data = (uint8_t)(regs->rcv & 0x00FF);
+    
+    regs->con |= I2C_CON_SCLREL;
+    return data;
+}
+
+/**
+ * @brief Carga el byte a enviar al maestro y libera SCL
+ *
+ * Para usar desde el callback en I2C_EVENT_DATA_REQUESTED.
+ */
+void I2C_PutByte(I2C_Module_t module, uint8_t data) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    
+    regs->trn = data;
+    regs->con |= I2C_CON_SCLREL;
+}
+
+/**
+ * @brief Prepara una transacción (escritura, lectura o ambas)
+ *
+ * Con write_length > 0 y read_length > 0 se envía en formato combinado:
+ * START, dirección+W, datos, REPEATED START, dirección+R, lectura, STOP.
+ */
+void I2C_TransactionInit(I2C_Transaction_t *t, uint8_t address,
+                         const uint8_t *write_data, uint16_t write_length,
+                         uint8_t *read_data, uint16_t read_length,
+                         I2C_TransactionCallback_t callback, void *context) {
+    if (t == NULL) return;
+    
+    t->address = address;
+    t->write_data = write_data;
+    t->write_length = (write_data != NULL) ? write_length : 0;
+    t->read_data = read_data;
+    t->read_length = (read_data != NULL) ? read_length : 0;
+    t->callback = callback;
+    t->context = context;
+    t->keep_bus = false;
+    t->timeout_ms = 0;
+    t->result = I2C_STATE_IDLE;
+}
+
+/**
+ * @brief Encola una transacción y vuelve inmediatamente
+ *
+ * Si el motor está libre arranca ya; si no, la transacción sale de la cola
+ * en cuanto termina la anterior, desde la propia ISR. Devuelve false si la
+ * cola está llena, el módulo no es maestro o no tiene la interrupción
+ * habilitada. Al acabar, t->result pasa a SUCCESS o al error y se llama a
+ * t->callback desde la ISR. Se puede llamar también desde un callback.
+ */
+bool I2C_Submit(I2C_Module_t module, I2C_Transaction_t *t) {
+    return I2C_SubmitBatch(module, t, 1) == 1;
+}
+
+/**
+ * @brief Encola varias transacciones consecutivas de una vez
+ *
+ * Devuelve cuántas se encolaron (desde el principio de 'list'). Marcando
+ * keep_bus en todas menos la última, el lote se ejecuta con REPEATED START
+ * entre transacciones, sin soltar el bus.
+ */
+uint8_t I2C_SubmitBatch(I2C_Module_t module, I2C_Transaction_t *list, uint8_t count) {
+    I2C_Config_t* cfg = _I2C_GetConfig(module);
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    uint8_t queued = 0;
+    bool irq;
+    
+    if (list == NULL || cfg->mode != I2C_MODE_MASTER || !cfg->interrupt_enable) {
+        return 0;
+    }
+    
+    irq = _I2C_MasterIrqDisable(module);
+    
+    while (queued < count && (uint8_t)(eng->head - eng->tail) < I2C_QUEUE_LENGTH) {
+        list[queued].result = I2C_STATE_BUSY;
+        eng->queue[eng->head & I2C_QUEUE_MASK] = &list[queued];
+        eng->head++;
+        queued++;
+    }
+    
+    // Arrancar si no hay nada en curso (ni del motor ni de la API bloqueante)
+    if (queued > 0 && eng->phase == I2C_PHASE_IDLE && !*_I2C_GetBusyFlag(module)) {
+        _I2C_StartNext(module, false);
+    }
+    
+    _I2C_MasterIrqRestore(module, irq);
+    
+    return queued;
+}
+
+/**
+ * @brief Transacciones pendientes (en cola + en curso)
+ */
+uint16_t I2C_GetTxBufferCount(I2C_Module_t module) {
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    bool irq = _I2C_MasterIrqDisable(module);
+    uint16_t count = (uint8_t)(eng->head - eng->tail) + (eng->current != NULL ? 1 : 0);
+    
+    _I2C_MasterIrqRestore(module, irq);
+    return count;
+}
+
+/**
+ * @brief Transacciones pendientes que aún tienen que leer del bus
+ */
+uint16_t I2C_GetRxBufferCount(I2C_Module_t module) {
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    bool irq = _I2C_MasterIrqDisable(module);
+    uint16_t count = 0;
+    uint8_t i;
+    
+    if (eng->current != NULL && eng->current->read_length > 0) {
+        count++;
+    }
+    for (i = eng->tail; i != eng->head; i++) {
+        if (eng->queue[i & I2C_QUEUE_MASK]->read_length > 0) {
+            count++;
+        }
+    }
+    
+    _I2C_MasterIrqRestore(module, irq);
+    return count;
+}
+
+/**
+ * @brief Indica si una transacción lanzada con I2C_Submit terminó
+ */
+bool I2C_TransactionDone(const I2C_Transaction_t *t) {
+    return (t != NULL) && (t->result != I2C_STATE_BUSY);
+}
+
+/**
+ * @brief Vigila la transacción no bloqueante en curso
+ *
+ * Llamar periódicamente desde el bucle principal. Si la transacción lleva
+ * más de timeout_ms sin terminar (esclavo reteniendo SCL o SDA, interrupción
+ * perdida; t->timeout_ms si no es 0) se recupera el bus, se entrega
+ * I2C_STATE_TIMEOUT con su callback
+ * y se arranca la siguiente de la cola. Devuelve true si abortó alguna.
+ */
+bool I2C_CheckTimeout(I2C_Module_t module) {
+    I2C_Engine_t* eng = _I2C_GetEngine(module);
+    bool expired = false;
+    bool irq = _I2C_MasterIrqDisable(module);
+    
+    if (eng->current != NULL &&
+        _I2C_Expired(eng->start_tick, eng->current->timeout_ms != 0 ?
+                     eng->current->timeout_ms : _I2C_GetConfig(module)->timeout_ms)) {
+        expired = true;
+        I2C_RecoverBus(module);
+        _I2C_FinishTransaction(module, I2C_STATE_TIMEOUT);
+    }
+    
+    _I2C_MasterIrqRestore(module, irq);
+    return expired;
+}
+
+/**
+ * @brief Fin de un sondeo del escaneo: anota y encola la siguiente dirección
+ *
+ * Se ejecuta en la ISR (o en I2C_CheckTimeout si la dirección no responde
+ * a tiempo).
+ */
+static void _I2C_ScanStep(I2C_Transaction_t *t) {
+    I2C_Scan_t* scan = (I2C_Scan_t*)t->context;
+    
+    if (t->result == I2C_STATE_SUCCESS) {
+        scan->bitmap[t->address >> 3] |= (uint8_t)(1u << (t->address & 0x07));
+        scan->found++;
+    }
+    
+    if (t->address < I2C_SCAN_LAST_ADDRESS) {
+        t->address++;
+        if (I2C_Submit(scan->module, t)) return;
+    }
+    scan->running = false;
+}
+
+/**
+ * @brief Arranca un escaneo del bus sobre el motor por interrupción
+ *
+ * Sondea de I2C_SCAN_FIRST_ADDRESS a I2C_SCAN_LAST_ADDRESS (START,
+ * dirección+W, STOP) y marca en 'bitmap' (I2C_SCAN_BITMAP_SIZE bytes) las
+ * que responden con ACK. Vuelve enseguida; el progreso se consulta con
+ * I2C_ScanDone. Requiere maestro con interrupt_enable.
+ */
+bool I2C_ScanStart(I2C_Module_t module, uint8_t *bitmap) {
+    I2C_Scan_t* scan = _I2C_GetScan(module);
+    
+    if (bitmap == NULL || scan->running) return false;
+    
+    memset(bitmap, 0, I2C_SCAN_BITMAP_SIZE);
+    scan->module = module;
+    scan->bitmap = bitmap;
+    scan->found = 0;
+    
+    I2C_TransactionInit(&scan->probe, I2C_SCAN_FIRST_ADDRESS, NULL, 0, NULL, 0,
+                        _I2C_ScanStep, scan);
+    scan->probe.timeout_ms = I2C_SCAN_TIMEOUT_MS;
+    
+    scan->running = true;
+    if (!I2C_Submit(module, &scan->probe)) {
+        scan->running = false;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Indica si el escaneo terminó (llamar periódicamente)
+ *
+ * Aplica también el timeout por dirección (I2C_CheckTimeout), así que no
+ * hace falta vigilar el módulo aparte mientras dura el escaneo.
+ */
+bool I2C_ScanDone(I2C_Module_t module) {
+    I2C_Scan_t* scan = _I2C_GetScan(module);
+    
+    if (scan->running) {
+        I2C_CheckTimeout(module);
     }
+    return !scan->running;
+}
+
+/**
+ * @brief Dispositivos encontrados en el último escaneo
+ */
+uint8_t I2C_ScanGetCount(I2C_Module_t module) {
+    return _I2C_GetScan(module)->found;
 }
 
 /**
@@ -553,7 +1834,8 @@ void I2C_PrintConfig(I2C_Module_t module) {
     printf("Modo: %s\n", cfg->mode == I2C_MODE_MASTER ? "Maestro" : 
                          cfg->mode == I2C_MODE_SLAVE_7BIT ? "Esclavo 7-bit" : 
                          "Esclavo 10-bit");
-    printf("Velocidad: %lu Hz\n", cfg->speed);
+    printf("Velocidad: %lu Hz (real %lu Hz)\n", (unsigned long)cfg->speed,
+           (unsigned long)I2C_GetActualSpeed(module));
     printf("Dirección esclavo: 0x%02X\n", cfg->slave_address);
     printf("Timeout: %d ms\n", cfg->timeout_ms);
     printf("General Call: %s\n", cfg->general_call_enable ? "Habilitado" : "Deshabilitado");
@@ -566,14 +1848,140 @@ void I2C_PrintConfig(I2C_Module_t module) {
  * @brief Espera a que el bus esté libre
  */
 bool I2C_WaitIdle(I2C_Module_t module, uint16_t timeout_ms) {
-    volatile uint16_t* i2c_stat = _I2C_GetModuleBase(module) + 1;
-    uint32_t timeout_counter = timeout_ms * 1000;
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    uint32_t start = SYSTEM_GetTickMs();
     
-    while ((*i2c_stat & (1 << 14)) && timeout_counter--) {
-        // Esperar activamente
+    while ((regs->con & I2C_CON_BUSY_MASK) || (regs->stat & I2C_STAT_TRSTAT)) {
+        if (_I2C_Expired(start, timeout_ms)) {
+            return false;
+        }
     }
     
-    return (timeout_counter > 0);
+    return true;
+}
+
+/**
+ * @brief Libera el bus cuando un esclavo quedó reteniendo SDA
+ *
+ * Pasa si se cortó una transferencia a medias (reset del maestro, ruido):
+ * el esclavo sigue esperando reloj para terminar su byte y mantiene SDA a
+ * nivel bajo. Con el módulo deshabilitado (pines como GPIO) se generan hasta
+ * 9 pulsos de SCL, hasta que SDA sube, y después un STOP manual. Al final se
+ * restaura I2CxCON sin secuencias pendientes; la cola de transacciones no se
+ * toca. Devuelve false si SCL sigue retenido o SDA no se libera.
+ */
+bool I2C_RecoverBus(I2C_Module_t module) {
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    uint16_t con = regs->con & ~(I2C_CON_BUSY_MASK | I2C_CON_ACKDT);
+    uint32_t start;
+    bool ok;
+    
+    _I2C_GetStats(module)->recoveries++;
+    
+    // Deshabilitar el módulo: los pines vuelven a ser GPIO
+    regs->con = 0x0000;
+    _I2C_ConfigurePins(module);
+    I2C_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+    
+    for (uint8_t i = 0; i < 9 && !_I2C_ReadSDA(module); i++) {
+        _I2C_DriveSCL(module, false);
+        I2C_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+        _I2C_DriveSCL(module, true);
+        I2C_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+        
+        // Respetar clock stretching del esclavo
+        start = SYSTEM_GetTickMs();
+        while (!_I2C_ReadSCL(module) && !_I2C_Expired(start, 1)) {
+        }
+    }
+    
+    // STOP: SDA sube mientras SCL está alto
+    _I2C_DriveSCL(module, false);
+    I2C_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+    _I2C_DriveSDA(module, false);
+    I2C_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+    _I2C_DriveSCL(module, true);
+    I2C_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+    _I2C_DriveSDA(module, true);
+    I2C_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+    
+    ok = _I2C_ReadSCL(module) && _I2C_ReadSDA(module);
+    
+    // Volver a habilitar el módulo con la misma configuración
+    regs->stat &= ~(I2C_STAT_I2COV | I2C_STAT_IWCOL | I2C_STAT_BCL);
+    regs->con = con;
+    
+    // Descartar eventos espurios del re-enable
+    switch(I2C_MODULE_SEL(module)) {
+        case I2C_MODULE_1:
+            IFS1bits.MI2C1IF = 0;
+            IFS1bits.SI2C1IF = 0;
+            break;
+        #ifdef CONFIG_I2C2_ENABLED
+        case I2C_MODULE_2:
+            IFS3bits.MI2C2IF = 0;
+            IFS3bits.SI2C2IF = 0;
+            break;
+        #endif
+        default: break;
+    }
+    
+    return ok;
+}
+
+/**
+ * @brief Cambia el timeout de las esperas y de las transacciones en cola
+ */
+void I2C_SetTimeout(I2C_Module_t module, uint16_t timeout_ms) {
+    _I2C_GetConfig(module)->timeout_ms = timeout_ms;
+}
+
+/**
+ * @brief Calcula I2CxBRG para una velocidad de SCL
+ *
+ * Ecuación del datasheet con el retardo del pulse gobbler (Tpgd = 100 ns):
+ *     BRG = (Fcy / Fscl - Fcy / 10 000 000) - 1
+ * Se redondea hacia arriba para que el SCL real nunca supere el pedido.
+ * A 40 MIPS: 100 kHz -> 395, 400 kHz -> 95, 1 MHz -> 35.
+ */
+uint32_t I2C_CalculateBaudRate(uint32_t fcy, uint32_t desired_speed) {
+    uint64_t num, den;
+    uint32_t brg;
+    
+    if (desired_speed == 0 || desired_speed >= I2C_PGD_DIVISOR) return I2C_BRG_MAX;
+    
+    // (Fcy / Fscl - Fcy / 10^7) = Fcy * (10^7 - Fscl) / (Fscl * 10^7)
+    num = (uint64_t)fcy * (I2C_PGD_DIVISOR - desired_speed);
+    den = (uint64_t)desired_speed * I2C_PGD_DIVISOR;
+    brg = (uint32_t)((num + den - 1) / den);
+    brg = (brg > 0) ? brg - 1 : 0;
+    
+    if (brg > I2C_BRG_MAX) brg = I2C_BRG_MAX;
+    if (brg < I2C_BRG_MIN) brg = I2C_BRG_MIN;  // 0 y 1 no están soportados
+    
+    return brg;
+}
+
+/**
+ * @brief Frecuencia de SCL que consigue el BRG programado en el módulo
+ */
+uint32_t I2C_GetActualSpeed(I2C_Module_t module) {
+    return _I2C_BRGToSpeed(SYSTEM_GetClockFrequency(), _I2C_GetRegs(module)->brg);
+}
+
+/**
+ * @brief Retardo activo en microsegundos
+ *
+ * Con el FCY real del sistema, redondeado al ciclo más cercano como el BRG:
+ * FCY / 1000000 truncado daría 39 ciclos por us a 39.92 MHz.
+ */
+void I2C_DelayUs(uint16_t microseconds) {
+    uint32_t cycles = (uint32_t)(((uint64_t)microseconds * SYSTEM_GetClockFrequency() +
+                                  500000u) / 1000000u);
+
+    if (cycles != 0u) {
+        __delay32(cycles);
+    }
 }
 
 /**
@@ -583,6 +1991,48 @@ I2C_State_t I2C_GetLastError(I2C_Module_t module) {
     return *_I2C_GetState(module);
 }
 
+/**
+ * @brief Copia los contadores del módulo
+ *
+ * transactions es de 32 bits y lo incrementa la ISR MI2Cx: se lee con
+ * la interrupción del maestro deshabilitada.
+ */
+void I2C_GetStats(I2C_Module_t module, I2C_Stats_t *stats) {
+    bool ie;
+    
+    if (stats == NULL) return;
+    
+    ie = _I2C_MasterIrqDisable(module);
+    *stats = *(const I2C_Stats_t*)_I2C_GetStats(module);
+    _I2C_MasterIrqRestore(module, ie);
+}
+
+/**
+ * @brief Suma un resultado con error a los contadores del módulo
+ *
+ * Para las variantes de i2c_inline.h, que no ven los contadores privados:
+ * así I2C_GetStats (y las métricas) cuentan igual por las dos vías.
+ */
+void I2C_CountError(I2C_Module_t module, I2C_State_t result) {
+    _I2C_CountError(module, result);
+}
+
+/**
+ * @brief Pone a cero los contadores del módulo
+ */
+void I2C_ResetStats(I2C_Module_t module) {
+    volatile I2C_Stats_t* st = _I2C_GetStats(module);
+    bool ie = _I2C_MasterIrqDisable(module);
+    
+    st->transactions = 0;
+    st->nacks = 0;
+    st->timeouts = 0;
+    st->errors = 0;
+    st->recoveries = 0;
+    st->busy_polls = 0;
+    _I2C_MasterIrqRestore(module, ie);
+}
+
 /**
  * @brief Limpia errores
  */
@@ -590,8 +2040,8 @@ void I2C_ClearErrors(I2C_Module_t module) {
     *_I2C_GetState(module) = I2C_STATE_IDLE;
     
     // Limpiar flags de error en el módulo
-    volatile uint16_t* i2c_con = _I2C_GetModuleBase(module);
-    *i2c_con &= ~((1 << 9) | (1 << 8));  // Limpiar I2COV e IWCOL
+    volatile I2C_Regs_t* regs = _I2C_GetRegs(module);
+    regs->stat &= ~(I2C_STAT_I2COV | I2C_STAT_IWCOL | I2C_STAT_BCL);
 }
 
 /**
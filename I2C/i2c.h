@@ -8,11 +8,11 @@
  *              maestro y esclavo, operaciones síncronas y asíncronas.
  * 
  * Características:
- * - Soporte maestro/esclavo
- * - Clock de 100kHz y 400kHz
- * - Transmisiones síncronas y asíncronas
- * - Buffer para recepción
- * - Timeout y manejo de errores
+ * - Soporte maestro/esclavo (esclavo con banco de registros y doble buffer)
+ * - Clock de 100kHz, 400kHz y 1MHz (BRG calculado desde FCY)
+ * - Transmisiones síncronas y asíncronas (motor por interrupción MI2Cx)
+ * - Cola de transacciones por módulo
+ * - Timeouts con el tick del sistema (SYSTEM_GetTickMs) y recuperación del bus
  * - Compatible con SMBus/PMBus
  * 
  ******************************************************************************/
@@ -24,11 +24,26 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "config.h"
 
 // =============================================================================
 // DEFINICIONES DE CONFIGURACIÓN
 // =============================================================================
 
+// Módulos presentes en el dispositivo (config.h, opción 11). Con uno solo,
+// i2c.c resuelve el módulo al compilar y usa sus registros directamente.
+#if !defined(CONFIG_I2C1_ENABLED) && !defined(CONFIG_I2C2_ENABLED)
+#error "Habilitar CONFIG_I2C1_ENABLED y/o CONFIG_I2C2_ENABLED en config.h"
+#endif
+
+#if defined(CONFIG_I2C1_ENABLED) && defined(CONFIG_I2C2_ENABLED)
+#define I2C_MODULE_ENABLED(m)  ((m) == I2C_MODULE_1 || (m) == I2C_MODULE_2)
+#elif defined(CONFIG_I2C1_ENABLED)
+#define I2C_MODULE_ENABLED(m)  ((m) == I2C_MODULE_1)
+#else
+#define I2C_MODULE_ENABLED(m)  ((m) == I2C_MODULE_2)
+#endif
+
 // Módulo I2C a usar (I2C1 o I2C2)
 typedef enum {
     I2C_MODULE_1 = 1,
@@ -89,6 +104,75 @@ typedef enum {
 // Callback function type
 typedef void (*I2C_Callback_t)(I2C_Event_t event, uint8_t data);
 
+// Descriptor de transacción maestro no bloqueante (ver I2C_Submit)
+typedef struct I2C_Transaction I2C_Transaction_t;
+typedef void (*I2C_TransactionCallback_t)(I2C_Transaction_t *transaction);
+
+struct I2C_Transaction {
+    uint8_t address;                  // Dirección 7-bit del esclavo
+    const uint8_t *write_data;        // Bytes a escribir (o NULL)
+    uint16_t write_length;
+    uint8_t *read_data;               // Destino de la lectura (o NULL)
+    uint16_t read_length;
+    I2C_TransactionCallback_t callback; // Se llama desde la ISR al terminar
+    void *context;                    // Dato libre para el llamador
+    bool keep_bus;                    // Si hay otra en cola, seguir con RESTART (sin STOP)
+    uint16_t timeout_ms;              // Límite para I2C_CheckTimeout (0 = el del módulo)
+    volatile I2C_State_t result;      // BUSY mientras está en curso
+};
+
+// Contadores del módulo (I2C_GetStats). Los actualiza también la ISR.
+typedef struct {
+    uint32_t transactions;   // Transacciones no bloqueantes terminadas (cualquier resultado)
+    uint16_t nacks;          // NACK en dirección o dato (bloqueantes y no bloqueantes)
+    uint16_t timeouts;       // Esperas o transacciones abortadas por tiempo
+    uint16_t errors;         // Colisión, pérdida de arbitraje, overrun
+    uint16_t recoveries;     // Llamadas a I2C_RecoverBus
+    uint16_t busy_polls;     // NACK esperados en I2C_PollDevice (no cuentan en nacks)
+} I2C_Stats_t;
+
+// Profundidad de la cola de transacciones por módulo (potencia de 2)
+#ifndef I2C_QUEUE_LENGTH
+#define I2C_QUEUE_LENGTH 8
+#endif
+
+// Pines del bus, manejados como GPIO en I2C_RecoverBus. Deben ser los
+// SCLx/SDAx reales del encapsulado (dsPIC33FJ32MC204: SCL1 = RB8,
+// SDA1 = RB9; con ALTI2C = ON son ASCL1 = RB6, ASDA1 = RB5)
+#ifndef I2C1_SCL_TRIS
+#define I2C1_SCL_TRIS  TRISBbits.TRISB8
+#define I2C1_SCL_LAT   LATBbits.LATB8
+#define I2C1_SCL_PORT  PORTBbits.RB8
+#define I2C1_SDA_TRIS  TRISBbits.TRISB9
+#define I2C1_SDA_LAT   LATBbits.LATB9
+#define I2C1_SDA_PORT  PORTBbits.RB9
+#endif
+
+// I2C2 solo existe en dsPIC33F mayores (SCL2 = RA2, SDA2 = RA3)
+#ifndef I2C2_SCL_TRIS
+#define I2C2_SCL_TRIS  TRISAbits.TRISA2
+#define I2C2_SCL_LAT   LATAbits.LATA2
+#define I2C2_SCL_PORT  PORTAbits.RA2
+#define I2C2_SDA_TRIS  TRISAbits.TRISA3
+#define I2C2_SDA_LAT   LATAbits.LATA3
+#define I2C2_SDA_PORT  PORTAbits.RA3
+#endif
+
+// Semiperiodo de SCL durante la recuperación del bus (5 us = 100 kHz)
+#ifndef I2C_RECOVERY_HALF_PERIOD_US
+#define I2C_RECOVERY_HALF_PERIOD_US 5
+#endif
+
+// Escaneo no bloqueante: direcciones 7-bit válidas (se excluyen las reservadas)
+#define I2C_SCAN_FIRST_ADDRESS  0x08
+#define I2C_SCAN_LAST_ADDRESS   0x77
+#define I2C_SCAN_BITMAP_SIZE    16      // 128 direcciones, bit (addr & 7) de bitmap[addr >> 3]
+
+// Timeout por dirección durante el escaneo
+#ifndef I2C_SCAN_TIMEOUT_MS
+#define I2C_SCAN_TIMEOUT_MS 2
+#endif
+
 // Estructura de configuración
 typedef struct {
     I2C_Module_t module;      // Módulo I2C a usar
@@ -96,9 +180,9 @@ typedef struct {
     I2C_Speed_t speed;        // Velocidad del bus
     uint8_t slave_address;    // Dirección esclavo (7-bit)
     bool general_call_enable; // Habilitar general call
-    bool slew_rate_control;   // Control de slew rate
+    bool slew_rate_control;   // Slew rate automático (solo a 400 kHz); false = siempre off
     bool smbus_enable;        // Habilitar protocolo SMBus
-    uint16_t timeout_ms;      // Timeout en milisegundos
+    uint16_t timeout_ms;      // Timeout en milisegundos (tick del sistema)
     bool interrupt_enable;    // Habilitar interrupciones
     I2C_Callback_t callback;  // Función de callback
 } I2C_Config_t;
@@ -148,6 +232,7 @@ bool I2C_Start(I2C_Module_t module);
 bool I2C_Restart(I2C_Module_t module);
 bool I2C_Stop(I2C_Module_t module);
 bool I2C_WaitIdle(I2C_Module_t module, uint16_t timeout_ms);
+bool I2C_RecoverBus(I2C_Module_t module);
 
 // Operaciones maestro
 bool I2C_WriteByte(I2C_Module_t module, uint8_t data);
@@ -161,6 +246,16 @@ bool I2C_ReadData(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint8_t
 bool I2C_WriteRegister(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr, uint8_t data);
 uint8_t I2C_ReadRegister(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr);
 
+// Registros consecutivos en formato combinado (REPEATED START)
+bool I2C_WriteRegisters(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr,
+                        const uint8_t *data, uint16_t length);
+bool I2C_ReadRegisters(I2C_Module_t module, uint8_t dev_addr, uint8_t reg_addr,
+                       uint8_t *buffer, uint16_t length);
+bool I2C_WriteRegisters16(I2C_Module_t module, uint8_t dev_addr, uint16_t reg_addr,
+                          const uint8_t *data, uint16_t length);
+bool I2C_ReadRegisters16(I2C_Module_t module, uint8_t dev_addr, uint16_t reg_addr,
+                         uint8_t *buffer, uint16_t length);
+
 // Funciones esclavo
 void I2C_SetSlaveAddress(I2C_Module_t module, uint8_t address);
 void I2C_EnableGeneralCall(I2C_Module_t module, bool enable);
@@ -169,18 +264,40 @@ bool I2C_DataReady(I2C_Module_t module);
 uint8_t I2C_GetByte(I2C_Module_t module);
 void I2C_PutByte(I2C_Module_t module, uint8_t data);
 
+// Esclavo con banco de registros (índice + autoincremento, doble buffer)
+void I2C_SlaveRegMapInit(I2C_Module_t module, uint8_t *bank_a, uint8_t *bank_b, uint8_t size);
+uint8_t* I2C_SlaveGetBank(I2C_Module_t module);
+void I2C_SlavePublish(I2C_Module_t module);
+
 // Funciones avanzadas
 bool I2C_ScanBus(I2C_Module_t module, uint8_t *devices, uint8_t max_devices);
 bool I2C_CheckDevice(I2C_Module_t module, uint8_t address);
+bool I2C_PollDevice(I2C_Module_t module, uint8_t address);
+bool I2C_ScanStart(I2C_Module_t module, uint8_t *bitmap);
+bool I2C_ScanDone(I2C_Module_t module);
+uint8_t I2C_ScanGetCount(I2C_Module_t module);
 void I2C_SetTimeout(I2C_Module_t module, uint16_t timeout_ms);
 I2C_State_t I2C_GetLastError(I2C_Module_t module);
 void I2C_ClearErrors(I2C_Module_t module);
+void I2C_GetStats(I2C_Module_t module, I2C_Stats_t *stats);
+void I2C_ResetStats(I2C_Module_t module);
+void I2C_CountError(I2C_Module_t module, I2C_State_t result);  // contadores desde i2c_inline.h
 
 // Buffer y colas
 bool I2C_WriteBuffer(I2C_Module_t module, uint8_t address, uint8_t *data, uint16_t length);
 bool I2C_ReadBuffer(I2C_Module_t module, uint8_t address, uint8_t *buffer, uint16_t length);
-uint16_t I2C_GetRxBufferCount(I2C_Module_t module);
-uint16_t I2C_GetTxBufferCount(I2C_Module_t module);
+uint16_t I2C_GetRxBufferCount(I2C_Module_t module);  // transacciones pendientes con lectura
+uint16_t I2C_GetTxBufferCount(I2C_Module_t module);  // transacciones pendientes (cola + en curso)
+
+// Transacciones no bloqueantes (maestro, requiere interrupt_enable)
+void I2C_TransactionInit(I2C_Transaction_t *t, uint8_t address,
+                         const uint8_t *write_data, uint16_t write_length,
+                         uint8_t *read_data, uint16_t read_length,
+                         I2C_TransactionCallback_t callback, void *context);
+bool I2C_Submit(I2C_Module_t module, I2C_Transaction_t *transaction);
+uint8_t I2C_SubmitBatch(I2C_Module_t module, I2C_Transaction_t *list, uint8_t count);
+bool I2C_TransactionDone(const I2C_Transaction_t *transaction);
+bool I2C_CheckTimeout(I2C_Module_t module);
 
 // Interrupciones y callbacks
 void I2C_SetCallback(I2C_Module_t module, I2C_Callback_t callback);
@@ -190,17 +307,28 @@ void I2C_ISR_Handler(I2C_Module_t module);
 // Utilitarias
 void I2C_PrintConfig(I2C_Module_t module);
 void I2C_PrintStatus(I2C_Module_t module);
-uint32_t I2C_CalculateBaudRate(uint32_t fcy, uint32_t desired_speed);
+uint32_t I2C_CalculateBaudRate(uint32_t fcy, uint32_t desired_speed);  // valor de I2CxBRG
+uint32_t I2C_GetActualSpeed(I2C_Module_t module);                      // SCL real en Hz
 void I2C_DelayUs(uint16_t microseconds);
 
+// Consulta del bitmap de I2C_ScanStart
+static inline bool I2C_ScanHasDevice(const uint8_t *bitmap, uint8_t address) {
+    return (bitmap[(address >> 3) & 0x0F] & (1u << (address & 0x07))) != 0;
+}
+
 // =============================================================================
 // VARIABLES GLOBALES
 // =============================================================================
 extern volatile I2C_State_t I2C1_State;
-extern volatile I2C_State_t I2C2_State;
 extern volatile bool I2C1_Busy;
-extern volatile bool I2C2_Busy;
 extern I2C_Config_t I2C1_Config;
+#ifdef CONFIG_I2C2_ENABLED
+extern volatile I2C_State_t I2C2_State;
+extern volatile bool I2C2_Busy;
 extern I2C_Config_t I2C2_Config;
+#endif
+
+// Variantes por módulo (I2C1_WriteByte, I2C1_ReadByte...)
+#include "i2c_inline.h"
 
 #endif /* I2C_H */
\ No newline at end of file
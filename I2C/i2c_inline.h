@@ -0,0 +1,141 @@
+/*******************************************************************************
+ * i2c_inline.h - Variantes en línea por módulo de las operaciones de byte
+ *
+ * Descripción: I2C1_WriteByte, I2C1_ReadByte, I2C1_Restart... con el módulo
+ *              fijado al compilar: acceden directamente a I2C1CON/I2C1STAT/
+ *              I2C1TRN/I2C1RCV, sin puntero a registros ni switch por byte.
+ *              Mismo comportamiento (timeouts, estados de error, NACK y
+ *              timeouts en I2C_GetStats vía I2C_CountError) que las
+ *              funciones genéricas de i2c.c, a las que se puede mezclar:
+ *              I2C1_Start() / I2C1_Stop() delegan en I2C_Start/I2C_Stop porque
+ *              son una vez por transferencia y gestionan la cola.
+ *
+ *              Los drivers del árbol no las usan: con un solo módulo
+ *              habilitado I2C_MODULE_SEL ya deja las funciones genéricas en
+ *              acceso directo al SFR, y cada byte bloqueante espera 9 pulsos
+ *              de SCL en TRSTAT (~900 Tcy a 400 kHz), así que la llamada no
+ *              pesa. El camino caliente de verdad es el motor por
+ *              interrupción (I2C_Submit), que no pasa por estas funciones.
+ *              Quedan para código de aplicación que quiera encadenar bytes
+ *              en línea sin la dependencia del módulo en tiempo de ejecución.
+ *
+ *              Se generan sólo para los módulos habilitados en config.h
+ *              (CONFIG_I2C1_ENABLED, CONFIG_I2C2_ENABLED). Se incluye desde
+ *              i2c.h.
+ *
+ * Uso:
+ *      if (I2C1_Start() && I2C1_WriteByte(addr << 1) && I2C1_WriteByte(reg)) {
+ *          ...
+ *      }
+ *      I2C1_Stop();
+ *
+ ******************************************************************************/
+
+#ifndef I2C_INLINE_H
+#define I2C_INLINE_H
+
+// Plantilla: n = número de módulo (1 o 2)
+#define I2C_INLINE_DEFINE(n)                                                   \
+                                                                               \
+/* Espera a que terminen SEN/RSEN/PEN/RCEN/ACKEN */                            \
+static inline bool I2C##n##_WaitCondition(void) {                              \
+    uint32_t start;                                                            \
+    if ((I2C##n##CON & 0x001F) == 0) return true;                              \
+    start = SYSTEM_GetTickMs();                                                \
+    while ((I2C##n##CON & 0x001F) != 0) {                                      \
+        if (I2C##n##STATbits.I2COV) {                                          \
+            I2C##n##_State = I2C_STATE_OVERRUN;                                \
+            return false;                                                      \
+        }                                                                      \
+        if (I2C##n##STATbits.IWCOL) {                                          \
+            I2C##n##_State = I2C_STATE_BUS_COLLISION;                          \
+            return false;                                                      \
+        }                                                                      \
+        if ((SYSTEM_GetTickMs() - start) > I2C##n##_Config.timeout_ms) {       \
+            I2C_RecoverBus(I2C_MODULE_##n);                                    \
+            I2C##n##_State = I2C_STATE_TIMEOUT;                                \
+            I2C_CountError(I2C_MODULE_##n, I2C_STATE_TIMEOUT);                 \
+            return false;                                                      \
+        }                                                                      \
+    }                                                                          \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool I2C##n##_Start(void) {                                      \
+    return I2C_Start(I2C_MODULE_##n);                                          \
+}                                                                              \
+                                                                               \
+static inline bool I2C##n##_Stop(void) {                                       \
+    return I2C_Stop(I2C_MODULE_##n);                                           \
+}                                                                              \
+                                                                               \
+static inline bool I2C##n##_Restart(void) {                                    \
+    I2C##n##CONbits.RSEN = 1;                                                  \
+    return I2C##n##_WaitCondition();                                           \
+}                                                                              \
+                                                                               \
+/* Byte + ACK del esclavo. false con NACK, colisión o timeout */               \
+static inline bool I2C##n##_WriteByte(uint8_t data) {                          \
+    uint32_t start;                                                            \
+    I2C##n##TRN = data;                                                        \
+    if (I2C##n##STATbits.IWCOL) {                                              \
+        I2C##n##STATbits.IWCOL = 0;                                            \
+        I2C##n##_State = I2C_STATE_BUS_COLLISION;                              \
+        return false;                                                          \
+    }                                                                          \
+    start = SYSTEM_GetTickMs();                                                \
+    while (I2C##n##STATbits.TRSTAT) {                                          \
+        if (I2C##n##STATbits.BCL) {                                            \
+            I2C##n##_State = I2C_STATE_BUS_COLLISION;                          \
+            return false;                                                      \
+        }                                                                      \
+        if ((SYSTEM_GetTickMs() - start) > I2C##n##_Config.timeout_ms) {       \
+            I2C_RecoverBus(I2C_MODULE_##n);                                    \
+            I2C##n##_State = I2C_STATE_TIMEOUT;                                \
+            I2C_CountError(I2C_MODULE_##n, I2C_STATE_TIMEOUT);                 \
+            return false;                                                      \
+        }                                                                      \
+    }                                                                          \
+    if (I2C##n##STATbits.ACKSTAT) {                                            \
+        I2C##n##_State = I2C_STATE_DATA_NACK;                                  \
+        I2C_CountError(I2C_MODULE_##n, I2C_STATE_DATA_NACK);                   \
+        return false;                                                          \
+    }                                                                          \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+/* Recibe un byte y responde ACK (ack = true) o NACK (último byte). Si la     \
+   recepción no termina devuelve 0xFF sin secuencia ACK (estado de error) */   \
+static inline uint8_t I2C##n##_ReadByte(bool ack) {                            \
+    uint8_t data;                                                              \
+    I2C##n##CONbits.RCEN = 1;                                                  \
+    if (!I2C##n##_WaitCondition()) return 0xFF;                                \
+    data = (uint8_t)I2C##n##RCV;                                               \
+    I2C##n##CONbits.ACKDT = ack ? 0 : 1;                                       \
+    I2C##n##CONbits.ACKEN = 1;                                                 \
+    I2C##n##_WaitCondition();                                                  \
+    return data;                                                               \
+}                                                                              \
+                                                                               \
+static inline bool I2C##n##_WriteBytes(const uint8_t *data, uint16_t length) { \
+    while (length--) {                                                         \
+        if (!I2C##n##_WriteByte(*data++)) return false;                        \
+    }                                                                          \
+    return true;                                                               \
+}                                                                              \
+                                                                               \
+static inline void I2C##n##_ReadBytes(uint8_t *buffer, uint16_t length) {      \
+    while (length--) {                                                         \
+        *buffer++ = I2C##n##_ReadByte(length != 0);                            \
+    }                                                                          \
+}
+
+#ifdef CONFIG_I2C1_ENABLED
+I2C_INLINE_DEFINE(1)
+#endif
+
+#ifdef CONFIG_I2C2_ENABLED
+I2C_INLINE_DEFINE(2)
+#endif
+
+#endif /* I2C_INLINE_H */
@@ -4,9 +4,17 @@
  * Este archivo contiene ejemplos prácticos de cómo usar la librería I2C
  * con diferentes dispositivos y configuraciones.
  * 
+ * Métricas (metrics.h): añadir metrics.c al proyecto con las macros
+ * METRICS_WITH_I2C=1, METRICS_WITH_UART=1 y METRICS_WITH_SCHED=1.
+ * 
  ******************************************************************************/
 
 #include "i2c.h"
+#include "eeprom_24lc256.h"
+#include "config.h"
+#include "sched.h"
+#include "uart.h"
+#include "metrics.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -25,6 +33,11 @@ void ejemplo_configuracion_basica(void) {
     // Inicializar I2C
     I2C_Init(&config);
     
+    // Un reset a mitad de una lectura puede dejar a un esclavo reteniendo SDA
+    if (!I2C_RecoverBus(I2C_MODULE_1)) {
+        printf("Bus I2C bloqueado (SCL o SDA a nivel bajo)\n");
+    }
+    
     // Imprimir configuración
     I2C_PrintConfig(I2C_MODULE_1);
     
@@ -38,17 +51,32 @@ void ejemplo_configuracion_basica(void) {
 void ejemplo_escanear_bus(void) {
     printf("\n=== Ejemplo 2: Escaneo de Bus I2C ===\n");
     
-    uint8_t dispositivos[16];
-    uint8_t encontrados = 0;
+    // En RAM persistente: tras un reset por watchdog el mapa sigue valiendo
+    // y no hace falta volver a escanear (arranque_en_caliente)
+    uint8_t *mapa = SYSTEM_GetPersistentData();
     
-    // Escanear bus
-    if (I2C_ScanBus(I2C_MODULE_1, dispositivos, 16)) {
+    // El escaneo corre en la ISR MI2C1, con timeout corto por dirección
+    I2C_Config_t config = I2C_CONFIG_DEFAULT_MASTER;
+    config.interrupt_enable = true;
+    I2C_Init(&config);
+    
+    if (!I2C_ScanStart(I2C_MODULE_1, mapa)) {
+        printf("No se pudo iniciar el escaneo\n");
+        return;
+    }
+    
+    while (!I2C_ScanDone(I2C_MODULE_1)) {
+        // ... resto del arranque mientras tanto ...
+    }
+    
+    if (I2C_ScanGetCount(I2C_MODULE_1) > 0) {
         printf("Dispositivos encontrados:\n");
-        for (uint8_t i = 0; i < 16 && dispositivos[i] != 0; i++) {
-            printf("  - Dirección 0x%02X\n", dispositivos[i]);
-            encontrados++;
+        for (uint8_t addr = I2C_SCAN_FIRST_ADDRESS; addr <= I2C_SCAN_LAST_ADDRESS; addr++) {
+            if (I2C_ScanHasDevice(mapa, addr)) {
+                printf("  - Dirección 0x%02X\n", addr);
+            }
         }
-        printf("Total: %d dispositivos\n", encontrados);
+        printf("Total: %d dispositivos\n", I2C_ScanGetCount(I2C_MODULE_1));
     } else {
         printf("No se encontraron dispositivos I2C.\n");
     }
@@ -58,44 +86,31 @@ void ejemplo_escanear_bus(void) {
 // EJEMPLO 3: COMUNICACIÓN CON EEPROM 24LC256
 // =============================================================================
 
-#define EEPROM_ADDRESS 0x50  // Dirección de EEPROM 24LC256
+#define EEPROM_ADDRESS EEPROM_24LC256_ADDRESS  // Dirección de EEPROM 24LC256
 
 void ejemplo_eeprom_24lc256(void) {
     printf("\n=== Ejemplo 3: EEPROM 24LC256 ===\n");
     
-    uint8_t direccion = 0x0000;  // Dirección de memoria
-    uint8_t dato_escritura = 0xAB;
-    uint8_t dato_lectura = 0x00;
+    uint16_t direccion = 0x0030;  // Cruza el límite de página en 0x0040
+    uint8_t registro[32];
+    uint8_t lectura[32];
     
-    // Escribir en EEPROM
-    uint8_t buffer_escritura[3] = {
-        (direccion >> 8) & 0xFF,   // Dirección alta
-        direccion & 0xFF,          // Dirección baja
-        dato_escritura             // Dato
-    };
+    for (uint8_t i = 0; i < sizeof(registro); i++) {
+        registro[i] = 0xA0 + i;
+    }
     
-    if (I2C_WriteData(I2C_MODULE_1, EEPROM_ADDRESS, buffer_escritura, 3)) {
-        printf("Dato 0x%02X escrito en dirección 0x%04X\n", 
-               dato_escritura, direccion);
-        
-        // Pequeña espera para escritura
-        __delay_ms(10);
-        
-        // Leer de EEPROM
-        uint8_t buffer_direccion[2] = {
-            (direccion >> 8) & 0xFF,
-            direccion & 0xFF
-        };
-        
-        // Primero escribir dirección
-        I2C_WriteData(I2C_MODULE_1, EEPROM_ADDRESS, buffer_direccion, 2);
-        
-        // Luego leer dato
-        I2C_ReadData(I2C_MODULE_1, EEPROM_ADDRESS, &dato_lectura, 1);
+    EEPROM_Init(I2C_MODULE_1, EEPROM_ADDRESS);
+    
+    // Dos escrituras de página (16 + 16 bytes) con ACK polling
+    if (EEPROM_Write(direccion, registro, sizeof(registro))) {
+        printf("%u bytes escritos en dirección 0x%04X\n",
+               (unsigned)sizeof(registro), direccion);
         
-        printf("Dato leído: 0x%02X\n", dato_lectura);
+        // Lectura secuencial en una sola transacción
+        memset(lectura, 0, sizeof(lectura));
+        EEPROM_Read(direccion, lectura, sizeof(lectura));
         
-        if (dato_escritura == dato_lectura) {
+        if (memcmp(registro, lectura, sizeof(registro)) == 0) {
             printf("✓ Verificación exitosa!\n");
         } else {
             printf("✗ Error en verificación\n");
@@ -115,10 +130,10 @@ void ejemplo_eeprom_24lc256(void) {
 void ejemplo_sensor_lm75(void) {
     printf("\n=== Ejemplo 4: Sensor LM75 ===\n");
     
-    // Leer temperatura del LM75
+    // Leer temperatura del LM75 (puntero + lectura con REPEATED START)
     uint8_t buffer_temp[2];
     
-    if (I2C_ReadData(I2C_MODULE_1, LM75_ADDRESS, buffer_temp, 2)) {
+    if (I2C_ReadRegisters(I2C_MODULE_1, LM75_ADDRESS, LM75_REG_TEMP, buffer_temp, 2)) {
         // Convertir a temperatura (LM75: 11-bit, 0.125°C/LSB)
         int16_t raw_temp = (buffer_temp[0] << 8) | buffer_temp[1];
         raw_temp >>= 5;  // Desplazar bits de relleno
@@ -135,33 +150,48 @@ void ejemplo_sensor_lm75(void) {
 // EJEMPLO 5: MODO ESCLAVO
 // =============================================================================
 
-// Callback para modo esclavo
+// Módulo del ejemplo de esclavo: I2C2 si existe, si no I2C1 (con I2C1 hay
+// que elegir: o maestro para LM75/EEPROM o esclavo, no los dos a la vez)
+#ifdef CONFIG_I2C2_ENABLED
+#define ESCLAVO_MODULO I2C_MODULE_2
+#else
+#define ESCLAVO_MODULO I2C_MODULE_1
+#endif
+
+// Lo que ve el callback, para esclavo_informe. El callback corre en la ISR
+// SI2Cx y printf no se puede usar ahí (la cola de TX de uart.c tiene un
+// solo productor, el bucle principal): sólo anota y la tarea imprime.
+static volatile uint8_t esclavo_transferencias = 0;  // STOP recibidos
+static volatile uint8_t esclavo_recibidos = 0;       // bytes de la última escritura
+static volatile uint8_t esclavo_ultimo_dato = 0;
+static volatile uint8_t esclavo_solicitados = 0;     // bytes pedidos por el maestro
+
+// Callback para modo esclavo (contexto de interrupción)
 void esclavo_callback(I2C_Event_t evento, uint8_t dato) {
     static uint8_t buffer[32];
     static uint8_t index = 0;
     
     switch(evento) {
         case I2C_EVENT_START:
-            printf("Esclavo: START recibido\n");
             index = 0;
             break;
             
         case I2C_EVENT_DATA_RECEIVED:
-            printf("Esclavo: Dato recibido: 0x%02X\n", dato);
+            esclavo_ultimo_dato = dato;
             if (index < 32) {
                 buffer[index++] = dato;
             }
             break;
             
         case I2C_EVENT_DATA_REQUESTED:
-            printf("Esclavo: Solicitado dato\n");
             // Enviar respuesta
-            I2C_PutByte(I2C_MODULE_2, 0xAA);
+            I2C_PutByte(ESCLAVO_MODULO, 0xAA);
+            esclavo_solicitados++;
             break;
             
         case I2C_EVENT_STOP:
-            printf("Esclavo: STOP recibido\n");
-            printf("Total datos recibidos: %d\n", index);
+            esclavo_recibidos = index;
+            esclavo_transferencias++;
             break;
             
         default:
@@ -169,24 +199,64 @@ void esclavo_callback(I2C_Event_t evento, uint8_t dato) {
     }
 }
 
+// Tarea de 100 ms: imprime lo que anotó el callback desde la última vez
+void esclavo_informe(void) {
+    static uint8_t vistas = 0;
+    uint8_t transferencias = esclavo_transferencias;
+    
+    if (transferencias == vistas) {
+        return;
+    }
+    
+    printf("Esclavo: %u transferencias, última con %u datos recibidos",
+           (unsigned)(uint8_t)(transferencias - vistas), esclavo_recibidos);
+    if (esclavo_recibidos > 0) {
+        printf(" (último 0x%02X)", esclavo_ultimo_dato);
+    }
+    printf(", %u pedidos en total\n", esclavo_solicitados);
+    vistas = transferencias;
+}
+
+// Banco de registros del esclavo: 0x00-0x07 telemetría, 0x08-0x0F configuración,
+// 0x10-0x2F métricas (METRICS_REG_* desplazados en ESCLAVO_REG_METRICAS)
+#define ESCLAVO_REG_METRICAS 0x10
+#define ESCLAVO_NUM_REGS (ESCLAVO_REG_METRICAS + METRICS_REG_COUNT)
+static uint8_t esclavo_banco[2][ESCLAVO_NUM_REGS];
+
 void ejemplo_modo_esclavo(void) {
     printf("\n=== Ejemplo 5: Modo Esclavo ===\n");
     
     // Configurar como esclavo
     I2C_Config_t config = I2C_CONFIG_DEFAULT_SLAVE;
-    config.module = I2C_MODULE_2;  // Usar módulo 2 como esclavo
+    config.module = ESCLAVO_MODULO;  // Módulo que hace de esclavo
     config.slave_address = 0x40;   // Dirección del esclavo
     config.callback = esclavo_callback;
     
     I2C_Init(&config);
     
+    // El maestro escribe el índice y lee/escribe desde ahí con autoincremento;
+    // la ISR atiende cada byte, el bucle principal solo publica instantáneas
+    I2C_SlaveRegMapInit(ESCLAVO_MODULO, esclavo_banco[0], esclavo_banco[1], ESCLAVO_NUM_REGS);
+    
     printf("Esclavo configurado en dirección 0x%02X\n", config.slave_address);
     printf("Esperando comunicación desde maestro...\n");
     
-    // Mantener activo
-    while(1) {
-        // El esclavo responde mediante interrupciones
-        __delay_ms(100);
+    // La publicación periódica la hace la tarea esclavo_publicar (main)
+}
+
+// Tarea de 100 ms: nueva instantánea de telemetría para el maestro
+void esclavo_publicar(void) {
+    static uint16_t muestra = 0;
+    uint8_t *banco = I2C_SlaveGetBank(ESCLAVO_MODULO);
+    
+    if (banco != NULL) {
+        // Telemetría coherente: el maestro ve todo el bloque nuevo o el anterior
+        banco[0] = (uint8_t)(muestra >> 8);
+        banco[1] = (uint8_t)(muestra & 0xFF);
+        banco[2] = (uint8_t)(I2C_GetLastError(ESCLAVO_MODULO));
+        METRICS_Export(&banco[ESCLAVO_REG_METRICAS], METRICS_REG_COUNT);
+        I2C_SlavePublish(ESCLAVO_MODULO);
+        muestra++;
     }
 }
 
@@ -208,9 +278,9 @@ void ejemplo_avanzado(void) {
         }
     }
     
-    // 2. Lectura secuencial
+    // 2. Lectura secuencial desde el registro 0x00 (REPEATED START)
     uint8_t buffer_lectura[4];
-    if (I2C_ReadData(I2C_MODULE_1, dispositivo, buffer_lectura, 4)) {
+    if (I2C_ReadRegisters(I2C_MODULE_1, dispositivo, registros[0], buffer_lectura, 4)) {
         printf("Datos leídos: ");
         for (uint8_t i = 0; i < 4; i++) {
             printf("0x%02X ", buffer_lectura[i]);
@@ -220,37 +290,192 @@ void ejemplo_avanzado(void) {
 }
 
 // =============================================================================
-// FUNCIÓN PRINCIPAL
+// EJEMPLO 7: TRANSACCIONES NO BLOQUEANTES
 // =============================================================================
 
-int main(void) {
-    // Inicializar sistema
-    // ... (configuración de clock, etc.)
+static uint8_t lm75_reg = LM75_REG_TEMP;
+static uint8_t lm75_temp[2];
+static I2C_Transaction_t lm75_transaccion;
+
+// Se ejecuta en la ISR al terminar la transacción
+void lm75_listo(I2C_Transaction_t *t) {
+    (void)t;  // El resultado queda en t->result; aquí solo se podría marcar un flag
+}
+
+void ejemplo_no_bloqueante(void) {
+    printf("\n=== Ejemplo 7: Transacción no bloqueante ===\n");
+    
+    // El motor necesita la interrupción MI2C1
+    I2C_Config_t config = I2C_CONFIG_DEFAULT_MASTER;
+    config.interrupt_enable = true;
+    I2C_Init(&config);
+    
+    // Puntero de registro + lectura de 2 bytes con REPEATED START
+    I2C_TransactionInit(&lm75_transaccion, LM75_ADDRESS,
+                        &lm75_reg, 1, lm75_temp, 2, lm75_listo, NULL);
+    
+    if (!I2C_Submit(I2C_MODULE_1, &lm75_transaccion)) {
+        printf("Bus ocupado\n");
+        return;
+    }
+    
+    // La CPU queda libre mientras la ISR completa la transferencia
+    while (!I2C_TransactionDone(&lm75_transaccion)) {
+        // ... trabajo útil del bucle principal ...
+        I2C_CheckTimeout(I2C_MODULE_1);  // Aborta si el sensor bloquea el bus
+    }
+    
+    if (lm75_transaccion.result == I2C_STATE_SUCCESS) {
+        int16_t raw_temp = ((int16_t)(lm75_temp[0] << 8) | lm75_temp[1]) >> 5;
+        printf("Temperatura LM75: %.2f°C\n", (float)raw_temp * 0.125);
+    } else {
+        printf("Error %d en la transacción\n", lm75_transaccion.result);
+    }
+}
+
+// =============================================================================
+// EJEMPLO 8: LOTE DE LECTURAS DE SENSORES
+// =============================================================================
+
+void ejemplo_lote_sensores(void) {
+    printf("\n=== Ejemplo 8: Lote de transacciones ===\n");
     
-    printf("\n========== DEMO LIBRERÍA I2C ==========\n");
+    static const uint8_t eeprom_dir[2] = {0x00, 0x00};
+    static const uint8_t reg_0x68 = 0x00;
+    static uint8_t temp[2], eeprom[4], regs[4];
+    static I2C_Transaction_t lote[3];
     
-    // Ejecutar ejemplos
-    ejemplo_configuracion_basica();
+    // Un sensor por transacción; la cola las ejecuta seguidas desde la ISR
+    I2C_TransactionInit(&lote[0], LM75_ADDRESS, &lm75_reg, 1, temp, 2, NULL, NULL);
+    I2C_TransactionInit(&lote[1], EEPROM_ADDRESS, eeprom_dir, 2, eeprom, 4, NULL, NULL);
+    I2C_TransactionInit(&lote[2], 0x68, &reg_0x68, 1, regs, 4, NULL, NULL);
     
-    // Esperar un momento
-    __delay_ms(1000);
+    // Encadenar con REPEATED START: el bus no queda libre entre lecturas
+    lote[0].keep_bus = true;
+    lote[1].keep_bus = true;
     
-    ejemplo_escanear_bus();
+    uint8_t encoladas = I2C_SubmitBatch(I2C_MODULE_1, lote, 3);
+    printf("Encoladas: %d, pendientes: %u\n", encoladas, I2C_GetTxBufferCount(I2C_MODULE_1));
     
-    // Solo ejecutar si hay dispositivos conectados
-    ejemplo_eeprom_24lc256();
-    ejemplo_sensor_lm75();
+    while (I2C_GetTxBufferCount(I2C_MODULE_1) > 0) {
+        // ... la CPU queda libre ...
+        I2C_CheckTimeout(I2C_MODULE_1);
+    }
+    
+    for (uint8_t i = 0; i < encoladas; i++) {
+        printf("  0x%02X -> %s\n", lote[i].address,
+               lote[i].result == I2C_STATE_SUCCESS ? "OK" : "error");
+    }
+}
+
+// =============================================================================
+// TAREAS PERIÓDICAS (planificador cooperativo, sched.h)
+// =============================================================================
+
+// Tarea de 10 ms: vigila que ninguna transacción retenga el bus
+void tarea_i2c_timeout(void) {
+    I2C_CheckTimeout(I2C_MODULE_1);
+}
+
+// Tarea de 1 s: lectura no bloqueante del LM75; el resultado de la lectura
+// anterior se imprime antes de lanzar la siguiente
+void tarea_lm75(void) {
+    if (!I2C_TransactionDone(&lm75_transaccion)) {
+        return;  // Aún en curso: se reintenta en el siguiente periodo
+    }
+    
+    if (lm75_transaccion.result == I2C_STATE_SUCCESS) {
+        int16_t raw_temp = ((int16_t)(lm75_temp[0] << 8) | lm75_temp[1]) >> 5;
+        printf("LM75: %.2f°C\n", (float)raw_temp * 0.125);
+    }
     
-    // Descomentar para probar modo esclavo
-    // ejemplo_modo_esclavo();
+    I2C_Submit(I2C_MODULE_1, &lm75_transaccion);
+}
+
+// Tarea de 10 s: duración de cada tarea y retrasos
+void tarea_informe(void) {
+    SCHED_PrintStats();
+    METRICS_Print();
+}
+
+// Tarea de 1 s: recoge las métricas (ventana de idle de 1 s) y las envía
+// como trama UART_FRAME_STATS
+void tarea_metricas(void) {
+    METRICS_Update();
+    METRICS_SendFrame();
+}
+
+// Reset por watchdog: sin demos ni escaneo, sólo lo que necesitan las tareas.
+// El mapa del bus es el del último arranque en frío.
+typedef char mapa_persistente_check[(SYSTEM_PERSIST_USER_BYTES >= I2C_SCAN_BITMAP_SIZE) ? 1 : -1];
+
+void arranque_en_caliente(void) {
+    const uint8_t *mapa = SYSTEM_GetPersistentData();
+    SYSTEM_FaultRecord_t fallo;
     
-    ejemplo_avanzado();
+    I2C_Config_t config = I2C_CONFIG_DEFAULT_MASTER;
+    config.interrupt_enable = true;
+    I2C_Init(&config);
     
-    printf("\n========== FIN DE DEMO ==========\n");
+    I2C_TransactionInit(&lm75_transaccion, LM75_ADDRESS,
+                        &lm75_reg, 1, lm75_temp, 2, lm75_listo, NULL);
     
-    while(1) {
-        // Mantener programa activo
+    printf("\nArranque en caliente (watchdog): LM75 %s\n",
+           I2C_ScanHasDevice(mapa, LM75_ADDRESS) ? "presente" : "ausente");
+    if (SYSTEM_GetFaultRecord(&fallo)) {
+        printf("Último fallo: trampa %u en PC 0x%06lX\n", fallo.trap, (unsigned long)fallo.pc);
     }
+}
+
+// =============================================================================
+// FUNCIÓN PRINCIPAL
+// =============================================================================
+
+int main(void) {
+    // Inicializar sistema (tick de 1 ms para los timeouts I2C y las tareas)
+    SYSTEM_Initialize();
+    
+    // printf sale por UART1 a través de la cola de TX (uart.h): no espera
+    UART_Init(115200);
+    
+    if (SYSTEM_IsWarmBoot()) {
+        // De vuelta al bucle de tareas en milisegundos
+        arranque_en_caliente();
+    } else {
+        printf("\n========== DEMO LIBRERÍA I2C ==========\n");
+        
+        // Ejecutar ejemplos
+        ejemplo_configuracion_basica();
+        ejemplo_escanear_bus();
+        
+        // Solo ejecutar si hay dispositivos conectados
+        ejemplo_eeprom_24lc256();
+        ejemplo_sensor_lm75();
+        
+        // Descomentar para probar modo esclavo (y sus tareas en la tabla de abajo)
+        // ejemplo_modo_esclavo();
+        
+        ejemplo_avanzado();
+        ejemplo_no_bloqueante();
+        ejemplo_lote_sensores();
+        
+        printf("\n========== FIN DE DEMO ==========\n");
+    }
+    
+    // A partir de aquí el bucle principal es el planificador: el bus, el
+    // sensor y el informe se reparten la CPU sin esperas activas
+    SCHED_Init();
+    METRICS_Init();
+    SCHED_AddTask("i2c_tmo", tarea_i2c_timeout, 10, 0);
+    SCHED_AddTask("metricas", tarea_metricas, 1000, 9);
+    SCHED_AddTask("lm75", tarea_lm75, 1000, 3);
+    SCHED_AddTask("informe", tarea_informe, 10000, 7);
+    // SCHED_AddTask("esclavo", esclavo_publicar, 100, 5);
+    // SCHED_AddTask("esc_log", esclavo_informe, 100, 2);
+    
+    // Sin tareas pendientes, Idle hasta la siguiente interrupción (tick o I2C)
+    SCHED_SetIdleHook(SYSTEM_EnterIdle);
+    SCHED_Run();
     
     return 0;
 }
@@ -259,12 +484,33 @@ int main(void) {
 // INTERRUPCIONES (si se usan)
 // =============================================================================
 
-// Interrupción I2C1
-void __attribute__((interrupt, no_auto_psv)) _I2C1Interrupt(void) {
+// UART1: vacía la cola de printf y recibe
+void __attribute__((interrupt, no_auto_psv)) _U1TXInterrupt(void) {
+    UART_TX_ISR_Handler();
+}
+
+void __attribute__((interrupt, no_auto_psv)) _U1RXInterrupt(void) {
+    UART_RX_ISR_Handler();
+}
+
+// Interrupción maestro I2C1 (motor de transacciones no bloqueantes)
+void __attribute__((interrupt, no_auto_psv)) _MI2C1Interrupt(void) {
+    I2C_ISR_Handler(I2C_MODULE_1);
+}
+
+// Interrupción esclavo I2C1
+void __attribute__((interrupt, no_auto_psv)) _SI2C1Interrupt(void) {
     I2C_ISR_Handler(I2C_MODULE_1);
 }
 
-// Interrupción I2C2
-void __attribute__((interrupt, no_auto_psv)) _I2C2Interrupt(void) {
+#ifdef CONFIG_I2C2_ENABLED
+// Interrupción maestro I2C2
+void __attribute__((interrupt, no_auto_psv)) _MI2C2Interrupt(void) {
+    I2C_ISR_Handler(I2C_MODULE_2);
+}
+
+// Interrupción esclavo I2C2
+void __attribute__((interrupt, no_auto_psv)) _SI2C2Interrupt(void) {
     I2C_ISR_Handler(I2C_MODULE_2);
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
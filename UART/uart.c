@@ -0,0 +1,245 @@
+/*
+ * uart.c
+ *
+ * Driver de UART1 (ver uart.h).
+ *
+ * Uso:
+ *  - Llama a UART_Init(baud) después de SYSTEM_Initialize() (el BRG sale de
+ *    la FCY real).
+ *  - Define en tu main:
+ *      void __attribute__((interrupt, no_auto_psv)) _U1TXInterrupt(void) { UART_TX_ISR_Handler(); }
+ *      void __attribute__((interrupt, no_auto_psv)) _U1RXInterrupt(void) { UART_RX_ISR_Handler(); }
+ *
+ * La interrupción de TX sólo está habilitada mientras hay datos en la cola:
+ * el productor la arranca forzando U1TXIF y la ISR la apaga al vaciarla.
+ */
+
+#include "uart.h"
+#include "config.h"
+#include "ringbuf.h"
+#include <xc.h>
+
+#define UART_RPOUT_U1TX  3u     /* código PPS de salida de U1TX */
+
+RING_STORAGE(uart_tx_buf, uint8_t, UART_TX_BUFFER_SIZE);
+RING_STORAGE(uart_rx_buf, uint8_t, UART_RX_BUFFER_SIZE);
+
+static RING_Buffer_t uart_tx;
+static RING_Buffer_t uart_rx;
+static bool uart_ready = false;
+static uint8_t uart_frame_seq = 0;
+static volatile UART_Stats_t uart_stats;
+
+/* CRC16-CCITT con tabla de 16 entradas (medio byte por paso) */
+static const uint16_t uart_crc_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t UART_Crc16(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    while (length--) {
+        crc ^= (uint16_t)*data++ << 8;
+        crc = (uint16_t)(crc << 4) ^ uart_crc_nibble[crc >> 12];
+        crc = (uint16_t)(crc << 4) ^ uart_crc_nibble[crc >> 12];
+    }
+    return crc;
+}
+
+void UART_Init(uint32_t baud)
+{
+    uint32_t fcy = SYSTEM_GetClockFrequency();
+
+    PMD1bits.U1MD = 0;       /* módulo activo (CONFIG_PMD_AUTO) */
+    U1MODE = 0;
+    U1STA = 0;
+    IEC0bits.U1TXIE = 0;
+    IEC0bits.U1RXIE = 0;
+
+    RING_Init(&uart_tx, uart_tx_buf, 1, UART_TX_BUFFER_SIZE);
+    RING_Init(&uart_rx, uart_rx_buf, 1, UART_RX_BUFFER_SIZE);
+    uart_stats.tx_bytes = 0;
+    uart_stats.tx_dropped = 0;
+    uart_stats.frames_sent = 0;
+    uart_stats.frames_dropped = 0;
+    uart_stats.rx_overruns = 0;
+
+    /* PPS: desbloquear, asignar U1TX/U1RX y volver a bloquear */
+    UART_TX_TRIS = 0;
+    UART_RX_TRIS = 1;
+    __builtin_write_OSCCONL(OSCCON & 0xBF);
+    UART_TX_RPOR = UART_RPOUT_U1TX;
+    RPINR18bits.U1RXR = UART_RX_RPIN;
+    __builtin_write_OSCCONL(OSCCON | 0x40);
+
+    /* 8N1, BRGH = 1: baud = FCY / (4 * (BRG + 1)) */
+    U1MODEbits.BRGH = 1;
+    U1BRG = (uint16_t)(((fcy + 2u * baud) / (4u * baud)) - 1u);
+
+    /* TX: interrupción cuando la FIFO queda vacía; RX: por cada byte */
+    U1STAbits.UTXISEL1 = 1;
+    U1STAbits.UTXISEL0 = 0;
+    U1STAbits.URXISEL = 0;
+
+    IPC3bits.U1TXIP = UART_IRQ_PRIORITY;
+    IPC2bits.U1RXIP = UART_IRQ_PRIORITY;
+
+    U1MODEbits.UARTEN = 1;
+    U1STAbits.UTXEN = 1;     /* después de UARTEN */
+
+    IFS0bits.U1TXIF = 0;
+    IFS0bits.U1RXIF = 0;
+    IEC0bits.U1RXIE = 1;
+
+    uart_frame_seq = 0;
+    uart_ready = true;
+}
+
+/* Arranca la ISR de TX si estaba parada (cola vacía hasta ahora) */
+static void uart_tx_kick(void)
+{
+    if (!IEC0bits.U1TXIE) {
+        IFS0bits.U1TXIF = 1;
+        IEC0bits.U1TXIE = 1;
+    }
+}
+
+uint16_t UART_Write(const void *data, uint16_t length)
+{
+    uint16_t n;
+
+    if (!uart_ready || data == 0 || length == 0) {
+        return 0;
+    }
+
+    n = RING_PushBulk(&uart_tx, data, length);
+    if (n != length) {
+        uart_stats.tx_dropped += length - n;
+    }
+    if (n != 0) {
+        uart_tx_kick();
+    }
+    return n;
+}
+
+bool UART_SendFrame(uint8_t type, const void *payload, uint16_t length)
+{
+    uint8_t header[6];
+    uint8_t tail[2];
+    uint16_t crc;
+
+    if (!uart_ready || (length != 0 && payload == 0)) {
+        return false;
+    }
+    if (RING_Free(&uart_tx) < (uint32_t)length + UART_FRAME_OVERHEAD) {
+        uart_stats.frames_dropped++;
+        return false;
+    }
+
+    header[0] = UART_FRAME_SYNC0;
+    header[1] = UART_FRAME_SYNC1;
+    header[2] = type;
+    header[3] = uart_frame_seq;
+    header[4] = (uint8_t)(length & 0xFF);
+    header[5] = (uint8_t)(length >> 8);
+
+    crc = UART_Crc16(0xFFFF, &header[2], 4);
+    crc = UART_Crc16(crc, (const uint8_t *)payload, length);
+    tail[0] = (uint8_t)(crc & 0xFF);
+    tail[1] = (uint8_t)(crc >> 8);
+
+    /* Sólo este lado reduce el hueco: lo comprobado arriba sigue libre */
+    RING_PushBulk(&uart_tx, header, sizeof(header));
+    RING_PushBulk(&uart_tx, payload, length);
+    RING_PushBulk(&uart_tx, tail, sizeof(tail));
+
+    uart_frame_seq++;
+    uart_stats.frames_sent++;
+    uart_tx_kick();
+    return true;
+}
+
+uint16_t UART_Read(void *data, uint16_t length)
+{
+    if (!uart_ready || data == 0) {
+        return 0;
+    }
+    return RING_PopBulk(&uart_rx, data, length);
+}
+
+bool UART_TxIdle(void)
+{
+    return RING_IsEmpty(&uart_tx) && U1STAbits.TRMT;
+}
+
+void UART_GetStats(UART_Stats_t *stats)
+{
+    bool tx_ie, rx_ie;
+
+    if (stats == 0) {
+        return;
+    }
+
+    /* tx_bytes es de 32 bits y lo actualiza la ISR */
+    tx_ie = IEC0bits.U1TXIE;
+    rx_ie = IEC0bits.U1RXIE;
+    IEC0bits.U1TXIE = 0;
+    IEC0bits.U1RXIE = 0;
+    *stats = *(const UART_Stats_t *)&uart_stats;
+    IEC0bits.U1RXIE = rx_ie;
+    IEC0bits.U1TXIE = tx_ie;
+}
+
+void UART_TX_ISR_Handler(void)
+{
+    uint8_t pass;
+
+    IFS0bits.U1TXIF = 0;
+
+    /* Llenar la FIFO: como mucho dos tramos (fin y principio de la cola) */
+    for (pass = 0; pass < 2u && !U1STAbits.UTXBF; pass++) {
+        uint16_t n, sent = 0;
+        const uint8_t *p = (const uint8_t *)RING_ReadSpan(&uart_tx, &n);
+
+        while (sent < n && !U1STAbits.UTXBF) {
+            U1TXREG = p[sent++];
+        }
+        RING_Release(&uart_tx, sent);
+        uart_stats.tx_bytes += sent;
+    }
+
+    /* Cola vacía: lo que queda en la FIFO sale solo; el siguiente
+       UART_Write vuelve a arrancar la interrupción */
+    if (RING_IsEmpty(&uart_tx)) {
+        IEC0bits.U1TXIE = 0;
+    }
+}
+
+void UART_RX_ISR_Handler(void)
+{
+    IFS0bits.U1RXIF = 0;
+
+    while (U1STAbits.URXDA) {
+        uint8_t b = (uint8_t)U1RXREG;
+        if (!RING_Push(&uart_rx, &b)) {
+            uart_stats.rx_overruns++;
+        }
+    }
+
+    /* Con OERR el módulo deja de recibir hasta borrarlo */
+    if (U1STAbits.OERR) {
+        U1STAbits.OERR = 0;
+        uart_stats.rx_overruns++;
+    }
+}
+
+#if UART_STDIO_WRITE
+/* Backend de stdio de XC16: printf/puts acaban aquí. Se devuelve siempre
+   'len' para que la librería no reintente lo descartado. */
+int write(int handle, void *buffer, unsigned int len)
+{
+    (void)handle;
+    (void)UART_Write(buffer, (uint16_t)len);
+    return (int)len;
+}
+#endif
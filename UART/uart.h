@@ -0,0 +1,139 @@
+/*
+ * uart.h
+ *
+ * UART1 con transmisión por interrupción desde una cola circular
+ * (ringbuf.h): printf, SYSTEM_PrintConfiguration, I2C_PrintConfig y las
+ * tramas de telemetría sólo copian bytes a la cola y vuelven; la ISR de TX
+ * los pasa a la FIFO de 4 bytes del módulo.
+ *
+ * El dsPIC33FJ32MC204 no tiene DMA: la ISR salta cuando la FIFO queda vacía
+ * (UTXISEL = 10) y la rellena entera, así que hay una interrupción cada 4
+ * bytes en vez de una por byte.
+ *
+ * Si la cola está llena lo que no cabe se descarta y se cuenta
+ * (UART_GetStats): el registro nunca detiene el bucle de control.
+ *
+ * API:
+ *   void UART_Init(uint32_t baud);
+ *   uint16_t UART_Write(const void *data, uint16_t length);  // bytes aceptados
+ *   bool UART_SendFrame(uint8_t type, const void *payload, uint16_t length);
+ *   uint16_t UART_Read(void *data, uint16_t length);         // bytes recibidos
+ *   bool UART_TxIdle(void);
+ *   void UART_GetStats(UART_Stats_t *stats);
+ *   void UART_TX_ISR_Handler(void);   // llamar desde _U1TXInterrupt
+ *   void UART_RX_ISR_Handler(void);   // llamar desde _U1RXInterrupt
+ *
+ * Trama de telemetría (binaria, little endian):
+ *
+ *   0xA5 0x5A | tipo | secuencia | longitud (2) | carga (longitud) | CRC16 (2)
+ *
+ *   CRC16-CCITT (polinomio 0x1021, inicial 0xFFFF) sobre tipo, secuencia,
+ *   longitud y carga. La secuencia la pone el driver (una por trama
+ *   enviada): un salto en el receptor indica tramas descartadas. Una trama
+ *   entra entera en la cola o no entra.
+ *
+ * USO:
+ *      UART_Init(115200);
+ *      printf("hola\r\n");                         // via write()
+ *      UART_SendFrame(UART_FRAME_ADC, bloque, ADC_STREAM_BLOCK_LENGTH * 2);
+ *
+ * Nota:
+ * - Un solo productor: escribir (printf, UART_Write, UART_SendFrame) desde
+ *   el bucle principal, no desde las ISR.
+ * - PPS: con IOL1WAY = ON sólo vale una reconfiguración tras el reset. Si
+ *   también se usa el DAC (dac.h), poner IOL1WAY = OFF o asignar todos los
+ *   pines en un mismo desbloqueo.
+ */
+
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pines (PPS): U1TX -> RP20 (RC4), U1RX <- RP21 (RC5) */
+#ifndef UART_TX_RPOR
+#define UART_TX_RPOR   RPOR10bits.RP20R
+#endif
+#ifndef UART_RX_RPIN
+#define UART_RX_RPIN   21u
+#endif
+#ifndef UART_TX_TRIS
+#define UART_TX_TRIS   TRISCbits.TRISC4
+#endif
+#ifndef UART_RX_TRIS
+#define UART_RX_TRIS   TRISCbits.TRISC5
+#endif
+
+/* Tamaños de cola (potencia de dos) */
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 256u
+#endif
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE 32u
+#endif
+
+#ifndef UART_IRQ_PRIORITY
+#define UART_IRQ_PRIORITY 3     /* por debajo del ADC y del DAC */
+#endif
+
+/* printf sale por UART1 (write() de la librería C de XC16) */
+#ifndef UART_STDIO_WRITE
+#define UART_STDIO_WRITE 1
+#endif
+
+/* Tipos de trama; de 0x80 en adelante, libres para la aplicación */
+#define UART_FRAME_TEXT      0x01u   /* texto sin formato fijo */
+#define UART_FRAME_ADC       0x10u   /* muestras uint16_t del ADC */
+#define UART_FRAME_Q15       0x11u   /* muestras Q15 (salida FIR) */
+#define UART_FRAME_SPECTRUM  0x12u   /* módulos Q15 de SPEC_GetBins */
+#define UART_FRAME_STATS     0x20u   /* estructura de estadísticas */
+#define UART_FRAME_USER      0x80u
+
+#define UART_FRAME_SYNC0     0xA5u
+#define UART_FRAME_SYNC1     0x5Au
+#define UART_FRAME_OVERHEAD  8u      /* sync + tipo + secuencia + longitud + CRC */
+
+typedef struct {
+    uint32_t tx_bytes;       /* bytes entregados a la FIFO */
+    uint16_t tx_dropped;     /* bytes de texto descartados (cola llena) */
+    uint16_t frames_sent;
+    uint16_t frames_dropped; /* tramas que no cabían enteras */
+    uint16_t rx_overruns;    /* OERR del módulo o cola de RX llena */
+} UART_Stats_t;
+
+/* --------------------------------------------------------------------------
+ * PROTOTIPOS DE FUNCIONES
+ * ------------------------------------------------------------------------ */
+
+/* 8N1, BRGH = 1, BRG calculado con la FCY real. TX y RX por interrupción. */
+void UART_Init(uint32_t baud);
+
+/* Copia a la cola lo que quepa; nunca espera */
+uint16_t UART_Write(const void *data, uint16_t length);
+
+/* Encola una trama completa; false (y se cuenta) si no cabe entera */
+bool UART_SendFrame(uint8_t type, const void *payload, uint16_t length);
+
+/* Saca de la cola de recepción hasta 'length' bytes */
+uint16_t UART_Read(void *data, uint16_t length);
+
+/* Cola de TX vacía y último byte fuera del registro de desplazamiento */
+bool UART_TxIdle(void);
+
+void UART_GetStats(UART_Stats_t *stats);
+
+uint16_t UART_Crc16(uint16_t crc, const uint8_t *data, uint16_t length);
+
+void UART_TX_ISR_Handler(void);
+void UART_RX_ISR_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_H */